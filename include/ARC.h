@@ -0,0 +1,41 @@
+#pragma once
+#include "CacheBase.h"
+#include "FlatIndex.h"
+#include "IndexList.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// ARC (Megiddo & Modha): два резидентных списка — T1 (видели один раз) и
+// T2 (видели повторно) — и два списка «призраков» B1/B2 с ключами, недавно
+// вытесненными из них. Попадание в призрак сдвигает целевой размер T1 (p)
+// в пользу той части, которая потеряла полезный ключ, поэтому баланс
+// recency/frequency подстраивается под нагрузку без ручных параметров.
+class ARCCache : public ICache {
+public:
+    explicit ARCCache(size_t cap);
+    void put(int key, int value) override;
+    std::optional<int> get(int key) override;
+    size_t size() const override { return t1_.size + t2_.size; }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+    size_t target() const { return p_; }
+private:
+    enum List : uint8_t { T1, T2, B1, B2 };
+    struct Node { int key, val; uint32_t prev, next; List list; };
+    size_t cap_;
+    size_t p_ = 0;                  // целевой размер T1
+    TrackedVector<Node> nodes_;       // до cap_ резидентных + cap_ призраков
+    TrackedVector<uint32_t> free_;
+    FlatIndex index_;
+    IndexList t1_, t2_, b1_, b2_;
+    OpCounters cnt_;
+
+    IndexList& listOf(List l);
+    void move(uint32_t i, List to);
+    void dropGhost(uint32_t i);
+    void replace(bool inB2);
+};
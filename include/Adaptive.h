@@ -0,0 +1,87 @@
+#pragma once
+#include "CacheBase.h"
+#include "LRU.h"
+#include "LFU.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Политика вытеснения, которой сейчас следует AdaptiveCache
+enum class AdaptivePolicy { LRU, LFU };
+const char* policyName(AdaptivePolicy p);
+
+struct AdaptiveSpec {
+    AdaptivePolicy initial = AdaptivePolicy::LRU;
+    double sample_rate = 0.0;    // доля ключей в теневых кэшах; 0 — 1/16, но тени не меньше kMinShadow записей
+    int window = 500;            // выбранных обращений между сравнениями теней
+    double margin_pp = 1.0;      // переключаться, только если другая политика лучше на столько п.п.
+    double smoothing = 0.5;      // вес прошлой оценки в скользящем среднем hit rate теней
+};
+
+// Событие переключения: op — номер обращения (get + put) с начала жизни кэша,
+// hit rate теней — сглаженные оценки в момент решения
+struct PolicySwitch {
+    long long op;
+    AdaptivePolicy from, to;
+    double lru_hit_rate, lfu_hit_rate;
+};
+
+// Кэш, выбирающий между LRU и LFU на ходу. Записи хранятся один раз, но в двух
+// порядках сразу: список по давности (как LRUCacheIter) и корзины частот (как
+// LFUCacheIter, частоты ведутся и в режиме LRU). Поэтому смена политики меняет
+// только выбор жертвы — без перестроения и без паузы.
+//
+// Решение принимают две тени — LRUCacheIter и LFUCacheIter ёмкостью cap·rate,
+// которые видят только ключи с hash(key) < rate (выборка SHARDS) и хранят
+// лишь ключи. Раз в window выбранных обращений их hit rate за окно сглаживается,
+// и если чужая политика лучше текущей больше чем на margin_pp, кэш переключается.
+class AdaptiveCache : public ICache {
+public:
+    static constexpr size_t kMinShadow = 64;
+    explicit AdaptiveCache(size_t cap, const AdaptiveSpec& spec = AdaptiveSpec());
+    void put(int key, int value) override;
+    std::optional<int> get(int key) override;
+    size_t size() const override { return order_.size(); }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+    AdaptivePolicy policy() const { return policy_; }
+    const std::vector<PolicySwitch>& switches() const { return switches_; }
+    double sampleRate() const { return rate_; }
+    // Сглаженный hit rate тени (%)
+    double shadowHitRate(AdaptivePolicy p) const { return p == AdaptivePolicy::LRU ? lruEst_ : lfuEst_; }
+    const AdaptiveSpec& spec() const { return spec_; }
+private:
+    struct Entry {
+        int val;
+        int freq;
+        TrackedList<int>::iterator rec;     // место в order_
+        TrackedList<int>::iterator fq;      // место в корзине freq
+    };
+    size_t cap_;
+    AdaptiveSpec spec_;
+    AdaptivePolicy policy_;
+    double rate_;
+    uint32_t threshold_;                    // из 2^24: ключ в выборке, если hash < threshold_
+    TrackedList<int> order_;                // ключи, свежие в начале
+    TrackedHashMap<int, Entry> pos_;
+    TrackedHashMap<int, TrackedList<int>> buckets_;   // частота -> ключи, свежие в начале
+    int minFreq_ = 0;
+    LRUCacheIter lruShadow_;
+    LFUCacheIter lfuShadow_;
+    long long ops_ = 0;
+    int sampled_ = 0;                       // выбранных обращений в текущем окне
+    long long lruHits_ = 0, lfuHits_ = 0;   // попаданий теней в текущем окне
+    double lruEst_ = 0.0, lfuEst_ = 0.0;
+    bool primed_ = false;                   // первое окно задаёт оценки без сглаживания
+    std::vector<PolicySwitch> switches_;
+    OpCounters cnt_;
+
+    void observe(int key);
+    void evaluate();
+    void touch(TrackedHashMap<int, Entry>::iterator it);
+    void unlinkFreq(Entry& e);
+    void evictOne();
+};
@@ -1,7 +1,8 @@
 #pragma once
 #include <optional>
 #include <cstddef>
-#include <functional>
+#include <cstdint>
+#include <vector>
 
 struct OpCounters {
     long long hits = 0;
@@ -9,9 +10,28 @@ struct OpCounters {
     long long puts = 0;
     long long gets = 0;
     long long evictions = 0;
+    long long expired = 0;      // сняты по истечении TTL (в evictions не входят)
 };
 
-extern std::function<void(int)> g_on_evict_key;
+// Причина, по которой запись покинула кэш
+enum class EvictReason { Capacity, Erase, Expired };
+
+// Режим односвязных Rec-движков. Plain — только список: поиск проходом O(n),
+// минимум памяти на запись. Indexed — плюс компактный индекс ключ -> предшественник,
+// get/put/erase за O(1) ценой одного слота FlatIndex на запись.
+enum class RecMode { Plain, Indexed };
+
+// Запись снимка содержимого (Snapshot.h). freq — частота у LFU, бит обращения
+// у CLOCK, 0 у LRU.
+struct SnapshotEntry { int key; int val; uint32_t freq; };
+
+// Слушатель вытеснений конкретного экземпляра кэша.
+// Вызывается в потоке, который выполнил операцию.
+class EvictionListener {
+public:
+    virtual ~EvictionListener() = default;
+    virtual void onEvict(int key, int value, EvictReason reason) = 0;
+};
 
 class ICache {
 public:
@@ -21,4 +41,35 @@ public:
     virtual size_t size() const = 0;
     virtual size_t capacity() const = 0;
     virtual const OpCounters& counters() const = 0;
+    // Явное удаление; слушатель получает EvictReason::Erase
+    virtual bool erase(int key) = 0;
+    virtual void setEvictionListener(EvictionListener* l) { listener_ = l; }
+
+    // Пакетные операции. По умолчанию — поштучный цикл; движки переопределяют их,
+    // чтобы сначала посчитать хеши и запустить предвыборку, а потом разрешить пакет.
+    virtual void getMany(const int* keys, size_t n, std::optional<int>* out) {
+        for (size_t i = 0; i < n; ++i) out[i] = get(keys[i]);
+    }
+    virtual void putMany(const int* keys, const int* values, size_t n) {
+        for (size_t i = 0; i < n; ++i) put(keys[i], values[i]);
+    }
+
+    // Снимок: дописывает в out все записи от первого кандидата на вытеснение
+    // к самой ценной. false — движок снимки не поддерживает (out не тронут).
+    virtual bool exportEntries(std::vector<SnapshotEntry>& out) const { (void)out; return false; }
+    // Сборка пустого кэша из снимка (n <= capacity(), порядок как у exportEntries).
+    // По умолчанию — put по порядку, что восстанавливает LRU-порядок, но не частоты;
+    // движки со снимками строят структуры напрямую, без поиска и вытеснений.
+    virtual void importEntries(const SnapshotEntry* e, size_t n) {
+        for (size_t i = 0; i < n; ++i) put(e[i].key, e[i].val);
+    }
+
+protected:
+    EvictionListener* listener_ = nullptr;
+    void notifyEvict(int key, int value, EvictReason reason) {
+        if (listener_) listener_->onEvict(key, value, reason);
+    }
 };
+
+// Размер группы внутри getMany/putMany: столько промахов держим «в полёте»
+constexpr size_t kBatchGroup = 32;
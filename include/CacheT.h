@@ -0,0 +1,335 @@
+#pragma once
+#include "CacheBase.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Шаблонное семейство кэшей: политика × ключ × значение × хешер.
+// Всё в заголовке, чтобы горячий путь инлайнился в вызывающий код.
+// Хранение как у LRUCacheFlat/LFUCachePool: записи в одном векторе размера
+// capacity, политика работает только с 32-битными номерами слотов.
+
+inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27; x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+// Хешер по умолчанию: std::hash + перемешивание (std::hash<int> — тождественный)
+template <class K>
+struct HashOf {
+    uint64_t operator()(const K& k) const { return mix64(static_cast<uint64_t>(std::hash<K>{}(k))); }
+};
+
+// Индекс hash -> слот. Ключи в нём не дублируются: сравнение идёт через
+// сохранённый 32-битный хеш, а затем по ключу в массиве записей.
+class SlotIndex {
+public:
+    static constexpr uint32_t kNil = UINT32_MAX;
+
+    explicit SlotIndex(size_t expected) {
+        size_t n = 8;
+        while (n < expected * 2) n <<= 1;
+        slots_.assign(n, Slot{0, kNil});
+        mask_ = n - 1;
+    }
+
+    template <class Eq>
+    uint32_t find(uint32_t h, Eq eqAt) const {
+        for (size_t i = h & mask_;; i = (i + 1) & mask_) {
+            const Slot& s = slots_[i];
+            if (s.idx == kNil) return kNil;
+            if (s.hash == h && eqAt(s.idx)) return s.idx;
+        }
+    }
+
+    void insert(uint32_t h, uint32_t idx) {
+        size_t i = h & mask_;
+        while (slots_[i].idx != kNil) i = (i + 1) & mask_;
+        slots_[i] = Slot{h, idx};
+    }
+
+    void erase(uint32_t h, uint32_t idx) {
+        size_t i = h & mask_;
+        while (slots_[i].idx != idx) i = (i + 1) & mask_;
+        for (size_t j = (i + 1) & mask_; slots_[j].idx != kNil; j = (j + 1) & mask_) {
+            size_t home = slots_[j].hash & mask_;
+            bool inRange = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+            if (inRange) continue;
+            slots_[i] = slots_[j];
+            i = j;
+        }
+        slots_[i].idx = kNil;
+    }
+
+    void prefetch(uint32_t h) const { __builtin_prefetch(&slots_[h & mask_]); }
+    size_t bytes() const { return slots_.size() * sizeof(Slot); }
+
+private:
+    struct Slot { uint32_t hash; uint32_t idx; };
+    TrackedVector<Slot> slots_;
+    size_t mask_ = 0;
+};
+
+// ---- Политики вытеснения: метаданные по номерам слотов ----
+
+class LRUPolicy {
+public:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    explicit LRUPolicy(size_t cap) : links_(cap) {}
+
+    void onInsert(uint32_t i) { pushFront(i); }
+    void onAccess(uint32_t i) { if (i != head_) { unlink(i); pushFront(i); } }
+    void onRemove(uint32_t i) { unlink(i); }
+    uint32_t victim() const { return tail_; }
+    size_t bytes() const { return links_.capacity() * sizeof(Link); }
+
+private:
+    struct Link { uint32_t prev, next; };
+    TrackedVector<Link> links_;
+    uint32_t head_ = kNil, tail_ = kNil;
+
+    void unlink(uint32_t i) {
+        Link& l = links_[i];
+        if (l.prev != kNil) links_[l.prev].next = l.next; else head_ = l.next;
+        if (l.next != kNil) links_[l.next].prev = l.prev; else tail_ = l.prev;
+    }
+    void pushFront(uint32_t i) {
+        links_[i] = Link{kNil, head_};
+        if (head_ != kNil) links_[head_].prev = i; else tail_ = i;
+        head_ = i;
+    }
+};
+
+// LFU за O(1) (схема LFUCachePool): список узлов частот, в каждом — записи
+// от свежих к давним, поэтому при равной частоте вытесняется самая давняя.
+class LFUPolicy {
+public:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    explicit LFUPolicy(size_t cap) : links_(cap), buckets_(cap + 1) {
+        for (uint32_t b = 0; b < buckets_.size(); ++b)
+            buckets_[b].next = (b + 1 < buckets_.size()) ? b + 1 : kNil;
+        free_ = buckets_.empty() ? kNil : 0;
+    }
+
+    void onInsert(uint32_t i) {
+        uint32_t b = (min_ != kNil && buckets_[min_].freq == 1) ? min_ : alloc(1, kNil);
+        attachFront(i, b);
+    }
+    void onAccess(uint32_t i) {
+        uint32_t b = links_[i].bucket;
+        uint32_t f = buckets_[b].freq;
+        uint32_t nx = buckets_[b].next;
+        bool nextFits = nx != kNil && buckets_[nx].freq == f + 1;
+        if (!nextFits && buckets_[b].head == i && buckets_[b].tail == i) { buckets_[b].freq = f + 1; return; }
+        if (!nextFits) nx = alloc(f + 1, b);
+        detach(i);
+        attachFront(i, nx);
+        releaseIfEmpty(b);
+    }
+    void onRemove(uint32_t i) {
+        uint32_t b = links_[i].bucket;
+        detach(i);
+        releaseIfEmpty(b);
+    }
+    uint32_t victim() const { return buckets_[min_].tail; }
+    size_t bytes() const { return links_.capacity() * sizeof(Link) + buckets_.capacity() * sizeof(Bucket); }
+
+private:
+    struct Link { uint32_t prev, next, bucket; };
+    struct Bucket { uint32_t freq, prev, next, head, tail; };
+    TrackedVector<Link> links_;
+    TrackedVector<Bucket> buckets_;
+    uint32_t min_ = kNil, free_ = kNil;
+
+    uint32_t alloc(uint32_t freq, uint32_t after) {
+        uint32_t b = free_;
+        free_ = buckets_[b].next;
+        Bucket& nb = buckets_[b];
+        nb.freq = freq;
+        nb.head = nb.tail = kNil;
+        nb.prev = after;
+        nb.next = (after == kNil) ? min_ : buckets_[after].next;
+        if (nb.next != kNil) buckets_[nb.next].prev = b;
+        if (after == kNil) min_ = b; else buckets_[after].next = b;
+        return b;
+    }
+    void releaseIfEmpty(uint32_t b) {
+        Bucket& ob = buckets_[b];
+        if (ob.head != kNil) return;
+        if (ob.prev != kNil) buckets_[ob.prev].next = ob.next; else min_ = ob.next;
+        if (ob.next != kNil) buckets_[ob.next].prev = ob.prev;
+        ob.next = free_;
+        free_ = b;
+    }
+    void detach(uint32_t i) {
+        Link& l = links_[i];
+        Bucket& b = buckets_[l.bucket];
+        if (l.prev != kNil) links_[l.prev].next = l.next; else b.head = l.next;
+        if (l.next != kNil) links_[l.next].prev = l.prev; else b.tail = l.prev;
+    }
+    void attachFront(uint32_t i, uint32_t b) {
+        Bucket& bk = buckets_[b];
+        links_[i] = Link{kNil, bk.head, b};
+        if (bk.head != kNil) links_[bk.head].prev = i; else bk.tail = i;
+        bk.head = i;
+    }
+};
+
+// ---- Слушатели вытеснений (параметр шаблона) ----
+
+// «Нет слушателя»: пустой тип без состояния, вызов целиком вырезается компилятором
+struct NoEvictionListener {
+    static constexpr bool enabled = false;
+    template <class K, class V>
+    void onEvict(const K&, const V&, EvictReason) {}
+};
+
+// Мост к динамическому EvictionListener (int -> int); нужен CacheAdapter
+struct DynamicEvictionListener {
+    static constexpr bool enabled = true;
+    EvictionListener* target = nullptr;
+    void onEvict(int key, int value, EvictReason reason) {
+        if (target) target->onEvict(key, value, reason);
+    }
+};
+
+// ---- Кэш ----
+
+// Слушатель хранится как приватная база: пустой тип не занимает места (EBO).
+template <class Policy, class K, class V, class Hash = HashOf<K>, class Listener = NoEvictionListener>
+class CacheT : private Listener {
+public:
+    using listener_type = Listener;
+    static constexpr uint32_t kNil = SlotIndex::kNil;
+
+    explicit CacheT(size_t cap, Listener listener = Listener())
+        : Listener(std::move(listener)), cap_(cap), entries_(cap), index_(cap), policy_(cap) {
+        free_.reserve(cap);
+    }
+
+    Listener& listener() { return *this; }
+
+    // Горячий путь: указатель на значение или nullptr
+    V* find(const K& key) {
+        cnt_.gets++;
+        uint32_t i = lookup(key, hashOf(key));
+        if (i == kNil) { cnt_.misses++; return nullptr; }
+        policy_.onAccess(i);
+        cnt_.hits++;
+        return &entries_[i].val;
+    }
+
+    std::optional<V> get(const K& key) {
+        V* v = find(key);
+        if (!v) return std::nullopt;
+        return *v;
+    }
+
+    void put(const K& key, V value) {
+        cnt_.puts++;
+        if (cap_ == 0) return;
+        uint32_t h = hashOf(key);
+        uint32_t i = lookup(key, h);
+        if (i != kNil) {
+            entries_[i].val = std::move(value);
+            policy_.onAccess(i);
+            return;
+        }
+        if (sz_ == cap_) {
+            i = policy_.victim();
+            policy_.onRemove(i);
+            index_.erase(entries_[i].hash, i);
+            cnt_.evictions++;
+            if constexpr (Listener::enabled)
+                Listener::onEvict(entries_[i].key, entries_[i].val, EvictReason::Capacity);
+        } else if (!free_.empty()) {
+            i = free_.back(); free_.pop_back(); sz_++;
+        } else {
+            i = sz_++;
+        }
+        Entry& e = entries_[i];
+        e.key = key;
+        e.val = std::move(value);
+        e.hash = h;
+        index_.insert(h, i);
+        policy_.onInsert(i);
+    }
+
+    bool erase(const K& key) {
+        uint32_t h = hashOf(key);
+        uint32_t i = lookup(key, h);
+        if (i == kNil) return false;
+        policy_.onRemove(i);
+        index_.erase(h, i);
+        free_.push_back(i);
+        sz_--;
+        if constexpr (Listener::enabled)
+            Listener::onEvict(entries_[i].key, entries_[i].val, EvictReason::Erase);
+        return true;
+    }
+
+    size_t size() const { return sz_; }
+    size_t capacity() const { return cap_; }
+    const OpCounters& counters() const { return cnt_; }
+
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+        const size_t payload = sizeof(K) + sizeof(V);
+        theoretical = cap_ * payload;
+        actual = sz_ * payload;
+        overhead = entries_.capacity() * sizeof(Entry) + free_.capacity() * sizeof(uint32_t)
+                 + index_.bytes() + policy_.bytes() - actual;
+    }
+
+private:
+    struct Entry { K key; V val; uint32_t hash; };
+    size_t cap_;
+    uint32_t sz_ = 0;
+    TrackedVector<Entry> entries_;
+    TrackedVector<uint32_t> free_;
+    SlotIndex index_;
+    Policy policy_;
+    OpCounters cnt_;
+
+    static uint32_t hashOf(const K& key) { return static_cast<uint32_t>(Hash{}(key)); }
+    uint32_t lookup(const K& key, uint32_t h) const {
+        return index_.find(h, [&](uint32_t j) { return entries_[j].key == key; });
+    }
+};
+
+template <class K, class V, class Hash = HashOf<K>, class Listener = NoEvictionListener>
+using LRUCacheT = CacheT<LRUPolicy, K, V, Hash, Listener>;
+
+template <class K, class V, class Hash = HashOf<K>, class Listener = NoEvictionListener>
+using LFUCacheT = CacheT<LFUPolicy, K, V, Hash, Listener>;
+
+// Тонкий type-erased адаптер к ICache для существующего кода (int -> int).
+// Вытеснения доходят до слушателя ICache, только если Impl собран с DynamicEvictionListener.
+template <class Impl>
+class CacheAdapter : public ICache {
+public:
+    explicit CacheAdapter(size_t cap) : impl_(cap) {}
+    void put(int key, int value) override { impl_.put(key, value); }
+    std::optional<int> get(int key) override { return impl_.get(key); }
+    bool erase(int key) override { return impl_.erase(key); }
+    void setEvictionListener(EvictionListener* l) override {
+        listener_ = l;
+        if constexpr (std::is_same_v<typename Impl::listener_type, DynamicEvictionListener>)
+            impl_.listener().target = l;
+    }
+    size_t size() const override { return impl_.size(); }
+    size_t capacity() const override { return impl_.capacity(); }
+    const OpCounters& counters() const override { return impl_.counters(); }
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+        impl_.estimateMemory(theoretical, actual, overhead);
+    }
+    Impl& impl() { return impl_; }
+private:
+    Impl impl_;
+};
@@ -0,0 +1,50 @@
+#pragma once
+#include "CacheBase.h"
+#include "Stats.h"
+#include "TrackingAllocator.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+// CLOCK с чтением без блокировок.
+// Попадание в get — только relaxed-запись бита обращения, узлы никуда не двигаются.
+// put и вытеснение (проход «стрелки» по битам) идут под мьютексом и публикуются
+// через seqlock; читатель перепроверяет версию и при гонке повторяет поиск,
+// после нескольких неудач — берёт мьютекс.
+class ClockCache : public ICache {
+public:
+    explicit ClockCache(size_t cap);
+    void put(int key, int value) override;
+    std::optional<int> get(int key) override;
+    size_t size() const override { return sz_.load(std::memory_order_relaxed); }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override;
+    bool erase(int key) override;
+    bool exportEntries(std::vector<SnapshotEntry>& out) const override;
+    void importEntries(const SnapshotEntry* e, size_t n) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    static constexpr int kOptimisticTries = 4;
+    size_t cap_;
+    size_t mask_ = 0;
+    std::atomic<uint32_t> sz_{0};
+    uint32_t hand_ = 0;
+    // Слот индекса: (key << 32) | (slot + 1); 0 — пусто
+    TrackedVector<std::atomic<uint64_t>> table_;
+    TrackedVector<int> keys_;                        // только под mu_
+    TrackedVector<uint32_t> free_;                   // слоты после erase, только под mu_
+    TrackedVector<std::atomic<int>> vals_;
+    TrackedVector<std::atomic<uint8_t>> refs_;
+    std::atomic<uint64_t> seq_{0};
+    mutable std::mutex mu_;
+    ShardedStats stats_;                             // счётчики по слотам потоков
+    mutable OpCounters snapshot_;
+
+    size_t home(int key) const;
+    uint32_t probe(int key) const;
+    void indexInsert(int key, uint32_t slot);
+    void indexErase(int key);
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include "CacheBase.h"
+#include "Workload.h"
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Движок в реестре: фабрика по ёмкости и аналитическая оценка памяти
+// (estimateMemory у движков не виртуальный, поэтому реестр помнит тип).
+struct EngineEntry {
+    std::string algo, impl;
+    bool thread_safe = false;     // можно звать из нескольких потоков без ShardedCache
+    std::function<std::unique_ptr<ICache>(size_t cap)> make;
+    std::function<void(const ICache&, size_t&, size_t&, size_t&)> estimate;
+    std::string name() const { return algo + "/" + impl; }
+};
+
+// Все движки с ёмкостью как единственным обязательным параметром, в порядке
+// results_extended.csv. Имя — "algo/impl", например "LRU/flat".
+const std::vector<EngineEntry>& engineRegistry();
+const EngineEntry* findEngine(const std::string& name);
+// "all", точное имя или маска с * на месте алгоритма или реализации ("LRU/*", "*/flat")
+std::vector<const EngineEntry*> selectEngines(const std::string& pattern);
+// Несколько масок подряд: движки в порядке масок, без повторов. Для секций main,
+// которые гоняют фиксированный набор движков в заданном порядке строк CSV.
+std::vector<const EngineEntry*> selectEngineList(const std::vector<std::string>& patterns);
+
+// Нагрузка матрицы: WorkloadSpec плюс вселенная относительно ёмкости
+struct MatrixWorkload {
+    std::string name;
+    WorkloadSpec spec;
+    double universe_per_cap = 4.0;   // > 0 — universe = cap · это; 0 — spec.universe как есть
+};
+
+// Матрица экспериментов: движки × ёмкости × нагрузки × потоки × пакеты × повторы.
+// Каждая клетка — отдельный экземпляр движка; первые warmup_fraction операций
+// нагрузки прогревают его и в метрики не идут, первые discard_trials повторов
+// клетки выбрасываются целиком.
+struct MatrixSpec {
+    std::vector<std::string> engines = {"LRU/flat", "LFU/pool", "CLOCK/lockfree", "TinyLFU/window"};
+    std::vector<size_t> capacities = {1024, 65536};
+    std::vector<MatrixWorkload> workloads;        // пусто — одна zipf: Zipf(0.99), 30% put, universe 4x
+    std::vector<int> threads = {1};
+    std::vector<size_t> batches = {1};            // > 1 — getMany/putMany пакетами такого размера
+    long long ops = 1000000;                      // операций нагрузки на клетку (с прогревом)
+    double warmup_fraction = 0.1;
+    int trials = 3;
+    int discard_trials = 1;
+    size_t shards = 16;                           // ShardedCache для движков без thread_safe при threads > 1
+    std::vector<int> pin_cpus;                    // пусто — без привязки; поток t — на pin_cpus[t % size]
+    bool pin_auto = false;                        // pin = auto: поток t — на ядро t % hardware_concurrency
+    uint64_t seed = 42;
+    std::string output = "matrix_results.csv";
+};
+
+// Одна строка "ключ = значение" (или "ключ=значение" из командной строки).
+// Пустые строки и # комментарии пропускаются. false — err объясняет, что не так.
+bool applyMatrixSetting(MatrixSpec& spec, const std::string& line, std::string& err);
+// Файл из таких строк; false — не открылся или строка с ошибкой (err с номером строки)
+bool loadMatrixConfig(MatrixSpec& spec, const std::string& path, std::string& err);
+
+// Прогон матрицы в spec.output (длинный формат: одна строка — одна метрика
+// одного повтора). Возвращает число записанных повторов или -1 при ошибке;
+// ход прогона и ошибки — в log.
+long long runMatrix(const MatrixSpec& spec, std::ostream& log);
@@ -0,0 +1,99 @@
+#pragma once
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Пустое значение слота: максимум для целых, nullptr для указателей
+template <class V>
+struct FlatIndexEmpty { static constexpr V value = std::numeric_limits<V>::max(); };
+template <class T>
+struct FlatIndexEmpty<T*> { static constexpr T* value = nullptr; };
+
+// Компактный хеш-индекс key -> значение (по умолчанию 32-битный номер слота).
+// Открытая адресация с линейным пробированием, удаление сдвигом назад
+// (без tombstone'ов), загрузка не выше 50%. Память выделяется один раз в конструкторе.
+template <class V>
+class BasicFlatIndex {
+public:
+    static constexpr V kEmpty = FlatIndexEmpty<V>::value;
+
+    explicit BasicFlatIndex(size_t expected) {
+        size_t n = 8;
+        while (n < expected * 2) n <<= 1;
+        slots_.assign(n, Slot{0, kEmpty});
+        mask_ = n - 1;
+    }
+
+    V find(int key) const {
+        for (size_t i = home(key);; i = (i + 1) & mask_) {
+            const Slot& s = slots_[i];
+            if (s.val == kEmpty) return kEmpty;
+            if (s.key == key) return s.val;
+        }
+    }
+
+    // Ключ не должен присутствовать в индексе.
+    void insert(int key, V val) {
+        size_t i = home(key);
+        while (slots_[i].val != kEmpty) i = (i + 1) & mask_;
+        slots_[i] = Slot{key, val};
+    }
+
+    // Ключ должен присутствовать в индексе.
+    void assign(int key, V val) {
+        size_t i = home(key);
+        while (slots_[i].key != key || slots_[i].val == kEmpty) i = (i + 1) & mask_;
+        slots_[i].val = val;
+    }
+
+    bool erase(int key) {
+        size_t i = home(key);
+        for (;; i = (i + 1) & mask_) {
+            if (slots_[i].val == kEmpty) return false;
+            if (slots_[i].key == key) break;
+        }
+        // Сдвигаем назад элементы цепочки, чья «домашняя» позиция не лежит в (i, j]
+        for (size_t j = (i + 1) & mask_; slots_[j].val != kEmpty; j = (j + 1) & mask_) {
+            size_t h = home(slots_[j].key);
+            bool inRange = (i <= j) ? (i < h && h <= j) : (i < h || h <= j);
+            if (inRange) continue;
+            slots_[i] = slots_[j];
+            i = j;
+        }
+        slots_[i].val = kEmpty;
+        return true;
+    }
+
+    // Обход занятых слотов: f(key, val)
+    template <class F>
+    void forEach(F f) const {
+        for (const Slot& s : slots_)
+            if (s.val != kEmpty) f(s.key, s.val);
+    }
+
+    // Сколько ключей помещается, не превышая загрузку 50%
+    size_t capacity() const { return slots_.size() / 2; }
+
+    void prefetch(int key) const { __builtin_prefetch(&slots_[home(key)]); }
+
+    size_t bytes() const { return slots_.size() * sizeof(Slot); }
+
+    static uint32_t mix(int key) {
+        uint32_t h = static_cast<uint32_t>(key);
+        h ^= h >> 16; h *= 0x85ebca6bu;
+        h ^= h >> 13; h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h;
+    }
+
+private:
+    struct Slot { int key; V val; };
+    TrackedVector<Slot> slots_;
+    size_t mask_ = 0;
+
+    size_t home(int key) const { return mix(key) & mask_; }
+};
+
+using FlatIndex = BasicFlatIndex<uint32_t>;
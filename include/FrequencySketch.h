@@ -0,0 +1,26 @@
+#pragma once
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Count-min sketch с 4-битными счётчиками для TinyLFU.
+// Все 4 счётчика ключа лежат в одном 64-байтном блоке (8 слов по 16 счётчиков),
+// поэтому increment/estimate трогают одну кеш-линию. Раз в sampleSize добавлений
+// все счётчики делятся пополам (старение), так что частоты «забываются».
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t capacity);
+    void increment(int key);
+    int estimate(int key) const;
+    size_t bytes() const { return blocks_.size() * sizeof(Block); }
+    long long resets() const { return resets_; }
+private:
+    struct alignas(64) Block { uint64_t w[8]; };
+    TrackedVector<Block> blocks_;
+    size_t blockMask_ = 0;
+    size_t additions_ = 0;
+    size_t sampleSize_ = 0;
+    long long resets_ = 0;
+    void age();
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include "CacheBase.h"
+#include "FlatIndex.h"
+#include "SlabArena.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// GreedyDual-Size (Cao & Irani): ёмкость — бюджет в байтах, у записи есть
+// размер и стоимость промаха. Приоритет H = L + cost / size; вытесняется запись
+// с минимальным H, а «инфляция» L поднимается до её H — так давно не тронутые
+// записи стареют без пересчёта остальных. cost = 1 выгоден по числу попаданий
+// (мелкие объекты живут дольше), cost = size даёт LRU по байтам.
+//
+// Значения лежат в SlabArena: бюджет плюс 25% запаса под неполные страницы,
+// так что фрагментация ограничена этим запасом. На каждый класс размеров арены
+// своя min-куча, глобальный минимум ищется по вершинам куч. Если по байтам
+// место есть, а в нужном классе арены нет свободного куска, вытесняем минимум
+// этого же класса (как memcached) — такие вытеснения считаются отдельно
+// (arenaEvictions) как цена фрагментации.
+class GDSCache : public ICache {
+public:
+    GDSCache(size_t byteBudget, uint32_t pageSize = 256u << 10, uint32_t defaultSize = SlabArena::kMinChunk);
+
+    // Запись с размером значения (байт) и стоимостью промаха
+    void put(int key, int value, uint32_t bytes, double cost);
+    void put(int key, int value) override { put(key, value, defaultSize_, 1.0); }
+    std::optional<int> get(int key) override;
+    // Байты значения в арене; nullptr, если ключа нет
+    char* payload(int key);
+
+    size_t size() const override { return sz_; }
+    // Номинальная ёмкость в записях по defaultSize — для общих сценариев
+    size_t capacity() const override { return budget_ / arena_.chunkSize(defaultSize_); }
+    size_t byteBudget() const { return budget_; }
+    size_t usedBytes() const { return used_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    long long arenaEvictions() const { return arenaEvictions_; }
+    // Текущая инфляция L; не убывает
+    double inflation() const { return inflation_; }
+    const SlabArena& arena() const { return arena_; }
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+
+private:
+    struct Node {
+        double h;             // приоритет
+        double cost;
+        uint64_t seq;         // при равных H раньше уходит давно тронутая запись
+        int key, val;
+        uint32_t bytes;
+        uint32_t handle;
+        uint32_t heapPos;
+        uint32_t cls;         // класс размеров арены = номер кучи
+    };
+    size_t budget_;
+    uint32_t defaultSize_;
+    SlabArena arena_;
+    TrackedVector<Node> nodes_;
+    TrackedVector<uint32_t> free_;
+    TrackedVector<TrackedVector<uint32_t>> heaps_;   // по классу: min-куча узлов по (h, seq)
+    FlatIndex index_;
+    double inflation_ = 0.0;         // L
+    uint64_t clock_ = 0;
+    size_t used_ = 0;                // байты кусков арены под записями
+    uint32_t sz_ = 0;
+    OpCounters cnt_;
+    long long arenaEvictions_ = 0;
+
+    bool less(uint32_t a, uint32_t b) const {
+        const Node& x = nodes_[a];
+        const Node& y = nodes_[b];
+        return x.h < y.h || (x.h == y.h && x.seq < y.seq);
+    }
+    void touch(uint32_t i);
+    void siftUp(TrackedVector<uint32_t>& heap, uint32_t pos);
+    void siftDown(TrackedVector<uint32_t>& heap, uint32_t pos);
+    void remove(uint32_t i);
+    void evict(uint32_t i);
+    bool evictMin();
+};
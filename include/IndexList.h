@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+// Интрузивный двусвязный список по 32-битным индексам.
+// Сами связи лежат в чужом массиве узлов (поля prev/next), список хранит
+// только голову, хвост и длину — так в одном массиве живут несколько списков.
+struct IndexList {
+    static constexpr uint32_t kNil = UINT32_MAX;
+    uint32_t head = kNil;
+    uint32_t tail = kNil;
+    uint32_t size = 0;
+
+    template <class Nodes>
+    void pushFront(Nodes& nodes, uint32_t i) {
+        nodes[i].prev = kNil;
+        nodes[i].next = head;
+        if (head != kNil) nodes[head].prev = i; else tail = i;
+        head = i;
+        size++;
+    }
+
+    template <class Nodes>
+    void unlink(Nodes& nodes, uint32_t i) {
+        auto& n = nodes[i];
+        if (n.prev != kNil) nodes[n.prev].next = n.next; else head = n.next;
+        if (n.next != kNil) nodes[n.next].prev = n.prev; else tail = n.prev;
+        size--;
+    }
+
+    template <class Nodes>
+    void moveToFront(Nodes& nodes, uint32_t i) {
+        if (i == head) return;
+        unlink(nodes, i);
+        pushFront(nodes, i);
+    }
+
+    bool empty() const { return size == 0; }
+};
@@ -1,8 +1,13 @@
 #pragma once
 #include "CacheBase.h"
+#include "FlatIndex.h"
+#include "TimerWheel.h"
+#include "TrackingAllocator.h"
 #include <unordered_map>
 #include <list>
 #include <optional>
+#include <vector>
+#include <cstdint>
 
 class LFUCacheIter : public ICache {
 public:
@@ -12,38 +17,106 @@ public:
     size_t size() const override { return sz_; }
     size_t capacity() const override { return cap_; }
     const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void getMany(const int* keys, size_t n, std::optional<int>* out) override;
+    void putMany(const int* keys, const int* values, size_t n) override;
+    bool exportEntries(std::vector<SnapshotEntry>& out) const override;
+    void importEntries(const SnapshotEntry* e, size_t n) override;
     void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
 private:
     struct Node { int key, val, freq; };
     size_t cap_, sz_ = 0, minFreq_ = 0;
-    std::unordered_map<int, std::list<Node>::iterator> pos_;
-    std::unordered_map<int, std::list<Node>> buckets_;
+    TrackedHashMap<int, TrackedList<Node>::iterator> pos_;
+    TrackedHashMap<int, TrackedList<Node>> buckets_;
     OpCounters cnt_;
-    void touch(std::unordered_map<int, std::list<Node>::iterator>::iterator it);
+    void touch(TrackedHashMap<int, TrackedList<Node>::iterator>::iterator it);
     void evictOne();
 };
 
+// Односвязный LFU: список упорядочен по частоте (редкие в начале), внутри одной
+// частоты — сначала последние пришедшие в неё; вытесняется голова. Обход итеративный.
+// В режиме Indexed, кроме индекса ключ -> предшественник, ведётся индекс
+// частота -> последний узел этой частоты, и повышение частоты не ищет место проходом.
 class LFUCacheRec : public ICache {
 public:
-    explicit LFUCacheRec(size_t cap);
+    explicit LFUCacheRec(size_t cap, RecMode mode = RecMode::Plain);
     ~LFUCacheRec();
+    LFUCacheRec(const LFUCacheRec&) = delete;
+    LFUCacheRec& operator=(const LFUCacheRec&) = delete;
     void put(int key, int value) override;
     std::optional<int> get(int key) override;
     size_t size() const override { return sz_; }
     size_t capacity() const override { return cap_; }
     const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    bool exportEntries(std::vector<SnapshotEntry>& out) const override;
+    void importEntries(const SnapshotEntry* e, size_t n) override;
     void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+    RecMode mode() const { return pred_ ? RecMode::Indexed : RecMode::Plain; }
     long long total_allocations() const { return allocations_; }
     long long total_deallocations() const { return deallocations_; }
 private:
-    struct Node { int key, val, freq; Node* next; };
-    Node* head_ = nullptr;
+    struct Node {
+        int key, val, freq; Node* next;
+        static void* operator new(size_t n) { return trackedAlloc(n, alignof(Node)); }
+        static void operator delete(void* p, size_t n) { trackedFree(p, n); }
+    };
+    Node sentinel_{0, 0, 0, nullptr};       // sentinel_.next — голова списка
     size_t cap_, sz_ = 0;
+    std::optional<BasicFlatIndex<Node*>> pred_;   // ключ -> предшественник (Indexed)
+    std::optional<BasicFlatIndex<Node*>> last_;   // частота -> последний узел (Indexed)
+    size_t runs_ = 0;                             // число ключей в last_
     OpCounters cnt_;
     long long allocations_ = 0;
     long long deallocations_ = 0;
-    std::optional<int> getRec(Node* cur, int key);
-    bool putUpdateRec(Node* cur, int key, int value);
-    std::pair<Node*, Node*> findMinPrevRec(Node* prev, Node* cur, Node* bestPrev, Node* best);
+    Node* findPrev(int key);
+    Node* runLast(Node* x);
+    void dropFromRun(Node* prev, Node* x);
+    void openRun(int f, Node* x);
+    void unlink(Node* prev, Node* x);
+    void touch(Node* prev, Node* x);
     void freeList(Node* n);
 };
+
+// LFU за O(1): двусвязный список узлов частот (по возрастанию), у каждого —
+// интрузивный список записей (свежие в начале). Записи и узлы частот берутся
+// из пулов фиксированного размера; попадание — только перестановка индексов.
+class LFUCachePool : public ICache {
+public:
+    explicit LFUCachePool(size_t cap);
+    void put(int key, int value) override { put(key, value, 0); }
+    // TTL — как у LRUCacheFlat: таймеры в TimerWheel, истёкшие снимает advanceTime
+    void put(int key, int value, uint32_t ttl);
+    void advanceTime(uint64_t now);
+    uint64_t now() const { return wheel_.now(); }
+    std::optional<int> get(int key) override;
+    size_t size() const override { return sz_; }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void getMany(const int* keys, size_t n, std::optional<int>* out) override;
+    void putMany(const int* keys, const int* values, size_t n) override;
+    bool exportEntries(std::vector<SnapshotEntry>& out) const override;
+    void importEntries(const SnapshotEntry* e, size_t n) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    struct Node { int key, val; uint32_t prev, next, bucket; };
+    struct Bucket { uint32_t freq, prev, next, head, tail; };
+    size_t cap_;
+    uint32_t sz_ = 0;
+    uint32_t minBucket_ = kNil;     // голова списка частот = минимальная частота
+    uint32_t freeBucket_ = kNil;    // свободные узлы частот (через next)
+    TrackedVector<Node> nodes_;
+    TrackedVector<uint32_t> free_;    // слоты, освобождённые erase
+    TrackedVector<Bucket> buckets_;
+    FlatIndex index_;
+    TimerWheel wheel_;
+    OpCounters cnt_;
+    uint32_t allocBucket(uint32_t freq, uint32_t after);
+    void releaseBucketIfEmpty(uint32_t b);
+    void detach(uint32_t i);
+    void attachFront(uint32_t i, uint32_t b);
+    void touch(uint32_t i);
+    void expire(uint32_t i);
+};
@@ -1,8 +1,13 @@
 #pragma once
 #include "CacheBase.h"
+#include "FlatIndex.h"
+#include "TimerWheel.h"
+#include "TrackingAllocator.h"
 #include <list>
 #include <unordered_map>
 #include <optional>
+#include <vector>
+#include <cstdint>
 
 class LRUCacheIter : public ICache {
 public:
@@ -12,38 +17,101 @@ public:
     size_t size() const override { return order_.size(); }
     size_t capacity() const override { return cap_; }
     const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void getMany(const int* keys, size_t n, std::optional<int>* out) override;
+    void putMany(const int* keys, const int* values, size_t n) override;
+    bool exportEntries(std::vector<SnapshotEntry>& out) const override;
+    void importEntries(const SnapshotEntry* e, size_t n) override;
     void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
 private:
     using Node = std::pair<int,int>;
     size_t cap_;
-    std::list<Node> order_;
-    std::unordered_map<int, std::list<Node>::iterator> pos_;
+    TrackedList<Node> order_;
+    TrackedHashMap<int, TrackedList<Node>::iterator> pos_;
     OpCounters cnt_;
-    void touch(std::unordered_map<int, std::list<Node>::iterator>::iterator it);
+    void touch(TrackedHashMap<int, TrackedList<Node>::iterator>::iterator it);
 };
 
+// Односвязный LRU: свежие записи в начале списка, вытесняется хвост.
+// Обход итеративный (деструктор не зависит от глубины стека). В режиме Indexed
+// индекс хранит для каждого ключа узел перед ним, поэтому перестановка в начало
+// и снятие хвоста не требуют прохода по списку.
 class LRUCacheRec : public ICache {
 public:
-    explicit LRUCacheRec(size_t cap);
+    explicit LRUCacheRec(size_t cap, RecMode mode = RecMode::Plain);
     ~LRUCacheRec();
+    LRUCacheRec(const LRUCacheRec&) = delete;
+    LRUCacheRec& operator=(const LRUCacheRec&) = delete;
     void put(int key, int value) override;
     std::optional<int> get(int key) override;
     size_t size() const override { return sz_; }
     size_t capacity() const override { return cap_; }
     const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    bool exportEntries(std::vector<SnapshotEntry>& out) const override;
+    void importEntries(const SnapshotEntry* e, size_t n) override;
     void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+    RecMode mode() const { return pred_ ? RecMode::Indexed : RecMode::Plain; }
     long long total_allocations() const { return allocations_; }
     long long total_deallocations() const { return deallocations_; }
 private:
-    struct Node { int key, val; Node* next; };
-    Node* head_ = nullptr;
+    struct Node {
+        int key, val; Node* next;
+        static void* operator new(size_t n) { return trackedAlloc(n, alignof(Node)); }
+        static void operator delete(void* p, size_t n) { trackedFree(p, n); }
+    };
+    Node sentinel_{0, 0, nullptr};          // sentinel_.next — голова списка
+    Node* tail_ = nullptr;
     size_t cap_;
     size_t sz_ = 0;
+    std::optional<BasicFlatIndex<Node*>> pred_;   // ключ -> предшественник (Indexed)
     OpCounters cnt_;
     long long allocations_ = 0;
     long long deallocations_ = 0;
-    std::optional<int> getRec(Node* prev, Node* cur, int key);
-    bool putUpdateRec(Node* prev, Node* cur, int key, int value);
-    Node* removeTailRec(Node* cur, bool& removed);
+    Node* findPrev(int key);
+    void unlink(Node* prev, Node* x);
+    void pushFront(Node* x);
+    void moveToFront(Node* prev, Node* x);
+    void evictTail();
     void freeList(Node* n);
 };
+
+// LRU на плоском массиве: записи лежат в одном векторе размера capacity(),
+// связи prev/next — 32-битные индексы, поиск — через FlatIndex.
+// После конструктора память не выделяется (free_ резервируется заранее).
+// TTL: put(key, value, ttl) ставит таймер в TimerWheel; advanceTime снимает
+// истёкшие записи (EvictReason::Expired), поэтому при вытеснении мёртвых записей
+// в кэше уже нет и get не проверяет время. Точность — один тик.
+class LRUCacheFlat : public ICache {
+public:
+    explicit LRUCacheFlat(size_t cap);
+    void put(int key, int value) override { put(key, value, 0); }
+    // ttl в тиках от текущего времени; 0 — без срока (снимает прежний TTL)
+    void put(int key, int value, uint32_t ttl);
+    void advanceTime(uint64_t now);
+    uint64_t now() const { return wheel_.now(); }
+    std::optional<int> get(int key) override;
+    size_t size() const override { return sz_; }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void getMany(const int* keys, size_t n, std::optional<int>* out) override;
+    void putMany(const int* keys, const int* values, size_t n) override;
+    bool exportEntries(std::vector<SnapshotEntry>& out) const override;
+    void importEntries(const SnapshotEntry* e, size_t n) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+private:
+    static constexpr uint32_t kNil = UINT32_MAX;
+    struct Node { int key, val; uint32_t prev, next; };
+    size_t cap_;
+    uint32_t sz_ = 0;
+    uint32_t head_ = kNil, tail_ = kNil;
+    TrackedVector<Node> nodes_;
+    TrackedVector<uint32_t> free_;    // слоты, освобождённые erase
+    FlatIndex index_;
+    TimerWheel wheel_;
+    OpCounters cnt_;
+    void unlink(uint32_t i);
+    void pushFront(uint32_t i);
+    void expire(uint32_t i);
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Метка времени для замера одной операции: rdtsc на x86 (несериализующий,
+// ~10 нс на пару чтений), иначе steady_clock в наносекундах.
+inline uint64_t latencyTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Наносекунд на тик latencyTicks(); калибруется по steady_clock один раз за процесс
+double latencyNsPerTick();
+
+// Гистограмма задержек в духе HdrHistogram: значения до 64 пишутся точно,
+// дальше каждая степень двойки делится на 32 линейных поддиапазона
+// (относительная ошибка ≤ 1/32). record — O(1) без ветвлений по диапазону
+// и без выделений памяти; гистограммы разных прогонов складываются merge.
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 5;
+    static constexpr int kSub = 1 << kSubBits;
+    static constexpr int kBuckets = (64 - kSubBits + 1) * kSub;
+
+    LatencyHistogram() : counts_(kBuckets, 0) {}
+
+    static int bucketOf(uint64_t v) {
+        if (v < 2 * (uint64_t)kSub) return (int)v;
+        int e = 63 - __builtin_clzll(v) - kSubBits;
+        return (e + 1) * kSub + (int)((v >> e) - kSub);
+    }
+    static uint64_t bucketLow(int i) {
+        if (i < 2 * kSub) return (uint64_t)i;
+        int e = i / kSub - 1;
+        return (uint64_t)(i % kSub + kSub) << e;
+    }
+    static uint64_t bucketHigh(int i) {
+        return i + 1 < kBuckets ? bucketLow(i + 1) - 1 : UINT64_MAX;
+    }
+
+    void record(uint64_t v) {
+        counts_[bucketOf(v)]++;
+        total_++;
+        sum_ += v;
+        if (v < min_) min_ = v;
+        if (v > max_) max_ = v;
+    }
+    void merge(const LatencyHistogram& o);
+    void reset();
+
+    // Верхняя граница корзины, в которой лежит q-я доля значений (q в [0, 1])
+    uint64_t valueAt(double q) const;
+
+    uint64_t count() const { return total_; }
+    uint64_t min() const { return total_ ? min_ : 0; }
+    uint64_t max() const { return max_; }
+    double mean() const { return total_ ? (double)sum_ / total_ : 0.0; }
+    uint64_t countAt(int i) const { return counts_[i]; }
+    size_t bytes() const { return counts_.size() * sizeof(uint64_t); }
+
+private:
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t min_ = UINT64_MAX;
+    uint64_t max_ = 0;
+};
+
+// Процентили в наносекундах для строк CSV
+struct LatencySummary {
+    long long samples = 0;
+    double p50_ns = 0.0;
+    double p99_ns = 0.0;
+    double p999_ns = 0.0;
+    double max_ns = 0.0;
+};
+
+LatencySummary summarizeLatency(const LatencyHistogram& h);
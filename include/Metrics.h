@@ -25,6 +25,17 @@ struct CacheMetricsRow {
     size_t overhead_memory = 0;
     double memory_efficiency = 0.0;
     double overhead_pct = 0.0;
+    // Задержка одной операции (отдельный прогон на свежем экземпляре)
+    double p50_ns = 0.0;
+    double p99_ns = 0.0;
+    double p999_ns = 0.0;
+    double max_ns = 0.0;
+    // Измерения TrackingAllocator (тот же отдельный прогон)
+    size_t estimated_memory = 0;      // аналитика estimateMemory: actual + overhead
+    double bytes_per_entry = 0.0;
+    double allocs_per_op = 0.0;
+    double alloc_bytes_per_op = 0.0;
+    long long rss_delta = 0;
 };
 
 struct WarmupSeries {
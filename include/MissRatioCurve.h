@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "FlatIndex.h"
+
+// Кривая промахов LRU за один проход (Mattson): для каждого обращения считается
+// стековое расстояние — число разных ключей с прошлого обращения к тому же ключу.
+// LRU ёмкости C попадает ровно тогда, когда расстояние < C, поэтому одна гистограмма
+// расстояний даёт hit rate сразу для всех ёмкостей.
+//
+// Расстояние — запрос к дереву Фенвика по «временным слотам»: в слоте t стоит 1,
+// если обращение t — последнее для своего ключа. Когда слоты кончаются, живые
+// ключи перенумеровываются подряд, так что память — O(числа разных ключей).
+//
+// sample_rate < 1 — режим SHARDS (fixed-rate): учитываются только ключи с
+// hash(key) mod P < rate·P, расстояния масштабируются на 1/rate при запросе, а разница между
+// ожидаемым и фактическим числом выбранных обращений добавляется к расстоянию 0.
+class StackDistanceMRC {
+public:
+    explicit StackDistanceMRC(double sample_rate = 1.0);
+
+    void access(int key);
+
+    // Hit rate (%) LRU для каждой ёмкости из caps (demand fill: промах вставляет ключ)
+    std::vector<double> hitRates(const std::vector<size_t>& caps) const;
+
+    uint64_t accesses() const { return accesses_; }
+    uint64_t sampled() const { return sampled_; }
+    size_t distinct() const { return distinct_; }
+    double sampleRate() const { return rate_; }
+    size_t bytes() const;
+
+private:
+    double rate_;
+    uint64_t threshold_;                    // из 2^24: ключ берётся, если hash < threshold_
+    uint64_t accesses_ = 0;
+    uint64_t sampled_ = 0;
+    uint32_t now_ = 0;                      // следующий свободный слот
+    std::vector<uint32_t> tree_;            // дерево Фенвика по слотам (1-based)
+    std::vector<int> slotKey_;              // ключ, обратившийся в слот
+    std::vector<uint8_t> alive_;            // слот — последнее обращение своего ключа
+    FlatIndex last_;                        // ключ -> слот последнего обращения
+    size_t distinct_ = 0;
+    std::vector<uint64_t> hist_;            // hist_[d] — обращений с расстоянием d в выборке
+
+    void add(uint32_t slot, int delta);
+    uint32_t prefix(uint32_t slot) const;   // сумма по слотам [0, slot)
+    void compact();
+    void growIndex();
+};
+
+// Приближение для LFU: при независимых обращениях «идеальный» LFU ёмкости C
+// держит C самых частых ключей, и каждое обращение к ним, кроме первого, — попадание.
+// Считается по итоговым частотам, поэтому не видит смены горячего множества.
+class FrequencyMRC {
+public:
+    FrequencyMRC() : index_(1024) {}
+    void access(int key);
+    std::vector<double> hitRates(const std::vector<size_t>& caps) const;
+    uint64_t accesses() const { return accesses_; }
+    size_t distinct() const { return counts_.size(); }
+private:
+    FlatIndex index_;                       // ключ -> номер счётчика
+    std::vector<uint32_t> counts_;
+    uint64_t accesses_ = 0;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+// Аппаратные счётчики через perf_event_open (только Linux, только user space).
+// Каждое событие открывается отдельно: если PMU не хватает, ядро мультиплексирует
+// их, и значения масштабируются на time_enabled / time_running. Событие, которое
+// не удалось открыть (нет PMU в виртуалке, perf_event_paranoid, seccomp), помечается
+// недоступным, остальные работают; без единого счётчика recorder просто выключен.
+enum PerfEvent {
+    kPerfCycles,
+    kPerfInstructions,
+    kPerfL1DMisses,
+    kPerfLLCMisses,
+    kPerfBranchMisses,
+    kPerfDTLBMisses,
+    kPerfPageFaults,      // программное событие: есть и там, где нет PMU
+    kPerfEventCount
+};
+
+struct PerfSample {
+    std::array<double, kPerfEventCount> value{};
+    std::array<bool, kPerfEventCount> valid{};
+    bool any() const {
+        for (bool v : valid) if (v) return true;
+        return false;
+    }
+};
+
+class PerfCounters {
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    int available() const;            // сколько событий удалось открыть
+    bool opened(int event) const { return fd_[event] >= 0; }
+    void start();                     // сброс и запуск всех открытых событий
+    PerfSample stop();                // остановка и чтение
+
+    static const char* name(int event);
+
+private:
+    std::array<int, kPerfEventCount> fd_;
+};
+
+// Колонки CSV с нормировкой на операцию; недоступное событие — пустое поле
+constexpr const char* kPerfCsvColumns =
+    ",cycles_per_op,instructions_per_op,l1d_misses_per_op,llc_misses_per_op,branch_misses_per_op,dtlb_misses_per_op,"
+    "page_faults_per_op";
+void writePerfColumns(std::ostream& out, const PerfSample& s, long long ops);
@@ -0,0 +1,81 @@
+#pragma once
+#include "CacheBase.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Распределение задержки имитируемого бэкенда
+enum class BackendLatency { Fixed, Exponential, LogNormal };
+
+struct BackendSpec {
+    BackendLatency dist = BackendLatency::Fixed;
+    double mean_us = 100.0;      // среднее (для всех распределений)
+    double sigma = 1.0;          // для LogNormal: разброс логарифма
+    bool sleep = false;          // спать (потоки перекрываются) или крутиться (точнее на малых задержках)
+    uint64_t seed = 42;
+};
+
+// Бэкенд внутри процесса: load(key) выдерживает задержку из BackendSpec и
+// возвращает key * 10 (как значения харнесса). Потокобезопасен; задержки
+// берутся из счётчика вызовов через mix64, так что их последовательность
+// от числа потоков не зависит.
+class SimulatedBackend {
+public:
+    explicit SimulatedBackend(const BackendSpec& spec) : spec_(spec) {}
+    int load(int key);
+    // Следующая задержка из распределения, нс (без ожидания)
+    long long sampleNs();
+    long long loads() const { return loads_.load(std::memory_order_relaxed); }
+    // Суммарная фактически выдержанная задержка
+    long long busyNs() const { return busy_ns_.load(std::memory_order_relaxed); }
+    double meanLatencyNs() const { return loads() ? (double)busyNs() / loads() : 0.0; }
+    const BackendSpec& spec() const { return spec_; }
+private:
+    BackendSpec spec_;
+    std::atomic<uint64_t> calls_{0};
+    std::atomic<long long> loads_{0};
+    std::atomic<long long> busy_ns_{0};
+};
+
+struct ReadThroughStats {
+    long long hits = 0;          // значение нашлось в кэше
+    long long loads = 0;         // вызовы загрузчика
+    long long coalesced = 0;     // промахи, дождавшиеся чужой загрузки того же ключа
+};
+
+// Read-through поверх любого ICache: get(key) при промахе зовёт загрузчик и кладёт
+// значение в кэш. Одновременные промахи по одному ключу склеиваются (single-flight):
+// грузит первый поток, остальные ждут его результат, а исключение загрузчика
+// получают все ждавшие. Из нескольких потоков кэш под ним должен быть
+// потокобезопасным (ShardedCache, ClockCache). single_flight = false — наивный
+// вариант «get, при промахе load + put» для сравнения.
+class ReadThroughCache {
+public:
+    using Loader = std::function<int(int key)>;
+    ReadThroughCache(ICache& cache, Loader loader, bool single_flight = true);
+    int get(int key);
+    void put(int key, int value) { cache_.put(key, value); }
+    bool erase(int key) { return cache_.erase(key); }
+    ICache& cache() { return cache_; }
+    ReadThroughStats stats() const;
+private:
+    struct Flight {
+        std::mutex mu;
+        std::condition_variable cv;
+        bool done = false;
+        int value = 0;
+        std::exception_ptr error;
+    };
+    ICache& cache_;
+    Loader loader_;
+    bool single_flight_;
+    std::mutex mu_;                                   // только для flights_
+    std::unordered_map<int, std::shared_ptr<Flight>> flights_;
+    std::atomic<long long> hits_{0}, loads_{0}, coalesced_{0};
+    int loadAndPut(int key);
+};
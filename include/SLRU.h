@@ -0,0 +1,34 @@
+#pragma once
+#include "CacheBase.h"
+#include "FlatIndex.h"
+#include "IndexList.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Сегментированный LRU: новые ключи попадают в probation (20%), повторное
+// обращение переводит в protected (80%). Однократный проход (скан) вымывает
+// только probation, горячие записи в protected не трогает.
+class SLRUCache : public ICache {
+public:
+    explicit SLRUCache(size_t cap, double protectedShare = 0.8);
+    void put(int key, int value) override;
+    std::optional<int> get(int key) override;
+    size_t size() const override { return sz_; }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+private:
+    struct Node { int key, val; uint32_t prev, next; bool prot; };
+    size_t cap_;
+    uint32_t sz_ = 0;
+    uint32_t protectedCap_;
+    TrackedVector<Node> nodes_;
+    TrackedVector<uint32_t> free_;
+    FlatIndex index_;
+    IndexList probation_, protected_;
+    OpCounters cnt_;
+    void onHit(uint32_t i);
+};
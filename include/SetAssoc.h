@@ -0,0 +1,62 @@
+#pragma once
+#include "CacheBase.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Набор инструкций для сравнения тегов
+enum class SimdLevel { Scalar, SSE2, AVX2 };
+SimdLevel detectSimd();                  // лучший доступный на этом процессоре
+const char* simdName(SimdLevel level);
+
+// Замещение внутри набора: дерево псевдо-LRU (W-1 бит) или 8-битные счётчики
+// частоты с делением пополам при насыщении (приближённый LFU)
+enum class SetPolicy { PLRU, LFU };
+
+// Множественно-ассоциативный кэш по образцу процессорного. Ключ хешируется в
+// набор из 8 или 16 путей; ключи набора лежат подряд в выровненной 64-байтной
+// строке (за ними — значения), и поиск — одно-два сравнения SIMD по всем путям
+// сразу. Метаданные набора: маска занятых путей и состояние политики.
+// Наборов ceil(cap / ways); в последнем открыто только остаток путей, так что
+// записей ровно не больше capacity(). Записи не двигаются, память — только в конструкторе.
+class SetAssocCache : public ICache {
+public:
+    SetAssocCache(size_t cap, int ways = 8, SetPolicy policy = SetPolicy::PLRU, SimdLevel simd = detectSimd());
+    void put(int key, int value) override;
+    std::optional<int> get(int key) override;
+    size_t size() const override { return sz_; }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void getMany(const int* keys, size_t n, std::optional<int>* out) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+    int ways() const { return ways_; }
+    SetPolicy policy() const { return policy_; }
+    SimdLevel simd() const { return simd_; }
+private:
+    struct alignas(64) Line { int v[16]; };
+    static constexpr uint8_t kFreqMax = 255;
+    size_t cap_;
+    int ways_;
+    int shift_;                         // log2(ways_)
+    SetPolicy policy_;
+    SimdLevel simd_;
+    uint32_t sets_;
+    uint32_t sz_ = 0;
+    uint32_t lastMask_;                 // открытые пути последнего набора
+    TrackedVector<Line> lines_;         // набор s: ways_/8 строк, сначала ключи, потом значения
+    TrackedVector<uint16_t> valid_;     // занятые пути набора
+    TrackedVector<uint16_t> plru_;      // биты дерева псевдо-LRU
+    TrackedVector<uint8_t> freq_;       // счётчики путей (LFU)
+    OpCounters cnt_;
+
+    uint32_t setOf(int key) const;
+    int* keysOf(uint32_t s) { return lines_[(size_t)s * ways_ / 8].v; }
+    const int* keysOf(uint32_t s) const { return lines_[(size_t)s * ways_ / 8].v; }
+    uint32_t openMask(uint32_t s) const { return s + 1 == sets_ ? lastMask_ : (1u << ways_) - 1; }
+    uint32_t match(uint32_t s, int key) const;
+    void touch(uint32_t s, int w);
+    void onInsert(uint32_t s, int w);
+    int victim(uint32_t s) const;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include "CacheBase.h"
+#include "Stats.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+// Потокобезопасная обёртка: ключи хешируются по N шардам, у каждого шарда
+// свой мьютекс и свой экземпляр любой политики (ёмкость делится поровну).
+// Счётчики ведёт сама обёртка в ShardedStats (по слоту на поток), поэтому
+// counters() не берёт мьютексы шардов и читается на ходу, не тормозя трафик.
+class ShardedCache : public ICache {
+public:
+    using Factory = std::function<std::unique_ptr<ICache>(size_t cap)>;
+    ShardedCache(size_t cap, size_t shards, const Factory& make);
+    void put(int key, int value) override;
+    std::optional<int> get(int key) override;
+    size_t size() const override;
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override;
+    bool erase(int key) override;
+    bool exportEntries(std::vector<SnapshotEntry>& out) const override;
+    void importEntries(const SnapshotEntry* e, size_t n) override;
+    // Слушатель разделяется всеми шардами и должен быть потокобезопасным
+    void setEvictionListener(EvictionListener* l) override;
+    size_t shardCount() const { return n_; }
+private:
+    struct alignas(64) Shard {
+        mutable std::mutex mu;
+        std::unique_ptr<ICache> cache;
+    };
+    size_t cap_, n_;
+    std::unique_ptr<Shard[]> shards_;
+    ShardedStats stats_;
+    mutable OpCounters total_;
+    Shard& shardFor(int key) const;
+    // Вытеснения и истечения, случившиеся внутри операции шарда (вызывать под его мьютексом)
+    void addEvictions(const OpCounters& before, const OpCounters& after);
+};
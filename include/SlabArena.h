@@ -0,0 +1,65 @@
+#pragma once
+#include "IndexList.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Slab-аллокатор в духе memcached: вся память — один блок из страниц
+// фиксированного размера, выделенный в конструкторе. Страница отдаётся
+// одному классу размеров (64 Б … maxChunk, шаг ×1.25) и режется на равные куски.
+// Пустая страница возвращается в общий пул и может перейти к другому классу,
+// поэтому фрагментация ограничена объёмом арены.
+class SlabArena {
+public:
+    using Handle = uint32_t;
+    static constexpr Handle kNone = UINT32_MAX;
+    static constexpr uint32_t kMinChunk = 64;
+
+    SlabArena(size_t bytes, uint32_t pageSize, uint32_t maxChunk);
+
+    // kNone — в классе нет свободного куска и свободных страниц нет
+    Handle alloc(uint32_t bytes);
+    void free(Handle h, uint32_t bytes);
+    char* data(Handle h) { return mem_.get() + (size_t)(h >> kChunkBits) * pageSize_ + chunkOffset(h); }
+
+    uint32_t classOf(uint32_t bytes) const;
+    uint32_t chunkSize(uint32_t bytes) const { return classes_[classOf(bytes)]; }
+    uint32_t classSize(uint32_t cls) const { return classes_[cls]; }
+    uint32_t maxChunk() const { return classes_.back(); }
+    size_t classCount() const { return classes_.size(); }
+
+    // Статистика: запрошено, занято кусками, занято страницами, всего
+    size_t requestedBytes() const { return requested_; }
+    size_t chunkBytes() const { return chunkBytes_; }
+    size_t reservedBytes() const { return (pages_.size() - freePages_.size()) * (size_t)pageSize_; }
+    size_t capacityBytes() const { return pages_.size() * (size_t)pageSize_; }
+    // Внутренняя: округление до куска; внешняя: свободные куски в занятых страницах (%)
+    double internalFragmentation() const;
+    double externalFragmentation() const;
+    size_t bytes() const;
+
+private:
+    static constexpr uint32_t kChunkBits = 16;
+    struct Page {
+        uint32_t prev, next;     // в списке страниц класса со свободными кусками
+        uint32_t cls;
+        uint32_t used = 0;
+        uint32_t chunks = 0;
+        uint32_t bump = 0;       // куски с номером >= bump ещё ни разу не выдавались
+        uint32_t freeHead = IndexList::kNil;
+    };
+    uint32_t pageSize_;
+    TrackedBuffer mem_;
+    TrackedVector<Page> pages_;
+    TrackedVector<uint32_t> freePages_;
+    TrackedVector<uint32_t> classes_;          // размер куска по номеру класса
+    TrackedVector<IndexList> partial_;         // по классу: страницы со свободными кусками
+    size_t requested_ = 0;
+    size_t chunkBytes_ = 0;
+
+    size_t chunkOffset(Handle h) const {
+        return (size_t)(h & ((1u << kChunkBits) - 1)) * classes_[pages_[h >> kChunkBits].cls];
+    }
+};
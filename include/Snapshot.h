@@ -0,0 +1,26 @@
+#pragma once
+#include "CacheBase.h"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Снимок содержимого кэша для тёплого рестарта.
+//
+// Заголовок (24 байта): магия "CSNAP1\0\0", uint32 размер записи, uint32 reserved,
+// uint64 число записей. Дальше записи SnapshotEntry подряд (key, val, freq по 4 байта)
+// в порядке ICache::exportEntries — от первого кандидата на вытеснение к самой ценной.
+// Записи фиксированной длины: восстановление читает отображённый файл как массив
+// и отдаёт его в importEntries целиком, без разбора и поштучных put.
+namespace snapshot {
+constexpr char kMagic[8] = {'C', 'S', 'N', 'A', 'P', '1', '\0', '\0'};
+constexpr size_t kHeaderBytes = 24;
+}
+static_assert(sizeof(SnapshotEntry) == 12, "формат снимка — три 32-битных поля");
+
+// Записать снимок. Число записей или -1 (движок без снимков, ошибка записи).
+long long saveSnapshot(const ICache& cache, const std::string& path);
+
+// Восстановить снимок в пустой кэш. Если записей больше capacity(), остаются
+// последние (самые ценные). Число восстановленных записей или -1 (кэш не пуст,
+// файл не открылся, неверный заголовок или длина).
+long long loadSnapshot(ICache& cache, const std::string& path);
@@ -0,0 +1,81 @@
+#pragma once
+#include "CacheBase.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Разность счётчиков «сейчас − раньше» (окно прогона, интервал опроса)
+OpCounters delta(const OpCounters& now, const OpCounters& prev);
+// Доля попаданий среди get, %; 0, если get не было
+inline double hitRate(const OpCounters& c) {
+    return (c.hits + c.misses) ? (double)c.hits / (c.hits + c.misses) * 100.0 : 0.0;
+}
+// Операций (get + put) в секунду за интервал elapsed_ns
+inline double opsPerSec(const OpCounters& d, long long elapsed_ns) {
+    return elapsed_ns ? (double)(d.gets + d.puts) / (elapsed_ns / 1e9) : 0.0;
+}
+
+enum class StatField { Hits, Misses, Puts, Evictions, Expired };
+constexpr int kStatFields = 5;
+
+// Как поток находит свой слот: по номеру потока (thread_local, назначается
+// один раз) или по текущему ядру (sched_getcpu на каждое обращение)
+enum class StatSlotBy { Thread, Cpu };
+
+// Счётчики операций для кэшей, в которые пишут несколько потоков. Вместо одного
+// набора атомиков, чья кэш-линия ездит между ядрами, у каждого потока свой слот
+// на отдельной кэш-линии.
+//
+// StatSlotBy::Thread: живым потокам раздаются номера 0, 1, 2… (номер завершённого
+// потока переиспользуется). Поток с номером < slots() — единственный писатель своего
+// слота, и add для него — relaxed load + store без lock-префикса. Остальные потоки
+// делят запасной слот через fetch_add. StatSlotBy::Cpu: слот по sched_getcpu, всегда
+// fetch_add (поток может переехать на другое ядро посреди инкремента).
+//
+// snapshot() складывает слоты без блокировок и не останавливает пишущих.
+// gets не хранится, а выводится как hits + misses, поэтому hit rate в снимке
+// всегда согласован; каждое поле не убывает между снимками. Операции, которые
+// идут в момент снимка, попадают в него частично (не больше одной на поток).
+class ShardedStats {
+public:
+    static constexpr size_t kDefaultSlots = 64;
+    explicit ShardedStats(size_t slots = kDefaultSlots, StatSlotBy by = StatSlotBy::Thread);
+    ShardedStats(const ShardedStats&) = delete;
+    ShardedStats& operator=(const ShardedStats&) = delete;
+
+    void add(StatField f, long long n = 1) {
+        if (by_ == StatSlotBy::Thread) {
+            uint32_t t = threadIndex();
+            if (t < n_) {
+                auto& v = slots_[t].v[(int)f];
+                v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+                return;
+            }
+            slots_[n_].v[(int)f].fetch_add(n, std::memory_order_relaxed);
+            return;
+        }
+        cpuSlot().v[(int)f].fetch_add(n, std::memory_order_relaxed);
+    }
+    OpCounters snapshot() const;
+    size_t slots() const { return n_; }
+    StatSlotBy slotBy() const { return by_; }
+
+    // Номер вызывающего потока среди живых: 0, 1, 2… (свободные номера переиспользуются).
+    // thread_local с константной инициализацией — без проверки guard на каждом вызове.
+    static uint32_t threadIndex() {
+        if (tid_ == UINT32_MAX) tid_ = acquireThreadIndex();
+        return tid_;
+    }
+private:
+    struct alignas(64) Slot {
+        std::atomic<long long> v[kStatFields] = {};
+    };
+    std::unique_ptr<Slot[]> slots_;     // n_ личных слотов и запасной слот n_
+    uint32_t n_;
+    StatSlotBy by_;
+    static inline thread_local uint32_t tid_ = UINT32_MAX;
+
+    static uint32_t acquireThreadIndex();
+    Slot& cpuSlot();
+};
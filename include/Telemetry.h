@@ -0,0 +1,165 @@
+#pragma once
+#include "CacheBase.h"
+#include "LatencyHistogram.h"
+#include "Stats.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Запись одного окна прогона (64 байта, фиксированный формат и для бинарного файла).
+// Счётчики — приращения за окно; задержка — по выборке каждой kTelemetrySampleEvery-й
+// операции, в тиках latencyTicks (в наносекунды переводит поток-сборщик).
+struct WindowRecord {
+    uint64_t window = 0;          // номер окна с 0
+    uint64_t end_op = 0;          // операций прогона к концу окна
+    uint64_t hits = 0, misses = 0, puts = 0, evictions = 0;
+    uint64_t elapsed_ns = 0;      // длительность окна по steady_clock
+    uint32_t p50_ticks = 0, max_ticks = 0;
+};
+static_assert(sizeof(WindowRecord) == 64, "запись телеметрии — одна кэш-линия");
+
+// rdtsc в виртуальной машине стоит ~20 нс, так что замеряется одна операция из 1024
+constexpr int kTelemetrySampleEvery = 1024;
+
+// Кольцо «один писатель — один читатель» без блокировок. Ёмкость округляется
+// до степени двойки; индексы растут монотонно, позиция — индекс & mask_.
+// Писатель и читатель держат у себя копию чужого индекса и перечитывают
+// атомик, только когда по копии кольцо полно (пусто), так что в обычном
+// случае push/pop не трогают чужую кэш-линию.
+template <class T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        buf_.resize(n);
+        mask_ = n - 1;
+    }
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Только поток-писатель. false — кольцо полно, запись не принята.
+    bool push(const T& v) {
+        uint64_t h = head_.load(std::memory_order_relaxed);
+        if (h - tailCache_ > mask_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (h - tailCache_ > mask_) return false;
+        }
+        buf_[h & mask_] = v;
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    // Только поток-читатель. false — кольцо пусто.
+    bool pop(T& v) {
+        uint64_t t = tail_.load(std::memory_order_relaxed);
+        if (t == headCache_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (t == headCache_) return false;
+        }
+        v = buf_[t & mask_];
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+    size_t capacity() const { return buf_.size(); }
+private:
+    std::vector<T> buf_;
+    uint64_t mask_ = 0;
+    alignas(64) std::atomic<uint64_t> head_{0};   // пишет писатель
+    uint64_t tailCache_ = 0;                      // копия tail_ у писателя
+    alignas(64) std::atomic<uint64_t> tail_{0};   // пишет читатель
+    uint64_t headCache_ = 0;                      // копия head_ у читателя
+};
+
+enum class TelemetryFormat { Csv, Binary };
+
+// Потоковый вывод окон: горячий цикл кладёт записи в SpscRing и не ждёт,
+// фоновый поток раз в poll_ms забирает всё накопившееся, пишет в файл и
+// сбрасывает буфер — за длинным прогоном можно следить через tail -f.
+// Переполнение кольца не тормозит прогон: запись отбрасывается и считается в dropped().
+//
+// CSV: label, window, end_op, hits, misses, puts, evictions, hit_rate, avg_ns, p50_ns, max_ns.
+// Бинарный: магия "CTELEM1\0", uint32 размер записи, uint32 длина метки, метка,
+// дальше записи WindowRecord подряд (задержки — в тиках, ns_per_tick пишется после метки).
+class TelemetryStream {
+public:
+    TelemetryStream(const std::string& path, TelemetryFormat format, std::string label,
+                    size_t ring_capacity = 4096, int poll_ms = 50);
+    ~TelemetryStream();
+    TelemetryStream(const TelemetryStream&) = delete;
+    TelemetryStream& operator=(const TelemetryStream&) = delete;
+
+    bool ok() const { return file_ != nullptr; }
+    // Только из одного (измеряемого) потока
+    bool publish(const WindowRecord& r) {
+        if (ring_.push(r)) return true;
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // Дописать остаток кольца и остановить поток-сборщик (повторный вызов — no-op)
+    void stop();
+    long long written() const { return written_.load(std::memory_order_relaxed); }
+    long long dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    // Процессорное время потока-сборщика за всю жизнь (известно после stop())
+    long long drainCpuNs() const { return drain_cpu_ns_.load(std::memory_order_relaxed); }
+private:
+    SpscRing<WindowRecord> ring_;
+    std::FILE* file_ = nullptr;
+    TelemetryFormat format_;
+    std::string label_;
+    int poll_ms_;
+    double ns_per_tick_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::atomic<long long> written_{0}, dropped_{0}, drain_cpu_ns_{0};
+    std::thread drainer_;
+
+    void drainLoop();
+    bool drainOnce();
+    void write(const WindowRecord& r);
+};
+
+// Сторона горячего цикла: выборки задержки (цикл сам решает, какие операции
+// замерять, — обычно каждую kTelemetrySampleEvery-ю) и сборка записи на конце окна.
+// Выборок на окно — не больше kMaxSamples, медиана считается один раз на окно.
+class WindowProbe {
+public:
+    static constexpr int kMaxSamples = 64;
+    explicit WindowProbe(TelemetryStream& s) : stream_(s), t0_(std::chrono::steady_clock::now()) {}
+    void sample(uint64_t ticks) { if (n_ < kMaxSamples) samples_[n_++] = (uint32_t)std::min<uint64_t>(ticks, UINT32_MAX); }
+    void closeWindow(const OpCounters& c, uint64_t end_op) {
+        auto now = std::chrono::steady_clock::now();
+        OpCounters d = delta(c, last_);
+        WindowRecord r;
+        r.window = window_++;
+        r.end_op = end_op;
+        r.hits = d.hits;
+        r.misses = d.misses;
+        r.puts = d.puts;
+        r.evictions = d.evictions;
+        r.elapsed_ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now - t0_).count();
+        if (n_) {
+            std::nth_element(samples_, samples_ + n_ / 2, samples_ + n_);
+            r.p50_ticks = samples_[n_ / 2];
+            r.max_ticks = *std::max_element(samples_, samples_ + n_);
+        }
+        stream_.publish(r);
+        last_ = c;
+        t0_ = now;
+        n_ = 0;
+    }
+private:
+    TelemetryStream& stream_;
+    std::chrono::steady_clock::time_point t0_;
+    OpCounters last_;
+    uint64_t window_ = 0;
+    int n_ = 0;
+    uint32_t samples_[kMaxSamples];
+};
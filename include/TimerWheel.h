@@ -0,0 +1,79 @@
+#pragma once
+#include "TrackingAllocator.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Иерархическое колесо таймеров (4 уровня по 64 слота, как в ядре Linux/Kafka)
+// над номерами слотов кэша. Время — логические тики, которые задаёт владелец.
+// Таймер с дедлайном дальше 64 тиков лежит на старшем уровне и при повороте
+// младшего колеса «ссыпается» ниже, поэтому каждый таймер переносится не больше
+// 3 раз: schedule/cancel — O(1), advance — O(1) амортизированно на таймер.
+// Пустые слоты пропускаются по битовой маске занятости, без прохода по тикам.
+class TimerWheel {
+public:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    explicit TimerWheel(size_t n);
+
+    // Таймер слота i сработает на тике when (when > now()); старый снимается
+    void schedule(uint32_t i, uint64_t when);
+    void cancel(uint32_t i) { if (timers_[i].bucket != kNone) unlink(i); }
+    bool scheduled(uint32_t i) const { return timers_[i].bucket != kNone; }
+    uint64_t now() const { return now_; }
+    size_t pending() const { return count_; }
+    size_t bytes() const { return timers_.capacity() * sizeof(Timer) + sizeof(heads_); }
+
+    // Продвигает время до to и вызывает onExpire(i) для всех сработавших таймеров.
+    // К моменту вызова таймер уже снят, onExpire может сразу переиспользовать слот.
+    template <class F>
+    void advance(uint64_t to, F&& onExpire) {
+        while (now_ < to) {
+            if (count_ == 0) { now_ = to; break; }
+            uint64_t t = now_ + 1;
+            if (t & kMask) {
+                // Внутри оборота младшего колеса — сразу к ближайшему занятому слоту
+                uint64_t rest = occupied_[0] >> (t & kMask);
+                if (rest == 0) { now_ = std::min<uint64_t>(to, t | kMask); continue; }
+                t += (uint64_t)__builtin_ctzll(rest);
+                if (t > to) { now_ = to; break; }
+            }
+            now_ = t;
+            if ((now_ & kMask) == 0) {
+                for (int level = 1; level < kLevels; ++level) {
+                    uint32_t slot = (uint32_t)(now_ >> (kBits * level)) & kMask;
+                    cascade(level, slot);
+                    if (slot != 0) break;
+                }
+            }
+            uint32_t b = (uint32_t)(now_ & kMask);
+            while (heads_[b] != kNone) {
+                uint32_t i = heads_[b];
+                unlink(i);
+                onExpire(i);
+            }
+        }
+    }
+
+private:
+    static constexpr int kBits = 6;
+    static constexpr int kLevels = 4;
+    static constexpr uint32_t kSlots = 1u << kBits;
+    static constexpr uint32_t kMask = kSlots - 1;
+
+    struct Timer {
+        uint64_t when;
+        uint32_t prev, next;
+        uint32_t bucket = kNone;     // номер списка level * kSlots + slot
+    };
+    TrackedVector<Timer> timers_;
+    uint32_t heads_[kLevels * kSlots];
+    uint64_t occupied_[kLevels] = {};
+    uint64_t now_ = 0;
+    size_t count_ = 0;
+
+    void place(uint32_t i);
+    void unlink(uint32_t i);
+    void cascade(int level, uint32_t slot);
+};
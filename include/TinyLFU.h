@@ -0,0 +1,45 @@
+#pragma once
+#include "CacheBase.h"
+#include "FlatIndex.h"
+#include "FrequencySketch.h"
+#include "IndexList.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// W-TinyLFU: маленькое окно LRU (~1% ёмкости) + сегментированный LRU
+// (probation 20% / protected 80%). Кандидат, вытесненный из окна, попадает
+// в основную область, только если по FrequencySketch он «популярнее» жертвы
+// из probation — так одноразовые ключи не вымывают тёплые записи.
+class TinyLFUCache : public ICache {
+public:
+    explicit TinyLFUCache(size_t cap);
+    void put(int key, int value) override;
+    std::optional<int> get(int key) override;
+    size_t size() const override { return sz_; }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+    long long rejected() const { return rejected_; }
+private:
+    enum Segment : uint8_t { Window, Probation, Protected };
+    struct Node { int key, val; uint32_t prev, next; Segment seg; };
+    size_t cap_;
+    uint32_t sz_ = 0;
+    uint32_t windowCap_, mainCap_, protectedCap_;
+    TrackedVector<Node> nodes_;
+    TrackedVector<uint32_t> free_;
+    FlatIndex index_;
+    FrequencySketch sketch_;
+    IndexList window_, probation_, protected_;
+    OpCounters cnt_;
+    long long rejected_ = 0;     // кандидаты, не прошедшие фильтр допуска
+
+    IndexList& listOf(Segment s);
+    void onHit(uint32_t i);
+    uint32_t allocSlot();
+    void evict(uint32_t i);
+    void admitFromWindow();
+};
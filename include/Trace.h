@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Компактный бинарный формат трасс обращений.
+//
+// Заголовок (24 байта): магия "CTRACE1\0", uint32 flags, uint32 reserved,
+// uint64 число записей. Дальше записи подряд, все поля — LEB128-варинты:
+//   zigzag(key - prev_key) << 1 | op     — ключ дельтой от предыдущего, op: 0 get, 1 put
+//   size                                  — если flags & kHasSize
+//   timestamp - prev_timestamp            — если flags & kHasTime (время не убывает)
+// Соседние ключи реальных трасс обычно близки, так что запись занимает 1–3 байта.
+struct TraceRecord {
+    int key = 0;
+    uint8_t op = 0;            // TraceOp
+    uint32_t size = 0;
+    uint64_t timestamp = 0;
+};
+
+enum TraceOp : uint8_t { kTraceGet = 0, kTracePut = 1 };
+
+namespace trace {
+constexpr char kMagic[8] = {'C', 'T', 'R', 'A', 'C', 'E', '1', '\0'};
+constexpr uint32_t kHasSize = 1u << 0;
+constexpr uint32_t kHasTime = 1u << 1;
+constexpr size_t kHeaderBytes = 24;
+
+inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+inline uint8_t* putVarint(uint8_t* p, uint64_t v) {
+    while (v >= 0x80) { *p++ = (uint8_t)(v | 0x80); v >>= 7; }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+// nullptr — запись обрезана (дошли до end посреди варинта)
+inline const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return p;
+    }
+    return nullptr;
+}
+} // namespace trace
+
+// Запись трассы с буферизацией; число записей дописывается в заголовок в close().
+class TraceWriter {
+public:
+    TraceWriter() = default;
+    ~TraceWriter() { close(); }
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool open(const std::string& path, uint32_t flags = 0);
+    void append(const TraceRecord& r);
+    bool close();
+    uint64_t records() const { return count_; }
+
+private:
+    FILE* f_ = nullptr;
+    uint32_t flags_ = 0;
+    uint64_t count_ = 0;
+    int prevKey_ = 0;
+    uint64_t prevTime_ = 0;
+    std::vector<uint8_t> buf_;
+    size_t used_ = 0;
+    void flush();
+};
+
+// Файл, отображённый в память только для чтения. Чтение предполагается
+// последовательным: MADV_SEQUENTIAL при открытии, дальше prefetch/release окнами.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    // MADV_WILLNEED: попросить ядро заранее подтянуть [offset, offset+len)
+    void prefetch(size_t offset, size_t len) const;
+    // MADV_DONTNEED: пройденные страницы больше не нужны (RSS не растёт с трассой)
+    void release(size_t offset, size_t len) const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Потоковый декодер трассы поверх MappedFile: next() разбирает очередной кусок
+// записей в буфер вызывающего и заранее подтягивает следующее окно файла.
+class TraceReader {
+public:
+    static constexpr size_t kWindow = 4u << 20;   // окно readahead/release
+
+    explicit TraceReader(const MappedFile& file);
+    bool valid() const { return valid_; }
+    uint32_t flags() const { return flags_; }
+    uint64_t records() const { return total_; }
+    // Сколько записей положено в out (0 — трасса кончилась или обрезана)
+    size_t next(TraceRecord* out, size_t max);
+
+private:
+    const MappedFile& file_;
+    bool valid_ = false;
+    uint32_t flags_ = 0;
+    uint64_t total_ = 0;
+    uint64_t done_ = 0;
+    size_t pos_ = 0;
+    size_t prefetched_ = 0;       // граница уже запрошенного readahead
+    size_t released_ = 0;         // граница уже отпущенных страниц
+    int prevKey_ = 0;
+    uint64_t prevTime_ = 0;
+};
+
+// Текст/CSV -> бинарная трасса. Строка: "key" или "op,key[,size[,timestamp]]",
+// op — get/put (или g/p, 0/1); пустые строки, '#'-комментарии и заголовок пропускаются.
+// Возвращает число записей или -1 при ошибке открытия файлов.
+long long convertTextTrace(const std::string& in_path, const std::string& out_path);
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Учёт памяти движков: все контейнеры кэшей выделяют через TrackingAllocator,
+// который считает вызовы, запрошенные байты и фактические (malloc_usable_size).
+// Счётчики глобальные, но разложены по слотам потоков (как ShardedStats), так что
+// выделение в замеряемом цикле не делает атомарных RMW на общей кэш-линии; снимок
+// складывает слоты. Харнесс снимает снимок до и после прогона и берёт разность.
+// Служебные вещи харнесса (нагрузки, CSV) идут мимо.
+struct AllocStats {
+    long long allocs = 0;           // вызовов выделения всего
+    long long frees = 0;
+    long long requested = 0;        // запрошено байт всего
+    long long usable = 0;           // выдано байт всего (с округлением malloc)
+    long long live_requested = 0;   // сейчас занято: запрошено
+    long long live_usable = 0;      // сейчас занято: фактически
+};
+
+AllocStats allocSnapshot();
+
+// Разность счётчиков: «что произошло между снимками»
+AllocStats allocDelta(const AllocStats& before, const AllocStats& after);
+
+void* trackedAlloc(size_t bytes, size_t align);
+void trackedFree(void* p, size_t bytes);
+
+// Резидентная память процесса (RSS) по /proc/self/statm; 0, если недоступно
+size_t residentBytes();
+
+// Вернуть ОС свободные страницы кучи (malloc_trim): без этого рост RSS между
+// снимками прячется в страницах, оставшихся резидентными от прошлых прогонов
+void releaseFreeHeap();
+
+template <class T>
+struct TrackingAllocator {
+    using value_type = T;
+    TrackingAllocator() noexcept = default;
+    template <class U> TrackingAllocator(const TrackingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(trackedAlloc(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, size_t n) noexcept { trackedFree(p, n * sizeof(T)); }
+
+    template <class U> bool operator==(const TrackingAllocator<U>&) const noexcept { return true; }
+    template <class U> bool operator!=(const TrackingAllocator<U>&) const noexcept { return false; }
+};
+
+template <class T>
+using TrackedVector = std::vector<T, TrackingAllocator<T>>;
+
+template <class T>
+using TrackedList = std::list<T, TrackingAllocator<T>>;
+
+template <class K, class V, class Hash = std::hash<K>>
+using TrackedHashMap = std::unordered_map<K, V, Hash, std::equal_to<K>, TrackingAllocator<std::pair<const K, V>>>;
+
+// Неинициализированный буфер (страницы не трогаются до первой записи)
+struct TrackedBufferDeleter {
+    size_t bytes = 0;
+    void operator()(char* p) const { trackedFree(p, bytes); }
+};
+using TrackedBuffer = std::unique_ptr<char[], TrackedBufferDeleter>;
+
+inline TrackedBuffer makeTrackedBuffer(size_t bytes) {
+    return TrackedBuffer(static_cast<char*>(trackedAlloc(bytes, alignof(std::max_align_t))), TrackedBufferDeleter{bytes});
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "CacheBase.h"
+#include "FlatIndex.h"
+#include "IndexList.h"
+#include "TrackingAllocator.h"
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// 2Q (Johnson & Shasha, полный вариант): новые ключи идут в FIFO A1in (25%),
+// вытесненные из него оставляют «призрак» ключа в A1out (50% ёмкости, без значения).
+// В основной LRU Am попадает только ключ, вернувшийся, пока его призрак жив, —
+// поэтому скан проходит через A1in и не задевает Am.
+class TwoQCache : public ICache {
+public:
+    explicit TwoQCache(size_t cap);
+    void put(int key, int value) override;
+    std::optional<int> get(int key) override;
+    size_t size() const override { return sz_; }
+    size_t capacity() const override { return cap_; }
+    const OpCounters& counters() const override { return cnt_; }
+    bool erase(int key) override;
+    void estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const;
+private:
+    enum Queue : uint8_t { A1in, A1out, Am };
+    struct Node { int key, val; uint32_t prev, next; Queue q; };
+    size_t cap_;
+    uint32_t sz_ = 0;
+    uint32_t kin_, kout_;
+    TrackedVector<Node> nodes_;       // cap_ резидентных + kout_ призраков
+    TrackedVector<uint32_t> free_;
+    FlatIndex index_;
+    IndexList a1in_, a1out_, am_;
+    OpCounters cnt_;
+    IndexList& queueOf(Queue q);
+    void reclaim();
+    void dropNode(uint32_t i);
+};
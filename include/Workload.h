@@ -0,0 +1,114 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Поток обращений к кэшу. Тип операции — из writes (1 — put), а если он пуст,
+// по старому правилу: key % 10 >= 7 — put, иначе get.
+//
+// При дрейфе (drift_period > 0) метки hot относятся к ключам до сдвига: на операции i
+// ключ key горячий, если горячий (key − driftShift(i)) mod universe. Так метки следуют
+// за горячим множеством, а не размазываются по всем фазам.
+struct Workload {
+    std::vector<int> ops;
+    std::vector<uint8_t> writes;
+    std::vector<uint8_t> hot;       // истинная «горячесть» ключей [0, universe); пусто — key < hot_limit
+    int universe = 0;
+    int hot_limit = 0;
+    long long drift_period = 0;     // как в WorkloadSpec; 0 — метки не зависят от времени
+    int drift_step = 0;
+
+    bool isWrite(size_t i) const { return writes.empty() ? ops[i] % 10 >= 7 : writes[i] != 0; }
+};
+
+// Сдвиг горячего множества на операции op, по модулю universe (как в generateWorkload)
+inline int driftShift(long long op, long long period, int step, int universe) {
+    if (period <= 0 || universe <= 0) return 0;
+    return (int)((op / period % universe) * (step % universe) % universe);
+}
+
+// «Оракул» для определения горячих ключей: метки нагрузки, если они есть,
+// иначе — первые hot_limit ключей (как в makeWorkload). op — номер операции
+// нагрузки, во время которой спрашивают (важен только при дрейфе).
+struct HotOracle {
+    int hot_limit = 0;
+    const std::vector<uint8_t>* labels = nullptr;
+    long long drift_period = 0;
+    int drift_step = 0;
+
+    static HotOracle of(const Workload& wl) {
+        return HotOracle{wl.hot_limit, wl.hot.empty() ? nullptr : &wl.hot, wl.drift_period, wl.drift_step};
+    }
+    bool drifts() const { return labels && drift_period > 0 && drift_step != 0; }
+    bool isHot(int key, long long op = 0) const {
+        if (labels) {
+            const int u = (int)labels->size();
+            if (key < 0 || key >= u) return false;
+            if (drifts()) key = (key - driftShift(op, drift_period, drift_step, u) + u) % u;
+            return (*labels)[key];
+        }
+        return key >= 0 && key < hot_limit;
+    }
+};
+
+// Нагрузка с локальностью доступа
+Workload makeWorkload(int total_ops, int universe, double locality = 0.75);
+
+// Нагрузка со сканами: поверх makeWorkload каждые period операций вставляется
+// последовательный проход по scan_len новым «холодным» ключам за пределами universe
+// (как полный просмотр таблицы или бэкап). Горячее множество при этом не меняется.
+Workload makeScanWorkload(int total_ops, int universe, int scan_len, int period, double locality = 0.75);
+
+// Выборка из дискретного распределения за O(1): метод алиасов (Vose).
+// Таблицы строятся один раз за O(n); на выборку — одно 64-битное случайное число.
+class AliasSampler {
+public:
+    explicit AliasSampler(const std::vector<double>& weights);
+    uint32_t sample(uint64_t r) const {
+        uint32_t col = (uint32_t)(((r >> 32) * n_) >> 32);
+        return (uint32_t)r < threshold_[col] ? col : alias_[col];
+    }
+    size_t size() const { return n_; }
+private:
+    uint64_t n_;
+    std::vector<uint32_t> threshold_;   // вероятность «своего» столбца, в долях 2^32
+    std::vector<uint32_t> alias_;
+};
+
+// Распределение ключей генератора
+enum class KeyDist {
+    HotSet,     // locality обращений — к первым universe/10 ключам, остальное равномерно
+    Zipf,       // ранг r с вероятностью ~ 1/(r+1)^alpha, ключ = ранг
+    Loop        // ключи 0..loop_len-1 по кругу
+};
+
+struct WorkloadSpec {
+    long long ops = 1000000;
+    int universe = 10000;
+    KeyDist dist = KeyDist::Zipf;
+    double zipf_alpha = 0.99;
+    double locality = 0.75;          // для HotSet
+    int loop_len = 0;                // для Loop; 0 — весь universe
+    long long drift_period = 0;      // раз в drift_period операций горячее множество
+    int drift_step = 0;              //   сдвигается на drift_step ключей (0 — без дрейфа)
+    long long scan_period = 0;       // в начале каждого периода scan_period —
+    int scan_len = 0;                //   скан по scan_len новым ключам за пределами universe
+    double write_ratio = -1.0;       // доля put; < 0 — правило key % 10 >= 7
+    double hot_fraction = 0.1;       // метка hot — у top hot_fraction·universe ключей по числу обращений
+    uint64_t seed = 42;
+    int threads = 0;                 // 0 — std::thread::hardware_concurrency()
+};
+
+// Параллельная детерминированная генерация: поток операций режется на блоки
+// фиксированной длины, у каждого блока свой поток случайных чисел от (seed, номер блока),
+// а дрейф и сканы зависят только от номера операции. Результат не зависит от threads.
+Workload generateWorkload(const WorkloadSpec& spec);
+
+// Фазы подряд: операции частей склеиваются, типы операций переносятся явно,
+// метки hot объединяются (у части без меток горячими считаются key < hot_limit).
+// У части с дрейфом в объединение идут её горячие ключи всех фаз: склейка без
+// дрейфа, и её метки для такой части — только верхняя граница горячего множества.
+Workload concatWorkloads(const std::vector<Workload>& parts);
+
+// FNV-1a по операциям и типам — для проверки детерминизма
+uint64_t workloadChecksum(const Workload& wl);
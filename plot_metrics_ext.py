@@ -7,6 +7,9 @@ import csv, os
 from collections import defaultdict
 import matplotlib.pyplot as plt
 
+SERIES = ["LRU-iter","LRU-rec","LRU-flat","LFU-iter","LFU-rec","LFU-pool","CLOCK-lockfree","TinyLFU-window",
+          "ARC-ghost","2Q-full","SLRU-seg"]
+
 def read_csv(path):
     with open(path, newline="") as f:
         r = csv.DictReader(f)
@@ -57,8 +60,8 @@ def main():
         groups[key].append((int(d["size"]), to_float(d,"elapsed_ns")))
     for k in groups: groups[k].sort()
     xs = [s for s,_ in groups["LRU-iter"]]
-    ys = [ [v for _,v in groups.get(name, [])] for name in ["LRU-iter","LRU-rec","LFU-iter","LFU-rec"] ]
-    lineplot(xs, ys, ["LRU-iter","LRU-rec","LFU-iter","LFU-rec"],
+    ys = [ [v for _,v in groups.get(name, [])] for name in SERIES ]
+    lineplot(xs, ys, SERIES,
              "Масштабируемость: Время vs Размер", "Размер кэша", "Время (нс)",
              "scalability_time_ext.png")
 
@@ -69,11 +72,41 @@ def main():
         groups_hr[key].append((int(d["size"]), to_float(d,"hit_rate")))
     for k in groups_hr: groups_hr[k].sort()
     xs2 = [s for s,_ in groups_hr["LRU-iter"]]
-    ys2 = [ [v for _,v in groups_hr.get(name, [])] for name in ["LRU-iter","LRU-rec","LFU-iter","LFU-rec"] ]
-    lineplot(xs2, ys2, ["LRU-iter","LRU-rec","LFU-iter","LFU-rec"],
+    ys2 = [ [v for _,v in groups_hr.get(name, [])] for name in SERIES ]
+    lineplot(xs2, ys2, SERIES,
              "Качество кэширования: Hit Rate vs Размер", "Размер кэша", "Hit Rate (%)",
              "scalability_hit_ext.png")
 
+    # Кривые MRC (один проход) поверх замеров и отдельно — на большом диапазоне ёмкостей
+    try:
+        mrc = read_csv(resolve_path("mrc.csv"))
+        curves = defaultdict(list)
+        for d in mrc:
+            curves[(d["source"], d["method"], d["sample_rate"])].append((int(d["capacity"]), to_float(d, "hit_rate")))
+        for (src, method, _), pts in curves.items():
+            if src == "scal" and method in ("lru-exact", "lfu-irm"):
+                pts.sort()
+                plt.plot([c for c,_ in pts], [h for _,h in pts], linestyle="--", label=f"MRC {method}")
+        plt.legend(fontsize=7)
+        plt.savefig("scalability_hit_ext.png", dpi=150)
+
+        plt.figure(figsize=(9, 5))
+        for (src, method, rate), pts in sorted(curves.items()):
+            if src != "zipf": continue
+            pts.sort()
+            label = method if method != "lru-shards" else f"{method} R={rate}"
+            plt.plot([c for c,_ in pts], [h for _,h in pts], marker=".", label=label)
+        plt.xscale("log")
+        plt.title("Кривая hit rate за один проход (Zipf 0.9, 10M обращений)")
+        plt.xlabel("Ёмкость кэша")
+        plt.ylabel("Hit Rate (%)")
+        plt.grid(True, which="both")
+        plt.legend()
+        plt.tight_layout()
+        plt.savefig("mrc.png", dpi=150)
+    except FileNotFoundError:
+        print("mrc.csv не найден — пропускаю mrc.png")
+
     # Эффективность вытеснений
     labels = [ f'{d["algo"]}-{d["impl"]}' for d in results ]
     values = [ to_float(d,"eviction_efficiency") for d in results ]
@@ -90,33 +123,359 @@ def main():
     values3 = [ to_float(d,"roi") for d in roi ]
     barplot(labels3, values3, "Экономическая эффективность (ROI)", "ROI (условные ед.)", "roi_bar.png")
 
-    # Прогрев кэша
+    # Прогрев кэша: по линии на вариант
     try:
-        with open(resolve_path("warmup.csv"), newline="") as f:
-            import csv as _csv
-            r = _csv.DictReader(f)
-            steps, hr = [], []
-            for row in r:
-                steps.append(int(row["step"]))
-                hr.append(float(row["hit_rate"]))
+        warm = read_csv(resolve_path("warmup.csv"))
+        series = defaultdict(list)
+        for row in warm:
+            key = f'{row["algo"]}-{row["impl"]}' if "algo" in row else "LRU-iter"
+            series[key].append((int(row["step"]), to_float(row, "hit_rate")))
         plt.figure()
-        plt.plot(steps, hr, marker="o")
+        for name in series:
+            pts = sorted(series[name])
+            plt.plot([x for x,_ in pts], [y for _,y in pts], marker="o", markersize=3, label=name)
         plt.title("Прогрев кэша (Hit Rate по окнам)")
         plt.xlabel("Окно (по 1000 операций)")
         plt.ylabel("Hit Rate (%)")
         plt.grid(True)
+        plt.legend()
         plt.tight_layout()
         plt.savefig("warmup_graph.png", dpi=150)
     except FileNotFoundError:
         print("warmup.csv не найден — пропускаю warmup_graph.png")
 
+    # Масштабируемость по потокам
+    try:
+        thr = read_csv(resolve_path("threads_scalability.csv"))
+        groups_t = defaultdict(list)
+        for d in thr:
+            key = f'{d["algo"]}-{d["impl"]} x{d["shards"]}'
+            groups_t[key].append((int(d["threads"]), to_float(d, "ops_per_sec")))
+        plt.figure()
+        for name in sorted(groups_t):
+            pts = sorted(groups_t[name])
+            plt.plot([t for t,_ in pts], [v for _,v in pts], marker="o", label=name)
+        plt.xscale("log", base=2)
+        plt.title("Пропускная способность vs число потоков")
+        plt.xlabel("Потоки")
+        plt.ylabel("ops/sec")
+        plt.grid(True)
+        plt.legend()
+        plt.tight_layout()
+        plt.savefig("threads_scalability.png", dpi=150)
+    except FileNotFoundError:
+        print("threads_scalability.csv не найден — пропускаю threads_scalability.png")
+
+    # Устойчивость к сканам
+    try:
+        sc = read_csv(resolve_path("scan_resistance.csv"))
+        barplot([f'{d["algo"]}-{d["impl"]}' for d in sc], [to_float(d, "hit_rate") for d in sc],
+                "Hit Rate при периодических сканах", "Hit Rate (%)", "scan_resistance.png")
+    except FileNotFoundError:
+        print("scan_resistance.csv не найден — пропускаю scan_resistance.png")
+
+    # Бюджет в байтах: доля попаданий по объектам и по байтам
+    try:
+        sz = read_csv(resolve_path("sized_results.csv"))
+        impls = sorted({d["impl"] for d in sz})
+        budgets = sorted({int(d["byte_budget"]) for d in sz})
+        xs_mb = [b / 2**20 for b in budgets]
+        ys_obj, ys_byte, labels_sz = [], [], []
+        for impl in impls:
+            rows = {int(d["byte_budget"]): d for d in sz if d["impl"] == impl}
+            ys_obj.append([to_float(rows[b], "object_hit_rate") for b in budgets])
+            ys_byte.append([to_float(rows[b], "byte_hit_rate") for b in budgets])
+            labels_sz.append(f"GDS-{impl}")
+        lineplot(xs_mb, ys_obj + ys_byte,
+                 [f"{l} (объекты)" for l in labels_sz] + [f"{l} (байты)" for l in labels_sz],
+                 "GreedyDual-Size: Hit Rate по объектам и по байтам", "Бюджет, МБ", "Hit Rate (%)",
+                 "sized_hit_rate.png")
+    except FileNotFoundError:
+        print("sized_results.csv не найден — пропускаю sized_hit_rate.png")
+
+    # TTL: сколько мест освободили истечения, а сколько — вытеснения
+    try:
+        tt = read_csv(resolve_path("ttl.csv"))
+        labels_t = [f'{d["algo"]}-{d["impl"]} {d["mode"]}' for d in tt]
+        xs_t = range(len(tt))
+        plt.figure()
+        plt.bar([x - 0.2 for x in xs_t], [to_float(d, "expired") for d in tt], width=0.4, label="expired")
+        plt.bar([x + 0.2 for x in xs_t], [to_float(d, "evictions") for d in tt], width=0.4, label="evictions")
+        plt.xticks(list(xs_t), labels_t, rotation=30, ha="right")
+        plt.title("TTL: истечения и вытеснения")
+        plt.legend()
+        plt.tight_layout()
+        plt.savefig("ttl_bar.png", dpi=150)
+    except FileNotFoundError:
+        print("ttl.csv не найден — пропускаю ttl_bar.png")
+
+    # Паттерны нагрузки: hit rate движков по паттернам
+    try:
+        pw = read_csv(resolve_path("workloads.csv"))
+        patterns = list(dict.fromkeys(d["pattern"] for d in pw))
+        engines = list(dict.fromkeys(f'{d["algo"]}-{d["impl"]}' for d in pw))
+        width = 0.8 / max(1, len(engines))
+        plt.figure(figsize=(10, 5))
+        for j, eng in enumerate(engines):
+            rows = {d["pattern"]: d for d in pw if f'{d["algo"]}-{d["impl"]}' == eng}
+            plt.bar([i + j * width for i in range(len(patterns))],
+                    [to_float(rows[p], "hit_rate") if p in rows else 0.0 for p in patterns],
+                    width=width, label=eng)
+        plt.xticks([i + 0.4 - width / 2 for i in range(len(patterns))], patterns)
+        plt.title("Hit Rate по паттернам нагрузки")
+        plt.ylabel("Hit Rate (%)")
+        plt.legend(fontsize=8)
+        plt.tight_layout()
+        plt.savefig("workloads.png", dpi=150)
+    except FileNotFoundError:
+        print("workloads.csv не найден — пропускаю workloads.png")
+
+    # CDF задержки одной операции по движкам
+    try:
+        lh = read_csv(resolve_path("latency_hist.csv"))
+        series_l = defaultdict(list)
+        for d in lh:
+            series_l[f'{d["algo"]}-{d["impl"]}'].append((to_float(d, "high_ns"), to_float(d, "cdf")))
+        plt.figure(figsize=(9, 5))
+        for name in series_l:
+            pts = sorted(series_l[name])
+            plt.step([x for x,_ in pts], [y for _,y in pts], where="post", label=name)
+        plt.xscale("log")
+        plt.title("CDF задержки операции")
+        plt.xlabel("Задержка, нс")
+        plt.ylabel("Доля операций")
+        plt.grid(True, which="both")
+        plt.legend(fontsize=8)
+        plt.tight_layout()
+        plt.savefig("latency_cdf.png", dpi=150)
+    except FileNotFoundError:
+        print("latency_hist.csv не найден — пропускаю latency_cdf.png")
+
+    # Тёплый рестарт: прогрев после восстановления из снимка против холодного старта
+    try:
+        ws = read_csv(resolve_path("warm_restart_series.csv"))
+        series_w = defaultdict(list)
+        for d in ws:
+            series_w[(f'{d["algo"]}-{d["impl"]}', d["start"])].append((int(d["step"]), to_float(d, "hit_rate")))
+        engines_w = list(dict.fromkeys(name for name, _ in series_w))
+        plt.figure(figsize=(9, 5))
+        for idx, name in enumerate(engines_w):
+            color = f"C{idx % 10}"
+            for start, style in (("cold", "--"), ("warm", "-")):
+                pts = sorted(series_w.get((name, start), []))
+                plt.plot([x for x,_ in pts], [y for _,y in pts], style, color=color, label=f"{name} {start}")
+        plt.title("Прогрев: холодный старт (пунктир) и восстановление из снимка")
+        plt.xlabel("Окно (по 1000 операций)")
+        plt.ylabel("Hit Rate (%)")
+        plt.grid(True)
+        plt.legend(fontsize=7, ncol=2)
+        plt.tight_layout()
+        plt.savefig("warm_restart.png", dpi=150)
+    except FileNotFoundError:
+        print("warm_restart_series.csv не найден — пропускаю warm_restart.png")
+
+    # Read-through: число загрузок из бэкенда с склейкой промахов и без
+    try:
+        rm = read_csv(resolve_path("read_through_mt.csv"))
+        plt.figure()
+        for mode in ("naive", "single-flight"):
+            pts = sorted((int(d["threads"]), to_float(d, "loads")) for d in rm if d["mode"] == mode)
+            plt.plot([x for x,_ in pts], [y for _,y in pts], marker="o", label=mode)
+        plt.xscale("log", base=2)
+        plt.title("Read-through: загрузки из бэкенда")
+        plt.xlabel("Потоки")
+        plt.ylabel("loads")
+        plt.grid(True)
+        plt.legend()
+        plt.tight_layout()
+        plt.savefig("read_through_mt.png", dpi=150)
+    except FileNotFoundError:
+        print("read_through_mt.csv не найден — пропускаю read_through_mt.png")
+
+    # Односвязные rec-движки до 1M записей: время операции по размеру
+    try:
+        rs = read_csv(resolve_path("rec_scaling.csv"))
+        series_r = defaultdict(list)
+        for d in rs:
+            series_r[f'{d["algo"]}-{d["impl"]}'].append((int(d["size"]), to_float(d, "avg_ns")))
+        plt.figure(figsize=(9, 5))
+        for name, pts in series_r.items():
+            pts.sort()
+            plt.plot([x for x,_ in pts], [y for _,y in pts], marker="o", label=name)
+        plt.xscale("log")
+        plt.yscale("log")
+        plt.title("Rec-движки: время операции vs размер")
+        plt.xlabel("Размер кэша (записей)")
+        plt.ylabel("avg_ns")
+        plt.grid(True, which="both")
+        plt.legend(fontsize=8)
+        plt.tight_layout()
+        plt.savefig("rec_scaling.png", dpi=150)
+    except FileNotFoundError:
+        print("rec_scaling.csv не найден — пропускаю rec_scaling.png")
+
+    # Множественно-ассоциативный кэш: потеря hit rate и время по наборам инструкций
+    try:
+        sa = read_csv(resolve_path("set_assoc.csv"))
+        fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(12, 5))
+        loss = defaultdict(dict)
+        times = defaultdict(list)
+        refs = defaultdict(dict)
+        for d in sa:
+            name = f'{d["algo"]}-{d["impl"]}'
+            size = int(d["size"])
+            loss[name][size] = to_float(d, "hit_loss_pp")
+            times[f'{name}-{d["simd"]}'].append((size, to_float(d, "avg_ns")))
+            refs[f'{d["algo"]}-{d["ref_impl"]}'][size] = to_float(d, "ref_avg_ns")
+        for name, pts in loss.items():
+            xs = sorted(pts)
+            ax1.plot(xs, [pts[x] for x in xs], marker="o", label=name)
+        for name, pts in list(times.items()) + [(k, list(v.items())) for k, v in refs.items()]:
+            pts = sorted(pts)
+            ax2.plot([x for x,_ in pts], [y for _,y in pts], marker="o", label=name)
+        ax1.set_xscale("log")
+        ax1.set_title("Потеря hit rate против точного алгоритма")
+        ax1.set_xlabel("Размер кэша (записей)")
+        ax1.set_ylabel("hit_loss_pp")
+        ax1.grid(True)
+        ax1.legend(fontsize=8)
+        ax2.set_xscale("log")
+        ax2.set_title("Время операции")
+        ax2.set_xlabel("Размер кэша (записей)")
+        ax2.set_ylabel("avg_ns")
+        ax2.grid(True)
+        ax2.legend(fontsize=6)
+        plt.tight_layout()
+        plt.savefig("set_assoc.png", dpi=150)
+    except FileNotFoundError:
+        print("set_assoc.csv не найден — пропускаю set_assoc.png")
+
+    # Адаптивный LRU/LFU: hit rate по окнам и моменты переключения
+    try:
+        ap = read_csv(resolve_path("adaptive_phases.csv"))
+        series_a = defaultdict(list)
+        for d in ap:
+            series_a[d["algo"]].append((int(d["step"]), to_float(d, "hit_rate")))
+        plt.figure(figsize=(11, 5))
+        for name, pts in series_a.items():
+            pts.sort()
+            plt.plot([x for x,_ in pts], [y for _,y in pts], label=name, linewidth=1)
+        try:
+            for d in read_csv(resolve_path("adaptive_switches.csv")):
+                if d["workload"] != "phases":
+                    continue
+                plt.axvline(int(d["step"]), color="gray", linestyle="--", linewidth=0.8)
+                plt.text(int(d["step"]), 2, d["to"], fontsize=8, rotation=90)
+        except FileNotFoundError:
+            pass
+        plt.title("Адаптивный кэш: hit rate по окнам на смене фаз")
+        plt.xlabel("Окно (1000 операций)")
+        plt.ylabel("Hit Rate (%)")
+        plt.grid(True)
+        plt.legend()
+        plt.tight_layout()
+        plt.savefig("adaptive_phases.png", dpi=150)
+    except FileNotFoundError:
+        print("adaptive_phases.csv не найден — пропускаю adaptive_phases.png")
+
+    # Телеметрия: прирост времени и доля процессора потока-сборщика по приёмникам
+    try:
+        to = read_csv(resolve_path("telemetry_overhead.csv"))
+        fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(12, 5))
+        sinks = []
+        for d in to:
+            if d["sink"] not in sinks:
+                sinks.append(d["sink"])
+        engines = sorted({f'{d["algo"]}-{d["impl"]}' for d in to})
+        width = 0.8 / max(1, len(engines))
+        for j, eng in enumerate(engines):
+            rows = {d["sink"]: d for d in to if f'{d["algo"]}-{d["impl"]}' == eng}
+            xs = [i + j * width for i in range(len(sinks))]
+            ax1.bar(xs, [to_float(rows[s], "overhead_pct") if s in rows else 0 for s in sinks], width, label=eng)
+            ax2.bar(xs, [to_float(rows[s], "drain_cpu_pct") if s in rows else 0 for s in sinks], width, label=eng)
+        for ax, title in ((ax1, "overhead_pct (медиана пар прогонов)"), (ax2, "drain_cpu_pct (поток-сборщик)")):
+            ax.set_xticks([i + width * (len(engines) - 1) / 2 for i in range(len(sinks))])
+            ax.set_xticklabels(sinks)
+            ax.axhline(0, color="black", linewidth=0.8)
+            ax.set_title(title)
+            ax.set_ylabel("%")
+            ax.grid(True, axis="y")
+            ax.legend()
+        plt.tight_layout()
+        plt.savefig("telemetry_overhead.png", dpi=150)
+    except FileNotFoundError:
+        print("telemetry_overhead.csv не найден — пропускаю telemetry_overhead.png")
+
+    # Счётчики операций: цена инкремента по потокам
+    try:
+        scn = read_csv(resolve_path("stats_counters.csv"))
+        groups_s = defaultdict(list)
+        for d in scn:
+            groups_s[d["mode"]].append((int(d["threads"]), to_float(d, "ns_per_op")))
+        plt.figure()
+        for name, pts in groups_s.items():
+            pts.sort()
+            plt.plot([t for t,_ in pts], [v for _,v in pts], marker="o", label=name)
+        plt.xscale("log", base=2)
+        plt.title("Цена счётчика операций vs число потоков")
+        plt.xlabel("Потоки")
+        plt.ylabel("нс на инкремент")
+        plt.grid(True)
+        plt.legend()
+        plt.tight_layout()
+        plt.savefig("stats_counters.png", dpi=150)
+    except FileNotFoundError:
+        print("stats_counters.csv не найден — пропускаю stats_counters.png")
+
+    # Матрица экспериментов (длинный формат): медиана по повторам, первая нагрузка, 1 поток, пакет 1
+    try:
+        mx = read_csv(resolve_path("matrix_results.csv"))
+        first = mx[0]["workload"] if mx else ""
+        cells = defaultdict(list)
+        for d in mx:
+            if d["workload"] != first or d["threads"] != "1" or d["batch"] != "1":
+                continue
+            cells[(d["engine"], int(d["capacity"]), d["metric"])].append(to_float(d, "value"))
+        fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(12, 5))
+        for eng in sorted({e for e, _, _ in cells}):
+            caps = sorted({c for e, c, _ in cells if e == eng})
+            med = lambda m: [sorted(cells[(eng, c, m)])[len(cells[(eng, c, m)]) // 2] for c in caps]
+            ax1.plot(caps, med("ops_per_sec"), marker="o", label=eng)
+            ax2.plot(caps, med("hit_rate"), marker="o", label=eng)
+        for ax, title, ylabel in ((ax1, "Пропускная способность", "ops/sec"), (ax2, "Hit rate", "Hit Rate (%)")):
+            ax.set_xscale("log", base=2)
+            ax.set_title(f"{title} ({first})")
+            ax.set_xlabel("Ёмкость")
+            ax.set_ylabel(ylabel)
+            ax.grid(True)
+            ax.legend(fontsize=8)
+        plt.tight_layout()
+        plt.savefig("matrix.png", dpi=150)
+    except FileNotFoundError:
+        print("matrix_results.csv не найден — пропускаю matrix.png")
+
     print("Сохранены графики:")
     print(" - scalability_time_ext.png")
     print(" - scalability_hit_ext.png")
+    print(" - mrc.png (если был mrc.csv)")
     print(" - eviction_eff_bar.png")
     print(" - efficiency_score.png")
     print(" - roi_bar.png")
     print(" - warmup_graph.png (если был warmup.csv)")
+    print(" - threads_scalability.png (если был threads_scalability.csv)")
+    print(" - scan_resistance.png (если был scan_resistance.csv)")
+    print(" - sized_hit_rate.png (если был sized_results.csv)")
+    print(" - ttl_bar.png (если был ttl.csv)")
+    print(" - workloads.png (если был workloads.csv)")
+    print(" - latency_cdf.png (если был latency_hist.csv)")
+    print(" - rec_scaling.png (если был rec_scaling.csv)")
+    print(" - warm_restart.png (если был warm_restart_series.csv)")
+    print(" - read_through_mt.png (если был read_through_mt.csv)")
+    print(" - set_assoc.png (если был set_assoc.csv)")
+    print(" - adaptive_phases.png (если был adaptive_phases.csv)")
+    print(" - telemetry_overhead.png (если был telemetry_overhead.csv)")
+    print(" - stats_counters.png (если был stats_counters.csv)")
+    print(" - matrix.png (если был matrix_results.csv)")
 
 if __name__ == "__main__":
     main()
@@ -0,0 +1,117 @@
+#include "ARC.h"
+#include <algorithm>
+
+ARCCache::ARCCache(size_t cap)
+    : cap_(cap), nodes_(2 * cap), index_(2 * cap) {
+    free_.reserve(nodes_.size());
+    for (size_t i = nodes_.size(); i > 0; --i) free_.push_back((uint32_t)(i - 1));
+}
+
+IndexList& ARCCache::listOf(List l) {
+    switch (l) {
+        case T1: return t1_;
+        case T2: return t2_;
+        case B1: return b1_;
+        default: return b2_;
+    }
+}
+
+void ARCCache::move(uint32_t i, List to) {
+    listOf(nodes_[i].list).unlink(nodes_, i);
+    nodes_[i].list = to;
+    listOf(to).pushFront(nodes_, i);
+}
+
+void ARCCache::dropGhost(uint32_t i) {
+    listOf(nodes_[i].list).unlink(nodes_, i);
+    index_.erase(nodes_[i].key);
+    free_.push_back(i);
+}
+
+// REPLACE из статьи: хвост T1 или T2 уходит в соответствующий список призраков
+void ARCCache::replace(bool inB2) {
+    bool fromT1 = !t1_.empty()
+        && (t2_.empty() || t1_.size > p_ || (inB2 && t1_.size == p_));
+    uint32_t v = fromT1 ? t1_.tail : t2_.tail;
+    cnt_.evictions++;
+    notifyEvict(nodes_[v].key, nodes_[v].val, EvictReason::Capacity);
+    move(v, fromT1 ? B1 : B2);
+}
+
+std::optional<int> ARCCache::get(int key) {
+    cnt_.gets++;
+    uint32_t i = index_.find(key);
+    // Призрак значения не хранит — для get это обычный промах
+    if (i == FlatIndex::kEmpty || nodes_[i].list == B1 || nodes_[i].list == B2) {
+        cnt_.misses++;
+        return std::nullopt;
+    }
+    move(i, T2);
+    cnt_.hits++;
+    return nodes_[i].val;
+}
+
+void ARCCache::put(int key, int value) {
+    cnt_.puts++;
+    if (cap_ == 0) return;
+    const bool full = t1_.size + t2_.size >= cap_;
+    uint32_t i = index_.find(key);
+    if (i != FlatIndex::kEmpty) {
+        List l = nodes_[i].list;
+        if (l == T1 || l == T2) { nodes_[i].val = value; move(i, T2); return; }
+        // Попадание в призрак: адаптируем p и возвращаем ключ сразу в T2
+        if (l == B1) {
+            size_t d = std::max<size_t>(1, b2_.size / b1_.size);
+            p_ = std::min(cap_, p_ + d);
+        } else {
+            size_t d = std::max<size_t>(1, b1_.size / b2_.size);
+            p_ = p_ > d ? p_ - d : 0;
+        }
+        if (full) replace(l == B2);
+        nodes_[i].val = value;
+        move(i, T2);
+        return;
+    }
+
+    // Новый ключ
+    if (t1_.size + b1_.size >= cap_) {
+        if (t1_.size < cap_) {
+            dropGhost(b1_.tail);
+            if (full) replace(false);
+        } else {
+            uint32_t v = t1_.tail;
+            cnt_.evictions++;
+            notifyEvict(nodes_[v].key, nodes_[v].val, EvictReason::Capacity);
+            dropGhost(v);
+        }
+    } else if (t1_.size + t2_.size + b1_.size + b2_.size >= cap_) {
+        if (t1_.size + t2_.size + b1_.size + b2_.size >= 2 * cap_) dropGhost(b2_.tail);
+        if (full) replace(false);
+    }
+    i = free_.back();
+    free_.pop_back();
+    nodes_[i].key = key;
+    nodes_[i].val = value;
+    nodes_[i].list = T1;
+    t1_.pushFront(nodes_, i);
+    index_.insert(key, i);
+}
+
+bool ARCCache::erase(int key) {
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) return false;
+    List l = nodes_[i].list;
+    int val = nodes_[i].val;
+    dropGhost(i);
+    if (l == B1 || l == B2) return false;
+    notifyEvict(key, val, EvictReason::Erase);
+    return true;
+}
+
+void ARCCache::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    const size_t payload = sizeof(int) * 2;
+    theoretical = cap_ * payload;
+    actual = size() * payload;
+    overhead = nodes_.capacity() * sizeof(Node) + free_.capacity() * sizeof(uint32_t)
+             + index_.bytes() - actual;
+}
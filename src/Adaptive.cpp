@@ -0,0 +1,137 @@
+#include "Adaptive.h"
+#include "FlatIndex.h"
+#include <algorithm>
+
+const char* policyName(AdaptivePolicy p) {
+    return p == AdaptivePolicy::LRU ? "LRU" : "LFU";
+}
+
+namespace {
+double shadowRate(size_t cap, double requested) {
+    if (requested > 0.0) return std::min(1.0, requested);
+    if (cap == 0) return 1.0;
+    return std::min(1.0, std::max(1.0 / 16, (double)AdaptiveCache::kMinShadow / cap));
+}
+}
+
+AdaptiveCache::AdaptiveCache(size_t cap, const AdaptiveSpec& spec)
+    : cap_(cap), spec_(spec), policy_(spec.initial), rate_(shadowRate(cap, spec.sample_rate)),
+      threshold_((uint32_t)(rate_ * (1u << 24))),
+      lruShadow_(std::max<size_t>(1, (size_t)(cap * rate_))),
+      lfuShadow_(std::max<size_t>(1, (size_t)(cap * rate_))) {}
+
+// Обращение к выбранному ключу: обе тени отвечают так, как ответил бы
+// полноразмерный кэш своей политики (промах сразу вставляет ключ)
+void AdaptiveCache::observe(int key) {
+    ops_++;
+    if ((FlatIndex::mix(key) & 0xFFFFFFu) >= threshold_) return;
+    if (lruShadow_.get(key)) lruHits_++; else lruShadow_.put(key, 0);
+    if (lfuShadow_.get(key)) lfuHits_++; else lfuShadow_.put(key, 0);
+    if (++sampled_ >= spec_.window) evaluate();
+}
+
+void AdaptiveCache::evaluate() {
+    double lru = (double)lruHits_ / sampled_ * 100.0;
+    double lfu = (double)lfuHits_ / sampled_ * 100.0;
+    if (!primed_) { lruEst_ = lru; lfuEst_ = lfu; primed_ = true; }
+    else {
+        lruEst_ = spec_.smoothing * lruEst_ + (1.0 - spec_.smoothing) * lru;
+        lfuEst_ = spec_.smoothing * lfuEst_ + (1.0 - spec_.smoothing) * lfu;
+    }
+    sampled_ = 0; lruHits_ = 0; lfuHits_ = 0;
+
+    double cur = shadowHitRate(policy_);
+    AdaptivePolicy other = policy_ == AdaptivePolicy::LRU ? AdaptivePolicy::LFU : AdaptivePolicy::LRU;
+    if (shadowHitRate(other) > cur + spec_.margin_pp) {
+        switches_.push_back({ops_, policy_, other, lruEst_, lfuEst_});
+        policy_ = other;
+    }
+}
+
+void AdaptiveCache::touch(TrackedHashMap<int, Entry>::iterator it) {
+    Entry& e = it->second;
+    order_.splice(order_.begin(), order_, e.rec);
+    auto b = buckets_.find(e.freq);
+    b->second.erase(e.fq);
+    if (b->second.empty()) {
+        buckets_.erase(b);
+        if (minFreq_ == e.freq) minFreq_++;
+    }
+    e.freq++;
+    auto& lst = buckets_[e.freq];
+    lst.push_front(it->first);
+    e.fq = lst.begin();
+}
+
+// Снять ключ с корзины частот; минимальная частота ищется заново, только если
+// опустела её корзина (в режиме LRU жертва не обязательно самая редкая)
+void AdaptiveCache::unlinkFreq(Entry& e) {
+    auto b = buckets_.find(e.freq);
+    b->second.erase(e.fq);
+    if (!b->second.empty()) return;
+    buckets_.erase(b);
+    if (minFreq_ != e.freq) return;
+    minFreq_ = 0;
+    for (const auto& kv : buckets_)
+        if (minFreq_ == 0 || kv.first < minFreq_) minFreq_ = kv.first;
+}
+
+void AdaptiveCache::evictOne() {
+    int key = policy_ == AdaptivePolicy::LRU ? order_.back() : buckets_[minFreq_].back();
+    auto it = pos_.find(key);
+    Entry& e = it->second;
+    int val = e.val;
+    order_.erase(e.rec);
+    unlinkFreq(e);
+    pos_.erase(it);
+    cnt_.evictions++;
+    notifyEvict(key, val, EvictReason::Capacity);
+}
+
+std::optional<int> AdaptiveCache::get(int key) {
+    cnt_.gets++;
+    observe(key);
+    auto it = pos_.find(key);
+    if (it == pos_.end()) { cnt_.misses++; return std::nullopt; }
+    touch(it);
+    cnt_.hits++;
+    return it->second.val;
+}
+
+void AdaptiveCache::put(int key, int value) {
+    cnt_.puts++;
+    if (cap_ == 0) return;
+    observe(key);
+    auto it = pos_.find(key);
+    if (it != pos_.end()) { it->second.val = value; touch(it); return; }
+    if (order_.size() == cap_) evictOne();
+    order_.push_front(key);
+    auto& lst = buckets_[1];
+    lst.push_front(key);
+    pos_.emplace(key, Entry{value, 1, order_.begin(), lst.begin()});
+    minFreq_ = 1;
+}
+
+bool AdaptiveCache::erase(int key) {
+    auto it = pos_.find(key);
+    if (it == pos_.end()) return false;
+    Entry& e = it->second;
+    int val = e.val;
+    order_.erase(e.rec);
+    unlinkFreq(e);
+    pos_.erase(it);
+    notifyEvict(key, val, EvictReason::Erase);
+    return true;
+}
+
+void AdaptiveCache::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    const size_t payload = sizeof(int) * 3;    // key, val, freq
+    theoretical = cap_ * payload;
+    actual = order_.size() * payload;
+    size_t lists = order_.size() * 2 * (sizeof(void*) * 2 + sizeof(int));
+    size_t map = pos_.size() * (sizeof(void*) * 2 + sizeof(int) + sizeof(Entry));
+    size_t t1 = 0, a1 = 0, o1 = 0, t2 = 0, a2 = 0, o2 = 0;
+    lruShadow_.estimateMemory(t1, a1, o1);
+    lfuShadow_.estimateMemory(t2, a2, o2);
+    overhead = lists + map + a1 + o1 + a2 + o2;
+}
@@ -0,0 +1,184 @@
+#include "Clock.h"
+#include "FlatIndex.h"
+#include <algorithm>
+
+namespace {
+inline uint64_t pack(int key, uint32_t slot) {
+    return ((uint64_t)(uint32_t)key << 32) | (uint64_t)(slot + 1);
+}
+inline int keyOf(uint64_t v) { return (int)(uint32_t)(v >> 32); }
+inline uint32_t slotOf(uint64_t v) { return (uint32_t)v - 1; }
+}
+
+ClockCache::ClockCache(size_t cap) : cap_(cap), keys_(cap), vals_(cap), refs_(cap) {
+    free_.reserve(cap);
+    size_t n = 8;
+    while (n < cap * 2) n <<= 1;
+    table_ = TrackedVector<std::atomic<uint64_t>>(n);
+    mask_ = n - 1;
+}
+
+size_t ClockCache::home(int key) const { return FlatIndex::mix(key) & mask_; }
+
+// Поиск по индексу; у читателя без блокировки результат валиден только после проверки seq_
+uint32_t ClockCache::probe(int key) const {
+    size_t i = home(key);
+    for (size_t steps = 0; steps <= mask_; ++steps, i = (i + 1) & mask_) {
+        uint64_t v = table_[i].load(std::memory_order_relaxed);
+        if (v == 0) return kNil;
+        if (keyOf(v) == key) return slotOf(v);
+    }
+    return kNil;
+}
+
+void ClockCache::indexInsert(int key, uint32_t slot) {
+    size_t i = home(key);
+    while (table_[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & mask_;
+    table_[i].store(pack(key, slot), std::memory_order_relaxed);
+}
+
+void ClockCache::indexErase(int key) {
+    size_t i = home(key);
+    while (keyOf(table_[i].load(std::memory_order_relaxed)) != key) i = (i + 1) & mask_;
+    for (size_t j = (i + 1) & mask_;; j = (j + 1) & mask_) {
+        uint64_t v = table_[j].load(std::memory_order_relaxed);
+        if (v == 0) break;
+        size_t h = home(keyOf(v));
+        bool inRange = (i <= j) ? (i < h && h <= j) : (i < h || h <= j);
+        if (inRange) continue;
+        table_[i].store(v, std::memory_order_relaxed);
+        i = j;
+    }
+    table_[i].store(0, std::memory_order_relaxed);
+}
+
+std::optional<int> ClockCache::get(int key) {
+    for (int attempt = 0; attempt < kOptimisticTries; ++attempt) {
+        uint64_t s1 = seq_.load(std::memory_order_acquire);
+        if (s1 & 1) continue;
+        uint32_t slot = probe(key);
+        int val = (slot != kNil) ? vals_[slot].load(std::memory_order_relaxed) : 0;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) != s1) continue;
+        if (slot == kNil) { stats_.add(StatField::Misses); return std::nullopt; }
+        refs_[slot].store(1, std::memory_order_relaxed);
+        stats_.add(StatField::Hits);
+        return val;
+    }
+    // Писатели не дают прочитать согласованно — идём под мьютекс
+    std::lock_guard<std::mutex> lock(mu_);
+    uint32_t slot = probe(key);
+    if (slot == kNil) { stats_.add(StatField::Misses); return std::nullopt; }
+    refs_[slot].store(1, std::memory_order_relaxed);
+    stats_.add(StatField::Hits);
+    return vals_[slot].load(std::memory_order_relaxed);
+}
+
+void ClockCache::put(int key, int value) {
+    stats_.add(StatField::Puts);
+    if (cap_ == 0) return;
+    std::lock_guard<std::mutex> lock(mu_);
+    uint32_t slot = probe(key);
+    if (slot != kNil) {
+        vals_[slot].store(value, std::memory_order_relaxed);
+        refs_[slot].store(1, std::memory_order_relaxed);
+        return;
+    }
+    uint32_t sz = sz_.load(std::memory_order_relaxed);
+    bool evict = (sz == cap_);
+    if (evict) {
+        // Стрелка сбрасывает биты обращения, пока не найдёт слот с нулевым
+        while (refs_[hand_].load(std::memory_order_relaxed)) {
+            refs_[hand_].store(0, std::memory_order_relaxed);
+            hand_ = (hand_ + 1 == cap_) ? 0 : hand_ + 1;
+        }
+        slot = hand_;
+        hand_ = (hand_ + 1 == cap_) ? 0 : hand_ + 1;
+    } else if (!free_.empty()) {
+        slot = free_.back(); free_.pop_back();
+    } else {
+        slot = sz;
+    }
+    int victim = keys_[slot];
+    int victimVal = vals_[slot].load(std::memory_order_relaxed);
+
+    uint64_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    if (evict) indexErase(victim);
+    keys_[slot] = key;
+    vals_[slot].store(value, std::memory_order_relaxed);
+    refs_[slot].store(0, std::memory_order_relaxed);
+    indexInsert(key, slot);
+    seq_.store(s + 2, std::memory_order_release);
+
+    if (evict) {
+        stats_.add(StatField::Evictions);
+        notifyEvict(victim, victimVal, EvictReason::Capacity);
+    } else {
+        sz_.store(sz + 1, std::memory_order_relaxed);
+    }
+}
+
+bool ClockCache::erase(int key) {
+    std::lock_guard<std::mutex> lock(mu_);
+    uint32_t slot = probe(key);
+    if (slot == kNil) return false;
+    int val = vals_[slot].load(std::memory_order_relaxed);
+    uint64_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    indexErase(key);
+    seq_.store(s + 2, std::memory_order_release);
+    refs_[slot].store(0, std::memory_order_relaxed);
+    free_.push_back(slot);
+    sz_.store(sz_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    notifyEvict(key, val, EvictReason::Erase);
+    return true;
+}
+
+const OpCounters& ClockCache::counters() const {
+    snapshot_ = stats_.snapshot();
+    return snapshot_;
+}
+
+void ClockCache::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    const size_t payload = sizeof(int) * 2;
+    theoretical = cap_ * payload;
+    actual = size() * payload;
+    overhead = table_.size() * sizeof(uint64_t) + cap_ * (sizeof(int) * 2 + sizeof(uint8_t))
+             + free_.capacity() * sizeof(uint32_t) - actual;
+}
+
+// Порядок — обход стрелки от hand_, то есть тот, в котором вытеснял бы сам CLOCK
+bool ClockCache::exportEntries(std::vector<SnapshotEntry>& out) const {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<uint32_t> slots;
+    for (const auto& t : table_) {
+        uint64_t v = t.load(std::memory_order_relaxed);
+        if (v) slots.push_back(slotOf(v));
+    }
+    auto dist = [&](uint32_t s) { return s >= hand_ ? s - hand_ : s + cap_ - hand_; };
+    std::sort(slots.begin(), slots.end(), [&](uint32_t a, uint32_t b) { return dist(a) < dist(b); });
+    out.reserve(out.size() + slots.size());
+    for (uint32_t s : slots)
+        out.push_back({keys_[s], vals_[s].load(std::memory_order_relaxed), refs_[s].load(std::memory_order_relaxed)});
+    return true;
+}
+
+// Записи занимают слоты 0..n-1, стрелка — в начале; freq != 0 ставит бит обращения
+void ClockCache::importEntries(const SnapshotEntry* e, size_t n) {
+    std::lock_guard<std::mutex> lock(mu_);
+    uint64_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (uint32_t i = 0; i < n; ++i) {
+        keys_[i] = e[i].key;
+        vals_[i].store(e[i].val, std::memory_order_relaxed);
+        refs_[i].store(e[i].freq ? 1 : 0, std::memory_order_relaxed);
+        indexInsert(e[i].key, i);
+    }
+    hand_ = 0;
+    sz_.store((uint32_t)n, std::memory_order_relaxed);
+    seq_.store(s + 2, std::memory_order_release);
+}
@@ -0,0 +1,461 @@
+#include "Experiment.h"
+#include "LRU.h"
+#include "LFU.h"
+#include "Clock.h"
+#include "TinyLFU.h"
+#include "ARC.h"
+#include "TwoQ.h"
+#include "SLRU.h"
+#include "SetAssoc.h"
+#include "Adaptive.h"
+#include "Sharded.h"
+#include "Stats.h"
+#include "TrackingAllocator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+template <class T, class... Args>
+EngineEntry engine(const char* algo, const char* impl, bool thread_safe, Args... args) {
+    EngineEntry e;
+    e.algo = algo;
+    e.impl = impl;
+    e.thread_safe = thread_safe;
+    e.make = [=](size_t cap) -> std::unique_ptr<ICache> { return std::make_unique<T>(cap, args...); };
+    e.estimate = [](const ICache& c, size_t& th, size_t& ac, size_t& ov) {
+        static_cast<const T&>(c).estimateMemory(th, ac, ov);
+    };
+    return e;
+}
+}
+
+const std::vector<EngineEntry>& engineRegistry() {
+    static const std::vector<EngineEntry> reg = {
+        engine<LRUCacheIter>("LRU", "iter", false),
+        engine<LRUCacheRec>("LRU", "rec", false),
+        engine<LFUCacheIter>("LFU", "iter", false),
+        engine<LFUCacheRec>("LFU", "rec", false),
+        engine<LRUCacheRec>("LRU", "rec-idx", false, RecMode::Indexed),
+        engine<LFUCacheRec>("LFU", "rec-idx", false, RecMode::Indexed),
+        engine<LRUCacheFlat>("LRU", "flat", false),
+        engine<LFUCachePool>("LFU", "pool", false),
+        engine<SetAssocCache>("LRU", "set8", false, 8),
+        engine<SetAssocCache>("LRU", "set16", false, 16),
+        engine<SetAssocCache>("LFU", "set8", false, 8, SetPolicy::LFU),
+        engine<SetAssocCache>("LFU", "set16", false, 16, SetPolicy::LFU),
+        engine<ClockCache>("CLOCK", "lockfree", true),
+        engine<TinyLFUCache>("TinyLFU", "window", false),
+        engine<ARCCache>("ARC", "ghost", false),
+        engine<TwoQCache>("2Q", "full", false),
+        engine<SLRUCache>("SLRU", "seg", false),
+        engine<AdaptiveCache>("ADAPT", "shadow", false),
+    };
+    return reg;
+}
+
+const EngineEntry* findEngine(const std::string& name) {
+    for (const auto& e : engineRegistry())
+        if (e.name() == name) return &e;
+    return nullptr;
+}
+
+std::vector<const EngineEntry*> selectEngines(const std::string& pattern) {
+    std::vector<const EngineEntry*> out;
+    size_t slash = pattern.find('/');
+    std::string algo = pattern == "all" ? "*" : pattern.substr(0, slash);
+    std::string impl = pattern == "all" ? "*" : (slash == std::string::npos ? "*" : pattern.substr(slash + 1));
+    for (const auto& e : engineRegistry())
+        if ((algo == "*" || algo == e.algo) && (impl == "*" || impl == e.impl)) out.push_back(&e);
+    return out;
+}
+
+std::vector<const EngineEntry*> selectEngineList(const std::vector<std::string>& patterns) {
+    std::vector<const EngineEntry*> out;
+    for (const auto& p : patterns)
+        for (const EngineEntry* e : selectEngines(p))
+            if (std::find(out.begin(), out.end(), e) == out.end()) out.push_back(e);
+    return out;
+}
+
+// ---- Разбор настроек ----
+
+namespace {
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r\n"), e = s.find_last_not_of(" \t\r\n");
+    return b == std::string::npos ? std::string() : s.substr(b, e - b + 1);
+}
+
+std::vector<std::string> split(const std::string& s, char sep) {
+    std::vector<std::string> out;
+    size_t from = 0;
+    while (from <= s.size()) {
+        size_t to = s.find(sep, from);
+        if (to == std::string::npos) to = s.size();
+        std::string part = trim(s.substr(from, to - from));
+        if (!part.empty()) out.push_back(part);
+        from = to + 1;
+    }
+    return out;
+}
+
+// Целое с суффиксом: K/M/G — 10^3/10^6/10^9, Ki/Mi/Gi — 2^10/2^20/2^30
+bool parseCount(const std::string& s, long long& v) {
+    char* end = nullptr;
+    double x = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || x < 0) return false;
+    std::string suf(end);
+    static const std::pair<const char*, double> mult[] = {
+        {"", 1.0}, {"K", 1e3}, {"M", 1e6}, {"G", 1e9}, {"Ki", 1024.0}, {"Mi", 1048576.0}, {"Gi", 1073741824.0}};
+    for (const auto& [name, m] : mult)
+        if (suf == name) { v = (long long)(x * m + 0.5); return true; }
+    return false;
+}
+
+bool parseDouble(const std::string& s, double& v) {
+    char* end = nullptr;
+    v = std::strtod(s.c_str(), &end);
+    return end != s.c_str() && *end == '\0';
+}
+
+// "name key=value key=value…": dist=zipf|hotset|loop, alpha, locality, loop,
+// universe (число или Nx — кратно ёмкости), writes, drift=period:step, scan=period:len, seed
+bool parseWorkload(const std::string& text, MatrixWorkload& w, std::string& err) {
+    std::vector<std::string> parts;
+    for (const auto& p : split(text, ' ')) parts.push_back(p);
+    if (parts.empty()) { err = "workload без имени"; return false; }
+    w = MatrixWorkload();
+    w.name = parts[0];
+    w.spec.write_ratio = 0.3;
+    for (size_t i = 1; i < parts.size(); ++i) {
+        size_t eq = parts[i].find('=');
+        if (eq == std::string::npos) { err = "workload: ожидалось ключ=значение: " + parts[i]; return false; }
+        std::string k = parts[i].substr(0, eq), v = parts[i].substr(eq + 1);
+        long long n = 0;
+        double d = 0.0;
+        bool ok = true;
+        if (k == "dist") {
+            if (v == "zipf") w.spec.dist = KeyDist::Zipf;
+            else if (v == "hotset") w.spec.dist = KeyDist::HotSet;
+            else if (v == "loop") w.spec.dist = KeyDist::Loop;
+            else ok = false;
+        } else if (k == "alpha") ok = parseDouble(v, w.spec.zipf_alpha);
+        else if (k == "locality") ok = parseDouble(v, w.spec.locality);
+        else if (k == "writes") ok = parseDouble(v, w.spec.write_ratio);
+        else if (k == "loop") { ok = parseCount(v, n); w.spec.loop_len = (int)n; }
+        else if (k == "seed") { ok = parseCount(v, n); w.spec.seed = (uint64_t)n; }
+        else if (k == "universe") {
+            if (!v.empty() && v.back() == 'x') { ok = parseDouble(v.substr(0, v.size() - 1), d) && d > 0; w.universe_per_cap = d; }
+            else { ok = parseCount(v, n) && n > 0; w.spec.universe = (int)n; w.universe_per_cap = 0.0; }
+        } else if (k == "drift" || k == "scan") {
+            auto pv = split(v, ':');
+            long long a = 0, b = 0;
+            ok = pv.size() == 2 && parseCount(pv[0], a) && parseCount(pv[1], b);
+            if (k == "drift") { w.spec.drift_period = a; w.spec.drift_step = (int)b; }
+            else              { w.spec.scan_period = a;  w.spec.scan_len = (int)b; }
+        } else { err = "workload: неизвестный ключ " + k; return false; }
+        if (!ok) { err = "workload: неверное значение " + parts[i]; return false; }
+    }
+    return true;
+}
+}
+
+bool applyMatrixSetting(MatrixSpec& spec, const std::string& line, std::string& err) {
+    std::string s = trim(line.substr(0, line.find('#')));
+    if (s.empty()) return true;
+    size_t eq = s.find('=');
+    if (eq == std::string::npos) { err = "ожидалось ключ = значение: " + s; return false; }
+    std::string key = trim(s.substr(0, eq)), val = trim(s.substr(eq + 1));
+    // Списки разбираются целиком и только потом заменяют прежние: ошибка не портит spec
+    auto counts = [&](auto& out) {
+        std::decay_t<decltype(out)> parsed;
+        for (const auto& p : split(val, ',')) {
+            long long v = 0;
+            if (!parseCount(p, v) || v <= 0) { err = key + ": неверное число " + p; return false; }
+            parsed.push_back((typename std::decay_t<decltype(out)>::value_type)v);
+        }
+        if (parsed.empty()) { err = key + ": пустой список"; return false; }
+        out = std::move(parsed);
+        return true;
+    };
+    long long n = 0;
+    if (key == "engines") {
+        std::vector<std::string> parsed;
+        for (const auto& p : split(val, ',')) {
+            if (selectEngines(p).empty()) { err = "engines: нет движка " + p; return false; }
+            parsed.push_back(p);
+        }
+        if (parsed.empty()) { err = "engines: пустой список"; return false; }
+        spec.engines = std::move(parsed);
+        return true;
+    }
+    if (key == "capacities") return counts(spec.capacities);
+    if (key == "threads") return counts(spec.threads);
+    if (key == "batch") return counts(spec.batches);
+    if (key == "workload") {
+        MatrixWorkload w;
+        if (!parseWorkload(val, w, err)) return false;
+        spec.workloads.erase(std::remove_if(spec.workloads.begin(), spec.workloads.end(),
+                                            [&](const MatrixWorkload& o) { return o.name == w.name; }),
+                             spec.workloads.end());
+        spec.workloads.push_back(w);
+        return true;
+    }
+    if (key == "workloads") {
+        // Оставить только перечисленные (по имени), в заданном порядке
+        std::vector<MatrixWorkload> keep;
+        for (const auto& name : split(val, ',')) {
+            auto it = std::find_if(spec.workloads.begin(), spec.workloads.end(),
+                                   [&](const MatrixWorkload& o) { return o.name == name; });
+            if (it == spec.workloads.end()) { err = "workloads: не описана нагрузка " + name; return false; }
+            keep.push_back(*it);
+        }
+        spec.workloads = keep;
+        return true;
+    }
+    if (key == "ops") { if (!parseCount(val, n) || n <= 0) { err = "ops: " + val; return false; } spec.ops = n; return true; }
+    if (key == "warmup") {
+        double d = 0.0;
+        bool pct = !val.empty() && val.back() == '%';
+        if (!parseDouble(pct ? val.substr(0, val.size() - 1) : val, d) || d < 0 || (pct ? d >= 100 : d >= 1)) {
+            err = "warmup: доля [0, 1) или процент: " + val; return false;
+        }
+        spec.warmup_fraction = pct ? d / 100.0 : d;
+        return true;
+    }
+    if (key == "trials" || key == "discard" || key == "shards") {
+        if (!parseCount(val, n)) { err = key + ": " + val; return false; }
+        if (key == "trials") spec.trials = (int)n;
+        else if (key == "discard") spec.discard_trials = (int)n;
+        else spec.shards = (size_t)std::max(1LL, n);
+        return true;
+    }
+    if (key == "pin") {
+        std::vector<int> cpus;
+        if (val != "auto" && val != "off") {
+            for (const auto& p : split(val, ',')) {
+                if (!parseCount(p, n)) { err = "pin: off, auto или список ядер: " + val; return false; }
+                cpus.push_back((int)n);
+            }
+        }
+        spec.pin_cpus = std::move(cpus);
+        spec.pin_auto = val == "auto";
+        return true;
+    }
+    if (key == "seed") { if (!parseCount(val, n)) { err = "seed: " + val; return false; } spec.seed = (uint64_t)n; return true; }
+    if (key == "output") { spec.output = val; return true; }
+    err = "неизвестный ключ " + key;
+    return false;
+}
+
+bool loadMatrixConfig(MatrixSpec& spec, const std::string& path, std::string& err) {
+    std::ifstream in(path);
+    if (!in) { err = "не открыть " + path; return false; }
+    std::string line;
+    for (int no = 1; std::getline(in, line); ++no) {
+        if (!applyMatrixSetting(spec, line, err)) { err = path + ":" + std::to_string(no) + ": " + err; return false; }
+    }
+    return true;
+}
+
+// ---- Прогон ----
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+bool pinThread(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Кусок [b, e) нагрузки поштучно или пакетами, как runScenarioBatched: пакет —
+// серия подряд идущих чтений или записей, порядок операций сохраняется
+struct SliceRunner {
+    std::vector<int> gk, pk, pv;
+    std::vector<std::optional<int>> out;
+
+    void run(ICache& c, const Workload& wl, size_t b, size_t e, size_t batch) {
+        if (batch <= 1) {
+            for (size_t i = b; i < e; ++i) {
+                int x = wl.ops[i];
+                if (!wl.isWrite(i)) (void)c.get(x);
+                else                c.put(x, x * 10);
+            }
+            return;
+        }
+        out.resize(batch);
+        gk.clear(); pk.clear(); pv.clear();
+        for (size_t i = b; i < e; ++i) {
+            int x = wl.ops[i];
+            if (!wl.isWrite(i)) {
+                if (!pk.empty() || gk.size() == batch) flush(c);
+                gk.push_back(x);
+            } else {
+                if (!gk.empty() || pk.size() == batch) flush(c);
+                pk.push_back(x); pv.push_back(x * 10);
+            }
+        }
+        flush(c);
+    }
+
+    void flush(ICache& c) {
+        if (!gk.empty()) { c.getMany(gk.data(), gk.size(), out.data()); gk.clear(); }
+        if (!pk.empty()) { c.putMany(pk.data(), pv.data(), pk.size()); pk.clear(); pv.clear(); }
+    }
+};
+
+struct CellResult {
+    long long elapsed_ns = 0;
+    long long ops = 0;
+    OpCounters d;               // счётчики измеряемой части
+    long long live_bytes = 0;
+    size_t entries = 0;
+    int pinned = 0;             // потоков, которые удалось привязать
+};
+
+// Одна клетка: потоки проходят свой кусок прогревочной части, затем — по общему
+// старту — свой кусок измеряемой. Счётчики снимаются на ходу между фазами
+// (у ShardedCache и CLOCK это не требует блокировок).
+CellResult runCell(const MatrixSpec& spec, const EngineEntry& e, size_t cap, const Workload& wl,
+                   int threads, size_t batch) {
+    CellResult r;
+    AllocStats s0 = allocSnapshot();
+    std::unique_ptr<ICache> cache;
+    if (threads > 1 && !e.thread_safe) {
+        cache = std::make_unique<ShardedCache>(cap, spec.shards, e.make);
+    } else {
+        cache = e.make(cap);
+    }
+
+    const size_t n = wl.ops.size();
+    const size_t warm = (size_t)(n * spec.warmup_fraction);
+    std::atomic<int> arrived{0}, pinned{0};
+    std::atomic<int> phase{0};        // 1 — прогрев, 2 — измерение
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            int cpu = -1;
+            if (!spec.pin_cpus.empty()) cpu = spec.pin_cpus[t % spec.pin_cpus.size()];
+            else if (spec.pin_auto) cpu = (int)(t % std::max(1u, std::thread::hardware_concurrency()));
+            if (cpu >= 0 && pinThread(cpu)) pinned.fetch_add(1);
+            SliceRunner sr;
+            auto slice = [&](size_t from, size_t to) {
+                size_t chunk = (to - from + threads - 1) / threads;
+                size_t b = std::min(to, from + t * chunk);
+                sr.run(*cache, wl, b, std::min(to, b + chunk), batch);
+            };
+            arrived.fetch_add(1);
+            while (phase.load(std::memory_order_acquire) < 1) std::this_thread::yield();
+            slice(0, warm);
+            arrived.fetch_add(1);
+            while (phase.load(std::memory_order_acquire) < 2) std::this_thread::yield();
+            slice(warm, n);
+        });
+    }
+    while (arrived.load() < threads) std::this_thread::yield();
+    phase.store(1, std::memory_order_release);
+    while (arrived.load() < 2 * threads) std::this_thread::yield();
+    OpCounters before = cache->counters();
+    auto t0 = Clock::now();
+    phase.store(2, std::memory_order_release);
+    for (auto& th : pool) th.join();
+    r.elapsed_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    r.d = delta(cache->counters(), before);
+    r.ops = (long long)(n - warm);
+    r.live_bytes = allocDelta(s0, allocSnapshot()).live_usable;
+    r.entries = cache->size();
+    r.pinned = pinned.load();
+    return r;
+}
+}
+
+long long runMatrix(const MatrixSpec& spec, std::ostream& log) {
+    std::vector<const EngineEntry*> engines;
+    for (const auto& p : spec.engines)
+        for (const EngineEntry* e : selectEngines(p))
+            if (std::find(engines.begin(), engines.end(), e) == engines.end()) engines.push_back(e);
+    if (engines.empty()) { log << "matrix: нет движков\n"; return -1; }
+
+    std::vector<MatrixWorkload> workloads = spec.workloads;
+    if (workloads.empty()) {
+        MatrixWorkload w;
+        w.name = "zipf";
+        w.spec.write_ratio = 0.3;
+        workloads.push_back(w);
+    }
+
+    std::ofstream out(spec.output);
+    if (!out) { log << "matrix: не открыть " << spec.output << "\n"; return -1; }
+    out.precision(12);      // elapsed_ns и счётчики — целиком, без экспоненты
+    out << "run,engine,algo,impl,workload,capacity,threads,batch,trial,metric,value\n";
+
+    const long long cells = (long long)engines.size() * spec.capacities.size() * workloads.size()
+                          * spec.threads.size() * spec.batches.size();
+    log << "matrix: " << engines.size() << " движков × " << spec.capacities.size() << " ёмкостей × "
+        << workloads.size() << " нагрузок × " << spec.threads.size() << " потоков × "
+        << spec.batches.size() << " пакетов = " << cells << " клеток, по " << spec.trials << " повторов (+"
+        << spec.discard_trials << " в прогрев), " << spec.ops << " операций, прогрев "
+        << spec.warmup_fraction * 100.0 << "% -> " << spec.output << "\n";
+
+    long long run = 0;
+    bool pin_reported = false;
+    for (const auto& w : workloads) {
+        for (size_t cap : spec.capacities) {
+            // Нагрузка строится один раз на (нагрузку, ёмкость) и общая для всех движков
+            WorkloadSpec ws = w.spec;
+            ws.ops = spec.ops;
+            if (w.universe_per_cap > 0) ws.universe = (int)std::max(1.0, cap * w.universe_per_cap);
+            if (ws.seed == WorkloadSpec().seed) ws.seed = spec.seed;
+            Workload wl = generateWorkload(ws);
+            for (const EngineEntry* e : engines) {
+                for (int threads : spec.threads) {
+                    for (size_t batch : spec.batches) {
+                        for (int trial = -spec.discard_trials; trial < spec.trials; ++trial) {
+                            CellResult r = runCell(spec, *e, cap, wl, threads, batch);
+                            if (!pin_reported && (spec.pin_auto || !spec.pin_cpus.empty())) {
+                                log << "matrix: привязано потоков " << r.pinned << "/" << threads << "\n";
+                                pin_reported = true;
+                            }
+                            if (trial < 0) continue;
+                            const std::pair<const char*, double> metrics[] = {
+                                {"ops", (double)r.ops},
+                                {"elapsed_ns", (double)r.elapsed_ns},
+                                {"ns_per_op", r.ops ? (double)r.elapsed_ns / r.ops : 0.0},
+                                {"ops_per_sec", opsPerSec(r.d, r.elapsed_ns)},
+                                {"hit_rate", hitRate(r.d)},
+                                {"gets", (double)r.d.gets},
+                                {"puts", (double)r.d.puts},
+                                {"evictions", (double)r.d.evictions},
+                                {"live_bytes", (double)r.live_bytes},
+                                {"bytes_per_entry", r.entries ? (double)r.live_bytes / r.entries : 0.0},
+                            };
+                            for (const auto& [m, v] : metrics)
+                                out << run << "," << e->name() << "," << e->algo << "," << e->impl << "," << w.name << ","
+                                    << cap << "," << threads << "," << batch << "," << trial << "," << m << "," << v << "\n";
+                            run++;
+                        }
+                    }
+                }
+            }
+            log << "matrix: " << w.name << " cap " << cap << " готово\n";
+        }
+    }
+    return run;
+}
@@ -0,0 +1,45 @@
+#include "FrequencySketch.h"
+#include "CacheT.h"
+
+FrequencySketch::FrequencySketch(size_t capacity) {
+    // ~16 счётчиков на запись кэша: блоков по 128 счётчиков — capacity / 8
+    size_t n = 1;
+    while (n * 8 < capacity) n <<= 1;
+    blocks_.assign(n, Block{});
+    blockMask_ = n - 1;
+    sampleSize_ = capacity ? capacity * 10 : 10;
+}
+
+// Блок выбирают младшие биты хеша, а для i-го счётчика — слово 2i или 2i+1
+// и номер полубайта — из старших битов.
+void FrequencySketch::increment(int key) {
+    uint64_t h = mix64((uint64_t)(uint32_t)key);
+    Block& b = blocks_[h & blockMask_];
+    bool added = false;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t& w = b.w[i * 2 + ((h >> (32 + i)) & 1)];
+        int shift = (int)((h >> (40 + i * 4)) & 15) * 4;
+        if (((w >> shift) & 0xF) != 0xF) { w += 1ull << shift; added = true; }
+    }
+    if (added && ++additions_ >= sampleSize_) age();
+}
+
+int FrequencySketch::estimate(int key) const {
+    uint64_t h = mix64((uint64_t)(uint32_t)key);
+    const Block& b = blocks_[h & blockMask_];
+    int best = 15;
+    for (int i = 0; i < 4; ++i) {
+        uint64_t w = b.w[i * 2 + ((h >> (32 + i)) & 1)];
+        int shift = (int)((h >> (40 + i * 4)) & 15) * 4;
+        int c = (int)((w >> shift) & 0xF);
+        if (c < best) best = c;
+    }
+    return best;
+}
+
+void FrequencySketch::age() {
+    for (auto& b : blocks_)
+        for (auto& w : b.w) w = (w >> 1) & 0x7777777777777777ull;
+    additions_ /= 2;
+    resets_++;
+}
@@ -0,0 +1,175 @@
+#include "GDS.h"
+#include <algorithm>
+
+GDSCache::GDSCache(size_t byteBudget, uint32_t pageSize, uint32_t defaultSize)
+    : budget_(byteBudget), defaultSize_(defaultSize),
+      arena_(byteBudget + byteBudget / 4, pageSize, 64u << 10),
+      nodes_(byteBudget / SlabArena::kMinChunk + 1),
+      index_(byteBudget / SlabArena::kMinChunk + 1) {
+    free_.reserve(nodes_.size());
+    for (size_t i = nodes_.size(); i > 0; --i) free_.push_back((uint32_t)(i - 1));
+    // В классе не больше budget / размер куска записей — кучи не растут во время работы
+    heaps_.resize(arena_.classCount());
+    for (uint32_t c = 0; c < heaps_.size(); ++c) heaps_[c].reserve(byteBudget / arena_.classSize(c) + 1);
+}
+
+void GDSCache::siftUp(TrackedVector<uint32_t>& heap, uint32_t pos) {
+    uint32_t i = heap[pos];
+    while (pos > 0) {
+        uint32_t parent = (pos - 1) / 2;
+        if (!less(i, heap[parent])) break;
+        heap[pos] = heap[parent];
+        nodes_[heap[pos]].heapPos = pos;
+        pos = parent;
+    }
+    heap[pos] = i;
+    nodes_[i].heapPos = pos;
+}
+
+void GDSCache::siftDown(TrackedVector<uint32_t>& heap, uint32_t pos) {
+    uint32_t i = heap[pos];
+    const uint32_t n = (uint32_t)heap.size();
+    for (;;) {
+        uint32_t c = pos * 2 + 1;
+        if (c >= n) break;
+        if (c + 1 < n && less(heap[c + 1], heap[c])) ++c;
+        if (!less(heap[c], i)) break;
+        heap[pos] = heap[c];
+        nodes_[heap[pos]].heapPos = pos;
+        pos = c;
+    }
+    heap[pos] = i;
+    nodes_[i].heapPos = pos;
+}
+
+// Обращение: H = L + cost / size. При get H не убывает, но put того же ключа
+// с меньшей стоимостью может его уменьшить — поэтому просеиваем в обе стороны.
+void GDSCache::touch(uint32_t i) {
+    Node& n = nodes_[i];
+    n.h = inflation_ + n.cost / n.bytes;
+    n.seq = ++clock_;
+    auto& heap = heaps_[n.cls];
+    siftUp(heap, n.heapPos);
+    siftDown(heap, n.heapPos);
+}
+
+void GDSCache::remove(uint32_t i) {
+    Node& n = nodes_[i];
+    auto& heap = heaps_[n.cls];
+    uint32_t last = heap.back();
+    heap.pop_back();
+    if (n.heapPos < heap.size()) {
+        heap[n.heapPos] = last;
+        nodes_[last].heapPos = n.heapPos;
+        siftUp(heap, n.heapPos);
+        siftDown(heap, nodes_[last].heapPos);
+    }
+    arena_.free(n.handle, n.bytes);
+    used_ -= arena_.classSize(n.cls);
+    index_.erase(n.key);
+    free_.push_back(i);
+    sz_--;
+}
+
+// Вытеснение по нехватке кусков класса берёт минимум класса, а не глобальный:
+// его H может быть выше, чем у живых записей других классов. L поднимаем только
+// вверх, иначе он бы «прыгнул» над ними, а следующий evictMin вернул бы его назад.
+void GDSCache::evict(uint32_t i) {
+    Node& n = nodes_[i];
+    inflation_ = std::max(inflation_, n.h);
+    cnt_.evictions++;
+    notifyEvict(n.key, n.val, EvictReason::Capacity);
+    remove(i);
+}
+
+// Глобальный минимум — среди вершин куч классов (их ~30)
+bool GDSCache::evictMin() {
+    uint32_t best = IndexList::kNil;
+    for (const auto& heap : heaps_)
+        if (!heap.empty() && (best == IndexList::kNil || less(heap[0], best))) best = heap[0];
+    if (best == IndexList::kNil) return false;
+    evict(best);
+    return true;
+}
+
+std::optional<int> GDSCache::get(int key) {
+    cnt_.gets++;
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) { cnt_.misses++; return std::nullopt; }
+    touch(i);
+    cnt_.hits++;
+    return nodes_[i].val;
+}
+
+char* GDSCache::payload(int key) {
+    uint32_t i = index_.find(key);
+    return i == FlatIndex::kEmpty ? nullptr : arena_.data(nodes_[i].handle);
+}
+
+void GDSCache::put(int key, int value, uint32_t bytes, double cost) {
+    cnt_.puts++;
+    bytes = std::max<uint32_t>(bytes, 1);
+    uint32_t i = index_.find(key);
+    if (i != FlatIndex::kEmpty) {
+        if (nodes_[i].bytes == bytes) {
+            nodes_[i].val = value;
+            nodes_[i].cost = cost;
+            touch(i);
+            return;
+        }
+        remove(i);   // размер изменился — пересоздаём запись в другом куске
+    }
+    // Объект больше куска или всего бюджета не кэшируем
+    if (bytes > arena_.maxChunk() || arena_.chunkSize(bytes) > budget_) return;
+
+    const uint32_t cls = arena_.classOf(bytes);
+    const uint32_t chunk = arena_.classSize(cls);
+    while (used_ + chunk > budget_) evictMin();
+    uint32_t h = arena_.alloc(bytes);
+    while (h == SlabArena::kNone) {
+        // Свободного куска нет: освобождаем свой класс, а если он пуст —
+        // глобальный минимум, пока не опустеет какая-нибудь страница
+        if (!heaps_[cls].empty()) evict(heaps_[cls][0]);
+        else if (!evictMin()) return;
+        arenaEvictions_++;
+        h = arena_.alloc(bytes);
+    }
+
+    i = free_.back();
+    free_.pop_back();
+    Node& n = nodes_[i];
+    n.key = key;
+    n.val = value;
+    n.bytes = bytes;
+    n.cost = cost;
+    n.handle = h;
+    n.cls = cls;
+    n.h = inflation_ + cost / bytes;
+    n.seq = ++clock_;
+    heaps_[cls].push_back(i);
+    siftUp(heaps_[cls], (uint32_t)heaps_[cls].size() - 1);
+    index_.insert(key, i);
+    used_ += chunk;
+    sz_++;
+}
+
+bool GDSCache::erase(int key) {
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) return false;
+    int val = nodes_[i].val;
+    remove(i);
+    notifyEvict(key, val, EvictReason::Erase);
+    return true;
+}
+
+// theoretical — бюджет, actual — запрошенные байты значений,
+// overhead — служебные структуры плюс всё, что арена держит сверх actual
+void GDSCache::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    size_t heapBytes = 0;
+    for (const auto& heap : heaps_) heapBytes += heap.capacity() * sizeof(uint32_t);
+    theoretical = budget_;
+    actual = arena_.requestedBytes();
+    overhead = nodes_.capacity() * sizeof(Node) + free_.capacity() * sizeof(uint32_t)
+             + heapBytes + index_.bytes() + arena_.bytes()
+             + (arena_.reservedBytes() - actual);
+}
@@ -1,9 +1,10 @@
 #include "LFU.h"
 #include "CacheBase.h"
+#include <algorithm>
 
 LFUCacheIter::LFUCacheIter(size_t cap) : cap_(cap) {}
 
-void LFUCacheIter::touch(std::unordered_map<int, std::list<Node>::iterator>::iterator it) {
+void LFUCacheIter::touch(TrackedHashMap<int, TrackedList<Node>::iterator>::iterator it) {
     auto node = *(it->second);
     int f = node.freq;
     buckets_[f].erase(it->second);
@@ -20,7 +21,7 @@ void LFUCacheIter::evictOne() {
     if (sz_ == 0) return;
     auto& lst = buckets_[minFreq_];
     auto victim = lst.back();
-    if (g_on_evict_key) g_on_evict_key(victim.key);
+    notifyEvict(victim.key, victim.val, EvictReason::Capacity);
     pos_.erase(victim.key);
     lst.pop_back();
     if (lst.empty()) buckets_.erase(minFreq_);
@@ -49,6 +50,27 @@ void LFUCacheIter::put(int key, int value) {
     sz_++;
 }
 
+bool LFUCacheIter::erase(int key) {
+    auto it = pos_.find(key);
+    if (it == pos_.end()) return false;
+    Node node = *(it->second);
+    auto& lst = buckets_[node.freq];
+    lst.erase(it->second);
+    pos_.erase(it);
+    if (lst.empty()) {
+        buckets_.erase(node.freq);
+        // Удалённая запись могла быть последней с минимальной частотой
+        if (minFreq_ == (size_t)node.freq) {
+            minFreq_ = 0;
+            for (const auto& kv : buckets_)
+                if (minFreq_ == 0 || (size_t)kv.first < minFreq_) minFreq_ = kv.first;
+        }
+    }
+    sz_--;
+    notifyEvict(key, node.val, EvictReason::Erase);
+    return true;
+}
+
 void LFUCacheIter::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
     theoretical = cap_ * sizeof(Node);
     actual = sz_ * sizeof(Node);
@@ -58,56 +80,416 @@ void LFUCacheIter::estimateMemory(size_t& theoretical, size_t& actual, size_t& o
     overhead = buckets_over + map_over;
 }
 
-LFUCacheRec::LFUCacheRec(size_t cap) : cap_(cap) {}
-LFUCacheRec::~LFUCacheRec(){ freeList(head_); }
-void LFUCacheRec::freeList(Node* n){ if(!n) return; freeList(n->next); delete n; deallocations_++; }
+LFUCacheRec::LFUCacheRec(size_t cap, RecMode mode) : cap_(cap) {
+    // Различных частот обычно немного, поэтому индекс серий растёт по мере надобности
+    if (mode == RecMode::Indexed) { pred_.emplace(cap); last_.emplace(16); }
+}
+LFUCacheRec::~LFUCacheRec(){ freeList(sentinel_.next); }
 
-std::optional<int> LFUCacheRec::get(int key) {
-    cnt_.gets++;
-    auto v = getRec(head_, key);
-    if (v) cnt_.hits++; else cnt_.misses++;
-    return v;
+void LFUCacheRec::freeList(Node* n) {
+    while (n) { Node* next = n->next; delete n; deallocations_++; n = next; }
+}
+
+// Узел перед ключом (&sentinel_ для головы) или nullptr, если ключа нет
+LFUCacheRec::Node* LFUCacheRec::findPrev(int key) {
+    if (pred_) return pred_->find(key);
+    for (Node* p = &sentinel_; p->next; p = p->next)
+        if (p->next->key == key) return p;
+    return nullptr;
 }
 
-std::optional<int> LFUCacheRec::getRec(Node* cur, int key) {
-    if (!cur) return std::nullopt;
-    if (cur->key == key) { cur->freq++; return cur->val; }
-    return getRec(cur->next, key);
+// Последний узел с той же частотой, что у x (в Plain — проход вперёд по серии)
+LFUCacheRec::Node* LFUCacheRec::runLast(Node* x) {
+    if (last_) return last_->find(x->freq);
+    Node* l = x;
+    while (l->next && l->next->freq == x->freq) l = l->next;
+    return l;
 }
 
-bool LFUCacheRec::putUpdateRec(Node* cur, int key, int value) {
-    if (!cur) return false;
-    if (cur->key == key) { cur->val = value; cur->freq++; return true; }
-    return putUpdateRec(cur->next, key, value);
+// x покидает свою серию: если он был в ней последним, последним становится prev
+void LFUCacheRec::dropFromRun(Node* prev, Node* x) {
+    if (!last_ || last_->find(x->freq) != x) return;
+    if (prev != &sentinel_ && prev->freq == x->freq) last_->assign(x->freq, prev);
+    else { last_->erase(x->freq); runs_--; }
 }
 
-std::pair<LFUCacheRec::Node*, LFUCacheRec::Node*>
-LFUCacheRec::findMinPrevRec(Node* prev, Node* cur, Node* bestPrev, Node* best) {
-    if (!cur) return {bestPrev, best};
-    if (!best || cur->freq < best->freq) { bestPrev = prev; best = cur; }
-    return findMinPrevRec(cur, cur->next, bestPrev, best);
+// x — первый узел частоты f; серии ещё нет — он же и последний
+void LFUCacheRec::openRun(int f, Node* x) {
+    if (!last_ || last_->find(f)) return;
+    if (++runs_ > last_->capacity()) {
+        BasicFlatIndex<Node*> bigger(last_->capacity() * 2);
+        last_->forEach([&](int freq, Node* n) { bigger.insert(freq, n); });
+        last_ = std::move(bigger);
+    }
+    last_->insert(f, x);
+}
+
+void LFUCacheRec::unlink(Node* prev, Node* x) {
+    prev->next = x->next;
+    if (x->next && pred_) pred_->assign(x->next->key, prev);
+}
+
+// Частота x растёт на 1: x встаёт первым в серию freq+1, то есть сразу за
+// последним узлом своей прежней серии. Если он и был последним — остаётся на месте.
+void LFUCacheRec::touch(Node* prev, Node* x) {
+    int f = x->freq;
+    Node* l = runLast(x);
+    if (l == x) {
+        dropFromRun(prev, x);
+    } else {
+        unlink(prev, x);
+        x->next = l->next;
+        if (x->next && pred_) pred_->assign(x->next->key, x);
+        l->next = x;
+        if (pred_) pred_->assign(x->key, l);
+    }
+    x->freq = f + 1;
+    openRun(f + 1, x);
+}
+
+std::optional<int> LFUCacheRec::get(int key) {
+    cnt_.gets++;
+    Node* prev = findPrev(key);
+    if (!prev) { cnt_.misses++; return std::nullopt; }
+    Node* x = prev->next;
+    touch(prev, x);
+    cnt_.hits++;
+    return x->val;
 }
 
 void LFUCacheRec::put(int key, int value) {
     cnt_.puts++;
     if (cap_ == 0) return;
-    if (putUpdateRec(head_, key, value)) return;
+    if (Node* prev = findPrev(key)) {
+        Node* x = prev->next;
+        x->val = value;
+        touch(prev, x);
+        return;
+    }
     if (sz_ == cap_) {
-        auto [pMin, minNode] = findMinPrevRec(nullptr, head_, nullptr, nullptr);
-        if (minNode) {
-            if (g_on_evict_key) g_on_evict_key(minNode->key);
-            if (pMin) pMin->next = minNode->next; else head_ = minNode->next;
-            delete minNode; deallocations_++;
-            cnt_.evictions++; sz_--;
-        }
+        // Голова — наименьшая частота
+        Node* h = sentinel_.next;
+        dropFromRun(&sentinel_, h);
+        unlink(&sentinel_, h);
+        if (pred_) pred_->erase(h->key);
+        notifyEvict(h->key, h->val, EvictReason::Capacity);
+        delete h; deallocations_++;
+        cnt_.evictions++; sz_--;
     }
-    Node* n = new Node{key, value, 1, head_};
+    Node* n = new Node{key, value, 1, sentinel_.next};
     allocations_++;
-    head_ = n; sz_++;
+    if (n->next && pred_) pred_->assign(n->next->key, n);
+    sentinel_.next = n;
+    if (pred_) pred_->insert(key, &sentinel_);
+    openRun(1, n);
+    sz_++;
+}
+
+bool LFUCacheRec::erase(int key) {
+    Node* prev = findPrev(key);
+    if (!prev) return false;
+    Node* x = prev->next;
+    dropFromRun(prev, x);
+    unlink(prev, x);
+    if (pred_) pred_->erase(key);
+    notifyEvict(x->key, x->val, EvictReason::Erase);
+    delete x; deallocations_++; sz_--;
+    return true;
 }
 
 void LFUCacheRec::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
     theoretical = cap_ * sizeof(Node);
     actual = sz_ * sizeof(Node);
-    overhead = sz_ * sizeof(void*);
+    overhead = sz_ * sizeof(void*) + (pred_ ? pred_->bytes() + last_->bytes() : 0);
+}
+
+LFUCachePool::LFUCachePool(size_t cap) : cap_(cap), nodes_(cap), buckets_(cap + 1), index_(cap), wheel_(cap) {
+    free_.reserve(cap);
+    // Узлов частот нужно не больше, чем записей, плюс один на время touch
+    for (uint32_t b = 0; b < buckets_.size(); ++b)
+        buckets_[b].next = (b + 1 < buckets_.size()) ? b + 1 : kNil;
+    freeBucket_ = buckets_.empty() ? kNil : 0;
+}
+
+// Новый узел частоты вставляется сразу после after (kNil — в начало списка)
+uint32_t LFUCachePool::allocBucket(uint32_t freq, uint32_t after) {
+    uint32_t b = freeBucket_;
+    freeBucket_ = buckets_[b].next;
+    Bucket& nb = buckets_[b];
+    nb.freq = freq;
+    nb.head = nb.tail = kNil;
+    nb.prev = after;
+    nb.next = (after == kNil) ? minBucket_ : buckets_[after].next;
+    if (nb.next != kNil) buckets_[nb.next].prev = b;
+    if (after == kNil) minBucket_ = b; else buckets_[after].next = b;
+    return b;
+}
+
+void LFUCachePool::releaseBucketIfEmpty(uint32_t b) {
+    Bucket& ob = buckets_[b];
+    if (ob.head != kNil) return;
+    if (ob.prev != kNil) buckets_[ob.prev].next = ob.next; else minBucket_ = ob.next;
+    if (ob.next != kNil) buckets_[ob.next].prev = ob.prev;
+    ob.next = freeBucket_;
+    freeBucket_ = b;
+}
+
+void LFUCachePool::detach(uint32_t i) {
+    Node& n = nodes_[i];
+    Bucket& b = buckets_[n.bucket];
+    if (n.prev != kNil) nodes_[n.prev].next = n.next; else b.head = n.next;
+    if (n.next != kNil) nodes_[n.next].prev = n.prev; else b.tail = n.prev;
+}
+
+void LFUCachePool::attachFront(uint32_t i, uint32_t b) {
+    Node& n = nodes_[i];
+    Bucket& bk = buckets_[b];
+    n.bucket = b;
+    n.prev = kNil;
+    n.next = bk.head;
+    if (bk.head != kNil) nodes_[bk.head].prev = i; else bk.tail = i;
+    bk.head = i;
+}
+
+void LFUCachePool::touch(uint32_t i) {
+    uint32_t b = nodes_[i].bucket;
+    uint32_t f = buckets_[b].freq;
+    uint32_t nx = buckets_[b].next;
+    bool alone = buckets_[b].head == i && buckets_[b].tail == i;
+    if (alone && (nx == kNil || buckets_[nx].freq != f + 1)) {
+        // Единственная запись частоты f: просто повышаем частоту узла на месте
+        buckets_[b].freq = f + 1;
+        return;
+    }
+    if (nx == kNil || buckets_[nx].freq != f + 1) nx = allocBucket(f + 1, b);
+    detach(i);
+    attachFront(i, nx);
+    releaseBucketIfEmpty(b);
+}
+
+std::optional<int> LFUCachePool::get(int key) {
+    cnt_.gets++;
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) { cnt_.misses++; return std::nullopt; }
+    touch(i);
+    cnt_.hits++;
+    return nodes_[i].val;
+}
+
+void LFUCachePool::put(int key, int value, uint32_t ttl) {
+    cnt_.puts++;
+    if (cap_ == 0) return;
+    uint32_t i = index_.find(key);
+    if (i != FlatIndex::kEmpty) {
+        nodes_[i].val = value;
+        touch(i);
+        if (ttl) wheel_.schedule(i, wheel_.now() + ttl); else wheel_.cancel(i);
+        return;
+    }
+    if (sz_ == cap_) {
+        // Жертва — самая давняя запись минимальной частоты; её слот переиспользуется
+        uint32_t b = minBucket_;
+        i = buckets_[b].tail;
+        int k = nodes_[i].key;
+        detach(i);
+        releaseBucketIfEmpty(b);
+        index_.erase(k);
+        wheel_.cancel(i);
+        cnt_.evictions++;
+        notifyEvict(k, nodes_[i].val, EvictReason::Capacity);
+    } else if (!free_.empty()) {
+        i = free_.back(); free_.pop_back(); sz_++;
+    } else {
+        i = sz_++;
+    }
+    uint32_t b = (minBucket_ != kNil && buckets_[minBucket_].freq == 1) ? minBucket_ : allocBucket(1, kNil);
+    nodes_[i].key = key;
+    nodes_[i].val = value;
+    attachFront(i, b);
+    index_.insert(key, i);
+    if (ttl) wheel_.schedule(i, wheel_.now() + ttl);
+}
+
+bool LFUCachePool::erase(int key) {
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) return false;
+    uint32_t b = nodes_[i].bucket;
+    detach(i);
+    releaseBucketIfEmpty(b);
+    index_.erase(key);
+    wheel_.cancel(i);
+    free_.push_back(i);
+    sz_--;
+    notifyEvict(key, nodes_[i].val, EvictReason::Erase);
+    return true;
+}
+
+void LFUCachePool::expire(uint32_t i) {
+    int k = nodes_[i].key;
+    uint32_t b = nodes_[i].bucket;
+    detach(i);
+    releaseBucketIfEmpty(b);
+    index_.erase(k);
+    free_.push_back(i);
+    sz_--;
+    cnt_.expired++;
+    notifyEvict(k, nodes_[i].val, EvictReason::Expired);
+}
+
+void LFUCachePool::advanceTime(uint64_t now) {
+    wheel_.advance(now, [this](uint32_t i) { expire(i); });
+}
+
+void LFUCachePool::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    const size_t payload = sizeof(int) * 3;    // key, val, freq — как у LFUCacheIter::Node
+    theoretical = cap_ * payload;
+    actual = sz_ * payload;
+    overhead = nodes_.capacity() * sizeof(Node) + buckets_.capacity() * sizeof(Bucket)
+             + free_.capacity() * sizeof(uint32_t) + index_.bytes() + wheel_.bytes() - actual;
+}
+
+// См. LRUCacheIter::getMany: поиски пакетом, затем touch.
+// touch обновляет it->second, а сами итераторы pos_ не инвалидирует.
+void LFUCacheIter::getMany(const int* keys, size_t n, std::optional<int>* out) {
+    decltype(pos_)::iterator its[kBatchGroup];
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) {
+            its[i] = pos_.find(keys[base + i]);
+            if (its[i] != pos_.end()) __builtin_prefetch(&*its[i]->second);
+        }
+        for (size_t i = 0; i < m; ++i) {
+            cnt_.gets++;
+            if (its[i] == pos_.end()) { cnt_.misses++; out[base + i] = std::nullopt; continue; }
+            touch(its[i]);
+            cnt_.hits++;
+            out[base + i] = its[i]->second->val;
+        }
+    }
+}
+
+void LFUCacheIter::putMany(const int* keys, const int* values, size_t n) {
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) {
+            auto it = pos_.find(keys[base + i]);
+            if (it != pos_.end()) __builtin_prefetch(&*it->second);
+        }
+        for (size_t i = 0; i < m; ++i) put(keys[base + i], values[base + i]);
+    }
+}
+
+void LFUCachePool::getMany(const int* keys, size_t n, std::optional<int>* out) {
+    uint32_t idx[kBatchGroup];
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) index_.prefetch(keys[base + i]);
+        for (size_t i = 0; i < m; ++i) {
+            idx[i] = index_.find(keys[base + i]);
+            if (idx[i] != FlatIndex::kEmpty) __builtin_prefetch(&nodes_[idx[i]]);
+        }
+        for (size_t i = 0; i < m; ++i) {
+            cnt_.gets++;
+            if (idx[i] == FlatIndex::kEmpty) { cnt_.misses++; out[base + i] = std::nullopt; continue; }
+            touch(idx[i]);
+            cnt_.hits++;
+            out[base + i] = nodes_[idx[i]].val;
+        }
+    }
+}
+
+void LFUCachePool::putMany(const int* keys, const int* values, size_t n) {
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) index_.prefetch(keys[base + i]);
+        for (size_t i = 0; i < m; ++i) put(keys[base + i], values[base + i]);
+    }
+}
+
+// ---- Снимки: записи по возрастанию частоты, внутри частоты — от жертвы ----
+
+namespace {
+// Частотные движки строятся из записей по неубыванию частоты; снимок другой
+// политики (например, CLOCK) сначала устойчиво сортируется в buf
+const SnapshotEntry* byFreq(const SnapshotEntry* e, size_t n, std::vector<SnapshotEntry>& buf) {
+    auto less = [](const SnapshotEntry& a, const SnapshotEntry& b) { return a.freq < b.freq; };
+    if (std::is_sorted(e, e + n, less)) return e;
+    buf.assign(e, e + n);
+    std::stable_sort(buf.begin(), buf.end(), less);
+    return buf.data();
+}
+// В снимке LRU частоты нет (0) — такие записи приходят с частотой 1
+uint32_t freqOf(const SnapshotEntry& e) { return e.freq ? e.freq : 1; }
+}
+
+bool LFUCacheIter::exportEntries(std::vector<SnapshotEntry>& out) const {
+    std::vector<int> freqs;
+    for (const auto& kv : buckets_) freqs.push_back(kv.first);
+    std::sort(freqs.begin(), freqs.end());
+    out.reserve(out.size() + sz_);
+    for (int f : freqs) {
+        const auto& lst = buckets_.at(f);
+        for (auto it = lst.rbegin(); it != lst.rend(); ++it) out.push_back({it->key, it->val, (uint32_t)f});
+    }
+    return true;
+}
+
+void LFUCacheIter::importEntries(const SnapshotEntry* e, size_t n) {
+    std::vector<SnapshotEntry> buf;
+    e = byFreq(e, n, buf);
+    pos_.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        int f = (int)freqOf(e[i]);
+        auto& lst = buckets_[f];
+        lst.push_front(Node{e[i].key, e[i].val, f});
+        pos_[e[i].key] = lst.begin();
+    }
+    sz_ = n;
+    minFreq_ = n ? freqOf(e[0]) : 0;
+}
+
+bool LFUCacheRec::exportEntries(std::vector<SnapshotEntry>& out) const {
+    out.reserve(out.size() + sz_);
+    for (const Node* x = sentinel_.next; x; x = x->next) out.push_back({x->key, x->val, (uint32_t)x->freq});
+    return true;
+}
+
+void LFUCacheRec::importEntries(const SnapshotEntry* e, size_t n) {
+    std::vector<SnapshotEntry> buf;
+    e = byFreq(e, n, buf);
+    Node* tail = &sentinel_;
+    for (size_t i = 0; i < n; ++i) {
+        int f = (int)freqOf(e[i]);
+        Node* x = new Node{e[i].key, e[i].val, f, nullptr};
+        allocations_++;
+        tail->next = x;
+        if (pred_) pred_->insert(x->key, tail);
+        if (last_) { if (last_->find(f)) last_->assign(f, x); else openRun(f, x); }
+        tail = x;
+    }
+    sz_ = n;
+}
+
+bool LFUCachePool::exportEntries(std::vector<SnapshotEntry>& out) const {
+    out.reserve(out.size() + sz_);
+    for (uint32_t b = minBucket_; b != kNil; b = buckets_[b].next)
+        for (uint32_t i = buckets_[b].tail; i != kNil; i = nodes_[i].prev)
+            out.push_back({nodes_[i].key, nodes_[i].val, buckets_[b].freq});
+    return true;
+}
+
+// Запись i снимка ложится в слот i, узел частоты заводится на каждой смене freq
+void LFUCachePool::importEntries(const SnapshotEntry* e, size_t n) {
+    std::vector<SnapshotEntry> buf;
+    e = byFreq(e, n, buf);
+    uint32_t b = kNil;
+    for (uint32_t i = 0; i < n; ++i) {
+        uint32_t f = freqOf(e[i]);
+        if (b == kNil || buckets_[b].freq != f) b = allocBucket(f, b);
+        nodes_[i].key = e[i].key;
+        nodes_[i].val = e[i].val;
+        attachFront(i, b);
+        index_.insert(e[i].key, i);
+    }
+    sz_ = (uint32_t)n;
 }
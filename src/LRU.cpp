@@ -1,9 +1,10 @@
 #include "LRU.h"
 #include "CacheBase.h"
+#include <algorithm>
 
 LRUCacheIter::LRUCacheIter(size_t cap) : cap_(cap) {}
 
-void LRUCacheIter::touch(std::unordered_map<int, std::list<Node>::iterator>::iterator it) {
+void LRUCacheIter::touch(TrackedHashMap<int, TrackedList<Node>::iterator>::iterator it) {
     auto nodeIt = it->second;
     order_.splice(order_.begin(), order_, nodeIt);
 }
@@ -31,12 +32,22 @@ void LRUCacheIter::put(int key, int value) {
         pos_.erase(k);
         order_.pop_back();
         cnt_.evictions++;
-        if (g_on_evict_key) g_on_evict_key(k);
+        notifyEvict(k, v, EvictReason::Capacity);
     }
     order_.emplace_front(key, value);
     pos_[key] = order_.begin();
 }
 
+bool LRUCacheIter::erase(int key) {
+    auto it = pos_.find(key);
+    if (it == pos_.end()) return false;
+    int v = it->second->second;
+    order_.erase(it->second);
+    pos_.erase(it);
+    notifyEvict(key, v, EvictReason::Erase);
+    return true;
+}
+
 void LRUCacheIter::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
     theoretical = cap_ * sizeof(Node);
     actual = order_.size() * sizeof(Node);
@@ -45,64 +56,302 @@ void LRUCacheIter::estimateMemory(size_t& theoretical, size_t& actual, size_t& o
     overhead = list_over + map_over;
 }
 
-LRUCacheRec::LRUCacheRec(size_t cap) : cap_(cap) {}
-LRUCacheRec::~LRUCacheRec(){ freeList(head_); }
+LRUCacheRec::LRUCacheRec(size_t cap, RecMode mode) : cap_(cap) {
+    if (mode == RecMode::Indexed) pred_.emplace(cap);
+}
+LRUCacheRec::~LRUCacheRec(){ freeList(sentinel_.next); }
+
+void LRUCacheRec::freeList(Node* n) {
+    while (n) { Node* next = n->next; delete n; deallocations_++; n = next; }
+}
 
-void LRUCacheRec::freeList(Node* n){ if(!n) return; freeList(n->next); delete n; deallocations_++; }
+// Узел перед ключом (&sentinel_ для головы) или nullptr, если ключа нет
+LRUCacheRec::Node* LRUCacheRec::findPrev(int key) {
+    if (pred_) return pred_->find(key);
+    for (Node* p = &sentinel_; p->next; p = p->next)
+        if (p->next->key == key) return p;
+    return nullptr;
+}
+
+void LRUCacheRec::unlink(Node* prev, Node* x) {
+    prev->next = x->next;
+    if (x->next) { if (pred_) pred_->assign(x->next->key, prev); }
+    else tail_ = (prev == &sentinel_) ? nullptr : prev;
+}
+
+void LRUCacheRec::pushFront(Node* x) {
+    x->next = sentinel_.next;
+    if (x->next) { if (pred_) pred_->assign(x->next->key, x); }
+    else tail_ = x;
+    sentinel_.next = x;
+}
+
+void LRUCacheRec::moveToFront(Node* prev, Node* x) {
+    if (prev == &sentinel_) return;
+    unlink(prev, x);
+    pushFront(x);
+    if (pred_) pred_->assign(x->key, &sentinel_);
+}
+
+void LRUCacheRec::evictTail() {
+    Node* x = tail_;
+    Node* prev = &sentinel_;
+    if (pred_) { prev = pred_->find(x->key); pred_->erase(x->key); }
+    else while (prev->next != x) prev = prev->next;
+    unlink(prev, x);
+    notifyEvict(x->key, x->val, EvictReason::Capacity);
+    delete x; deallocations_++;
+    cnt_.evictions++; sz_--;
+}
 
 std::optional<int> LRUCacheRec::get(int key) {
     cnt_.gets++;
-    auto r = getRec(nullptr, head_, key);
-    if (r) cnt_.hits++; else cnt_.misses++;
-    return r;
+    Node* prev = findPrev(key);
+    if (!prev) { cnt_.misses++; return std::nullopt; }
+    Node* x = prev->next;
+    moveToFront(prev, x);
+    cnt_.hits++;
+    return x->val;
 }
 
-std::optional<int> LRUCacheRec::getRec(Node* prev, Node* cur, int key) {
-    if (!cur) return std::nullopt;
-    if (cur->key == key) {
-        if (prev) { prev->next = cur->next; cur->next = head_; head_ = cur; }
-        return cur->val;
+void LRUCacheRec::put(int key, int value) {
+    cnt_.puts++;
+    if (Node* prev = findPrev(key)) {
+        Node* x = prev->next;
+        x->val = value;
+        moveToFront(prev, x);
+        return;
     }
-    return getRec(cur, cur->next, key);
+    if (cap_ == 0) return;
+    if (sz_ == cap_) evictTail();
+    Node* n = new Node{key, value, nullptr};
+    allocations_++;
+    pushFront(n);
+    if (pred_) pred_->insert(key, &sentinel_);
+    sz_++;
 }
 
-void LRUCacheRec::put(int key, int value) {
+bool LRUCacheRec::erase(int key) {
+    Node* prev = findPrev(key);
+    if (!prev) return false;
+    Node* x = prev->next;
+    unlink(prev, x);
+    if (pred_) pred_->erase(key);
+    notifyEvict(x->key, x->val, EvictReason::Erase);
+    delete x; deallocations_++; sz_--;
+    return true;
+}
+
+void LRUCacheRec::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    theoretical = cap_ * sizeof(Node);
+    actual = sz_ * sizeof(Node);
+    overhead = sz_ * sizeof(void*) + (pred_ ? pred_->bytes() : 0);
+}
+
+LRUCacheFlat::LRUCacheFlat(size_t cap) : cap_(cap), nodes_(cap), index_(cap), wheel_(cap) { free_.reserve(cap); }
+
+void LRUCacheFlat::unlink(uint32_t i) {
+    Node& n = nodes_[i];
+    if (n.prev != kNil) nodes_[n.prev].next = n.next; else head_ = n.next;
+    if (n.next != kNil) nodes_[n.next].prev = n.prev; else tail_ = n.prev;
+}
+
+void LRUCacheFlat::pushFront(uint32_t i) {
+    Node& n = nodes_[i];
+    n.prev = kNil;
+    n.next = head_;
+    if (head_ != kNil) nodes_[head_].prev = i; else tail_ = i;
+    head_ = i;
+}
+
+std::optional<int> LRUCacheFlat::get(int key) {
+    cnt_.gets++;
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) { cnt_.misses++; return std::nullopt; }
+    if (i != head_) { unlink(i); pushFront(i); }
+    cnt_.hits++;
+    return nodes_[i].val;
+}
+
+void LRUCacheFlat::put(int key, int value, uint32_t ttl) {
     cnt_.puts++;
-    if (putUpdateRec(nullptr, head_, key, value)) return;
     if (cap_ == 0) return;
+    uint32_t i = index_.find(key);
+    if (i != FlatIndex::kEmpty) {
+        nodes_[i].val = value;
+        if (i != head_) { unlink(i); pushFront(i); }
+        if (ttl) wheel_.schedule(i, wheel_.now() + ttl); else wheel_.cancel(i);
+        return;
+    }
     if (sz_ == cap_) {
-        bool removed = false;
-        head_ = removeTailRec(head_, removed);
-        if (removed && sz_>0) { cnt_.evictions++; sz_--; }
+        // Слот вытесняемого хвоста переиспользуется под новый ключ
+        i = tail_;
+        int k = nodes_[i].key;
+        unlink(i);
+        index_.erase(k);
+        wheel_.cancel(i);
+        cnt_.evictions++;
+        notifyEvict(k, nodes_[i].val, EvictReason::Capacity);
+    } else if (!free_.empty()) {
+        i = free_.back(); free_.pop_back(); sz_++;
+    } else {
+        i = sz_++;
     }
-    Node* n = new Node{key, value, head_};
-    allocations_++;
-    head_ = n;
-    sz_++;
+    nodes_[i].key = key;
+    nodes_[i].val = value;
+    pushFront(i);
+    index_.insert(key, i);
+    if (ttl) wheel_.schedule(i, wheel_.now() + ttl);
+}
+
+bool LRUCacheFlat::erase(int key) {
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) return false;
+    unlink(i);
+    index_.erase(key);
+    wheel_.cancel(i);
+    free_.push_back(i);
+    sz_--;
+    notifyEvict(key, nodes_[i].val, EvictReason::Erase);
+    return true;
+}
+
+void LRUCacheFlat::expire(uint32_t i) {
+    int k = nodes_[i].key;
+    unlink(i);
+    index_.erase(k);
+    free_.push_back(i);
+    sz_--;
+    cnt_.expired++;
+    notifyEvict(k, nodes_[i].val, EvictReason::Expired);
 }
 
-bool LRUCacheRec::putUpdateRec(Node* prev, Node* cur, int key, int value) {
-    if (!cur) return false;
-    if (cur->key == key) {
-        cur->val = value;
-        if (prev) { prev->next = cur->next; cur->next = head_; head_ = cur; }
-        return true;
+void LRUCacheFlat::advanceTime(uint64_t now) {
+    wheel_.advance(now, [this](uint32_t i) { expire(i); });
+}
+
+void LRUCacheFlat::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    // Реальный след: весь массив узлов + таблица индекса, выделенные заранее
+    const size_t payload = sizeof(int) * 2;
+    theoretical = cap_ * payload;
+    actual = sz_ * payload;
+    overhead = nodes_.capacity() * sizeof(Node) + free_.capacity() * sizeof(uint32_t) + index_.bytes()
+             + wheel_.bytes() - actual;
+}
+
+// Пакет: сначала все поиски (они независимы и перекрываются в памяти),
+// с предвыборкой узлов списка, затем перестановки. get не удаляет узлы,
+// поэтому найденные итераторы остаются валидными.
+void LRUCacheIter::getMany(const int* keys, size_t n, std::optional<int>* out) {
+    decltype(pos_)::iterator its[kBatchGroup];
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) {
+            its[i] = pos_.find(keys[base + i]);
+            if (its[i] != pos_.end()) __builtin_prefetch(&*its[i]->second);
+        }
+        for (size_t i = 0; i < m; ++i) {
+            cnt_.gets++;
+            if (its[i] == pos_.end()) { cnt_.misses++; out[base + i] = std::nullopt; continue; }
+            touch(its[i]);
+            cnt_.hits++;
+            out[base + i] = its[i]->second->second;
+        }
     }
-    return putUpdateRec(cur, cur->next, key, value);
 }
 
-LRUCacheRec::Node* LRUCacheRec::removeTailRec(Node* cur, bool& removed) {
-    if (!cur) { removed = false; return nullptr; }
-    if (!cur->next) {
-        if (g_on_evict_key) g_on_evict_key(cur->key);
-        delete cur; deallocations_++; removed = true; return nullptr;
+// put может вытеснить узел, найденный для соседнего ключа, поэтому первый
+// проход только прогревает бакеты и узлы, а вставки идут обычным put.
+void LRUCacheIter::putMany(const int* keys, const int* values, size_t n) {
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) {
+            auto it = pos_.find(keys[base + i]);
+            if (it != pos_.end()) __builtin_prefetch(&*it->second);
+        }
+        for (size_t i = 0; i < m; ++i) put(keys[base + i], values[base + i]);
     }
-    cur->next = removeTailRec(cur->next, removed);
-    return cur;
 }
 
-void LRUCacheRec::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
-    theoretical = cap_ * sizeof(Node);
-    actual = sz_ * sizeof(Node);
-    overhead = sz_ * sizeof(void*);
+void LRUCacheFlat::getMany(const int* keys, size_t n, std::optional<int>* out) {
+    uint32_t idx[kBatchGroup];
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) index_.prefetch(keys[base + i]);
+        for (size_t i = 0; i < m; ++i) {
+            idx[i] = index_.find(keys[base + i]);
+            if (idx[i] != FlatIndex::kEmpty) __builtin_prefetch(&nodes_[idx[i]]);
+        }
+        for (size_t i = 0; i < m; ++i) {
+            cnt_.gets++;
+            uint32_t j = idx[i];
+            if (j == FlatIndex::kEmpty) { cnt_.misses++; out[base + i] = std::nullopt; continue; }
+            if (j != head_) { unlink(j); pushFront(j); }
+            cnt_.hits++;
+            out[base + i] = nodes_[j].val;
+        }
+    }
+}
+
+void LRUCacheFlat::putMany(const int* keys, const int* values, size_t n) {
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) index_.prefetch(keys[base + i]);
+        for (size_t i = 0; i < m; ++i) put(keys[base + i], values[base + i]);
+    }
+}
+
+// ---- Снимки: записи от хвоста (жертвы) к голове ----
+
+bool LRUCacheIter::exportEntries(std::vector<SnapshotEntry>& out) const {
+    out.reserve(out.size() + order_.size());
+    for (auto it = order_.rbegin(); it != order_.rend(); ++it) out.push_back({it->first, it->second, 0});
+    return true;
+}
+
+void LRUCacheIter::importEntries(const SnapshotEntry* e, size_t n) {
+    pos_.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        order_.emplace_front(e[i].key, e[i].val);
+        pos_[e[i].key] = order_.begin();
+    }
+}
+
+bool LRUCacheRec::exportEntries(std::vector<SnapshotEntry>& out) const {
+    size_t from = out.size();
+    out.reserve(from + sz_);
+    for (const Node* x = sentinel_.next; x; x = x->next) out.push_back({x->key, x->val, 0});
+    std::reverse(out.begin() + from, out.end());
+    return true;
+}
+
+void LRUCacheRec::importEntries(const SnapshotEntry* e, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        Node* x = new Node{e[i].key, e[i].val, nullptr};
+        allocations_++;
+        pushFront(x);
+        if (pred_) pred_->insert(x->key, &sentinel_);
+    }
+    sz_ = n;
+}
+
+bool LRUCacheFlat::exportEntries(std::vector<SnapshotEntry>& out) const {
+    out.reserve(out.size() + sz_);
+    for (uint32_t i = tail_; i != kNil; i = nodes_[i].prev) out.push_back({nodes_[i].key, nodes_[i].val, 0});
+    return true;
+}
+
+// Запись i снимка ложится в слот i: слоты идут подряд, связи — соседние индексы
+void LRUCacheFlat::importEntries(const SnapshotEntry* e, size_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        Node& x = nodes_[i];
+        x.key = e[i].key;
+        x.val = e[i].val;
+        x.next = i ? i - 1 : kNil;
+        x.prev = (i + 1 < n) ? i + 1 : kNil;
+        index_.insert(x.key, i);
+    }
+    sz_ = (uint32_t)n;
+    tail_ = n ? 0 : kNil;
+    head_ = n ? (uint32_t)n - 1 : kNil;
 }
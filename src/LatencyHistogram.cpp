@@ -0,0 +1,57 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <thread>
+
+double latencyNsPerTick() {
+#if defined(__x86_64__) || defined(__i386__)
+    // 20 мс ожидания хватает на точность лучше 0.1% при любой частоте TSC
+    static const double ns_per_tick = [] {
+        using SC = std::chrono::steady_clock;
+        auto t0 = SC::now();
+        uint64_t c0 = latencyTicks();
+        while (SC::now() - t0 < std::chrono::milliseconds(20)) std::this_thread::yield();
+        uint64_t c1 = latencyTicks();
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(SC::now() - t0).count();
+        return c1 > c0 ? ns / (double)(c1 - c0) : 1.0;
+    }();
+    return ns_per_tick;
+#else
+    return 1.0;
+#endif
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& o) {
+    for (int i = 0; i < kBuckets; ++i) counts_[i] += o.counts_[i];
+    total_ += o.total_;
+    sum_ += o.sum_;
+    min_ = std::min(min_, o.min_);
+    max_ = std::max(max_, o.max_);
+}
+
+void LatencyHistogram::reset() {
+    std::fill(counts_.begin(), counts_.end(), 0);
+    total_ = sum_ = max_ = 0;
+    min_ = UINT64_MAX;
+}
+
+uint64_t LatencyHistogram::valueAt(double q) const {
+    if (total_ == 0) return 0;
+    uint64_t rank = (uint64_t)std::max(1.0, q * (double)total_ + 0.5);
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += counts_[i];
+        if (seen >= rank) return std::min(bucketHigh(i), max_);
+    }
+    return max_;
+}
+
+LatencySummary summarizeLatency(const LatencyHistogram& h) {
+    double k = latencyNsPerTick();
+    LatencySummary s;
+    s.samples = (long long)h.count();
+    s.p50_ns  = h.valueAt(0.50) * k;
+    s.p99_ns  = h.valueAt(0.99) * k;
+    s.p999_ns = h.valueAt(0.999) * k;
+    s.max_ns  = h.max() * k;
+    return s;
+}
@@ -0,0 +1,141 @@
+#include "MissRatioCurve.h"
+#include "CacheT.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+
+namespace {
+constexpr uint64_t kSampleModulus = 1u << 24;
+constexpr uint32_t kMinSlots = 1024;
+}
+
+StackDistanceMRC::StackDistanceMRC(double sample_rate)
+    : rate_(std::min(1.0, std::max(sample_rate, 1.0 / kSampleModulus))),
+      threshold_((uint64_t)(rate_ * kSampleModulus)),
+      tree_(kMinSlots + 1, 0), slotKey_(kMinSlots, 0), alive_(kMinSlots, 0), last_(kMinSlots) {}
+
+void StackDistanceMRC::add(uint32_t slot, int delta) {
+    for (uint32_t i = slot + 1; i < tree_.size(); i += i & (0u - i)) tree_[i] += delta;
+}
+
+uint32_t StackDistanceMRC::prefix(uint32_t slot) const {
+    uint32_t s = 0;
+    for (uint32_t i = slot; i > 0; i -= i & (0u - i)) s += tree_[i];
+    return s;
+}
+
+// Живые слоты по порядку получают номера 0..live-1; места после перенумерации —
+// не меньше двух на ключ, чтобы компакции шли редко. Порядок последних обращений
+// сохраняется, поэтому расстояния не меняются.
+void StackDistanceMRC::compact() {
+    uint32_t live = 0;
+    for (uint32_t s = 0; s < now_; ++s) {
+        if (!alive_[s]) continue;
+        int key = slotKey_[s];
+        slotKey_[live] = key;
+        last_.assign(key, live);
+        live++;
+    }
+
+    uint32_t slots = kMinSlots;
+    while (slots < (size_t)live * 2) slots <<= 1;
+    slotKey_.resize(slots);
+    alive_.assign(slots, 0);
+    std::fill(alive_.begin(), alive_.begin() + live, 1);
+    tree_.assign(slots + 1, 0);
+    std::fill(tree_.begin() + 1, tree_.begin() + 1 + live, 1);
+    // Построение дерева Фенвика за O(n) из массива единиц
+    for (uint32_t i = 1; i <= slots; ++i) {
+        uint32_t parent = i + (i & (0u - i));
+        if (parent <= slots) tree_[parent] += tree_[i];
+    }
+    now_ = live;
+}
+
+void StackDistanceMRC::growIndex() {
+    FlatIndex bigger(last_.capacity() * 2);
+    last_.forEach([&](int key, uint32_t slot) { bigger.insert(key, slot); });
+    last_ = std::move(bigger);
+}
+
+void StackDistanceMRC::access(int key) {
+    accesses_++;
+    if (rate_ < 1.0 && (mix64((uint64_t)(uint32_t)key) & (kSampleModulus - 1)) >= threshold_) return;
+    sampled_++;
+
+    if (now_ == slotKey_.size()) compact();
+    uint32_t prev = last_.find(key);
+    if (prev != FlatIndex::kEmpty) {
+        // Все живые отметки лежат левее now_, их ровно distinct_
+        uint64_t d = distinct_ - prefix(prev + 1);
+        if (d >= hist_.size()) hist_.resize(std::max<size_t>(d + 1, hist_.size() * 2), 0);
+        hist_[d]++;
+        add(prev, -1);
+        alive_[prev] = 0;
+        last_.assign(key, now_);
+    } else {
+        if (distinct_ == last_.capacity()) growIndex();
+        last_.insert(key, now_);
+        distinct_++;
+    }
+    slotKey_[now_] = key;
+    alive_[now_] = 1;
+    add(now_, +1);
+    now_++;
+}
+
+std::vector<double> StackDistanceMRC::hitRates(const std::vector<size_t>& caps) const {
+    // В режиме SHARDS в знаменателе — ожидаемое число выбранных обращений,
+    // а разница с фактическим идёт в расстояние 0 (SHARDS-adj)
+    double expected = rate_ < 1.0 ? accesses_ * rate_ : (double)sampled_;
+    double adjust = expected - (double)sampled_;
+
+    std::vector<size_t> order(caps.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return caps[a] < caps[b]; });
+
+    std::vector<double> out(caps.size(), 0.0);
+    double hits = adjust;
+    size_t d = 0;
+    for (size_t idx : order) {
+        // Расстояние d в выборке соответствует d / rate в полном потоке
+        size_t limit = rate_ < 1.0 ? (size_t)std::ceil(caps[idx] * rate_) : caps[idx];
+        for (; d < limit && d < hist_.size(); ++d) hits += (double)hist_[d];
+        out[idx] = expected > 0 ? std::max(0.0, hits) / expected * 100.0 : 0.0;
+    }
+    return out;
+}
+
+size_t StackDistanceMRC::bytes() const {
+    return tree_.size() * sizeof(uint32_t) + slotKey_.size() * sizeof(int) + alive_.size()
+         + hist_.size() * sizeof(uint64_t)
+         + last_.bytes();
+}
+
+void FrequencyMRC::access(int key) {
+    accesses_++;
+    uint32_t i = index_.find(key);
+    if (i != FlatIndex::kEmpty) { counts_[i]++; return; }
+    if (counts_.size() == index_.capacity()) {
+        FlatIndex bigger(index_.capacity() * 2);
+        index_.forEach([&](int k, uint32_t v) { bigger.insert(k, v); });
+        index_ = std::move(bigger);
+    }
+    index_.insert(key, (uint32_t)counts_.size());
+    counts_.push_back(1);
+}
+
+std::vector<double> FrequencyMRC::hitRates(const std::vector<size_t>& caps) const {
+    std::vector<uint32_t> c = counts_;
+    std::sort(c.begin(), c.end(), std::greater<uint32_t>());
+
+    std::vector<uint64_t> cum(c.size() + 1, 0);
+    for (size_t i = 0; i < c.size(); ++i) cum[i + 1] = cum[i] + (c[i] - 1);
+
+    std::vector<double> out;
+    out.reserve(caps.size());
+    for (size_t cap : caps)
+        out.push_back(accesses_ ? (double)cum[std::min(cap, c.size())] / accesses_ * 100.0 : 0.0);
+    return out;
+}
@@ -0,0 +1,97 @@
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+struct EventSpec { uint32_t type; uint64_t config; };
+
+constexpr uint64_t cacheMiss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+const EventSpec kSpecs[kPerfEventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D)},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB)},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS_MIN},
+};
+
+int openEvent(const EventSpec& spec) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type;
+    attr.config = spec.config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+    for (int e = 0; e < kPerfEventCount; ++e) fd_[e] = openEvent(kSpecs[e]);
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fd_) if (fd >= 0) close(fd);
+}
+
+void PerfCounters::start() {
+    for (int fd : fd_) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample s;
+    for (int fd : fd_) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    for (int e = 0; e < kPerfEventCount; ++e) {
+        uint64_t buf[3] = {0, 0, 0};   // value, time_enabled, time_running
+        if (fd_[e] < 0 || read(fd_[e], buf, sizeof(buf)) != (ssize_t)sizeof(buf) || buf[2] == 0) continue;
+        s.value[e] = (double)buf[0] * ((double)buf[1] / (double)buf[2]);
+        s.valid[e] = true;
+    }
+    return s;
+}
+
+#else
+
+PerfCounters::PerfCounters() { fd_.fill(-1); }
+PerfCounters::~PerfCounters() = default;
+void PerfCounters::start() {}
+PerfSample PerfCounters::stop() { return PerfSample{}; }
+
+#endif
+
+int PerfCounters::available() const {
+    int n = 0;
+    for (int fd : fd_) n += fd >= 0;
+    return n;
+}
+
+const char* PerfCounters::name(int event) {
+    static const char* const kNames[kPerfEventCount] = {
+        "cycles", "instructions", "L1D misses", "LLC misses", "branch misses", "dTLB misses", "page faults"};
+    return event >= 0 && event < kPerfEventCount ? kNames[event] : "?";
+}
+
+void writePerfColumns(std::ostream& out, const PerfSample& s, long long ops) {
+    for (int e = 0; e < kPerfEventCount; ++e) {
+        out << ",";
+        if (s.valid[e] && ops > 0) out << s.value[e] / (double)ops;
+    }
+}
@@ -0,0 +1,101 @@
+#include "ReadThrough.h"
+#include "CacheT.h"
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace {
+// Равномерное в (0, 1) из 53 старших бит
+inline double unit(uint64_t x) { return ((x >> 11) + 0.5) * (1.0 / 9007199254740992.0); }
+}
+
+long long SimulatedBackend::sampleNs() {
+    uint64_t n = calls_.fetch_add(1, std::memory_order_relaxed);
+    double mean_ns = spec_.mean_us * 1000.0;
+    uint64_t r = mix64(spec_.seed + n * 0x9E3779B97F4A7C15ull);
+    switch (spec_.dist) {
+    case BackendLatency::Fixed:
+        return (long long)mean_ns;
+    case BackendLatency::Exponential:
+        return (long long)(-std::log(unit(r)) * mean_ns);
+    case BackendLatency::LogNormal: {
+        // Бокс — Мюллер; mu подобрано так, чтобы среднее было mean_ns
+        double z = std::sqrt(-2.0 * std::log(unit(r))) * std::cos(6.283185307179586 * unit(mix64(r)));
+        double mu = std::log(mean_ns) - spec_.sigma * spec_.sigma / 2.0;
+        return (long long)std::exp(mu + spec_.sigma * z);
+    }
+    }
+    return 0;
+}
+
+int SimulatedBackend::load(int key) {
+    using Clock = std::chrono::steady_clock;
+    long long ns = sampleNs();
+    auto t0 = Clock::now();
+    auto until = t0 + std::chrono::nanoseconds(ns);
+    if (spec_.sleep) std::this_thread::sleep_until(until);
+    else while (Clock::now() < until) {}
+    busy_ns_.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count(),
+                       std::memory_order_relaxed);
+    loads_.fetch_add(1, std::memory_order_relaxed);
+    return key * 10;
+}
+
+ReadThroughCache::ReadThroughCache(ICache& cache, Loader loader, bool single_flight)
+    : cache_(cache), loader_(std::move(loader)), single_flight_(single_flight) {}
+
+int ReadThroughCache::loadAndPut(int key) {
+    loads_.fetch_add(1, std::memory_order_relaxed);
+    int v = loader_(key);
+    cache_.put(key, v);
+    return v;
+}
+
+int ReadThroughCache::get(int key) {
+    if (auto v = cache_.get(key)) { hits_.fetch_add(1, std::memory_order_relaxed); return *v; }
+    if (!single_flight_) return loadAndPut(key);
+
+    std::shared_ptr<Flight> f;
+    bool leader = false;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto& slot = flights_[key];
+        if (!slot) { slot = std::make_shared<Flight>(); leader = true; }
+        f = slot;
+    }
+    if (!leader) {
+        coalesced_.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock<std::mutex> lock(f->mu);
+        f->cv.wait(lock, [&] { return f->done; });
+        if (f->error) std::rethrow_exception(f->error);
+        return f->value;
+    }
+
+    // Значение кладётся в кэш до снятия полёта. Повторно загрузит ключ только поток,
+    // промахнувшийся в кэше до put и дошедший до flights_ после erase, — окно узкое,
+    // а перепроверка кэша стоила бы лишнего get каждому загружающему
+    int v = 0;
+    std::exception_ptr error;
+    try { v = loadAndPut(key); } catch (...) { error = std::current_exception(); }
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        flights_.erase(key);
+    }
+    {
+        std::lock_guard<std::mutex> lock(f->mu);
+        f->value = v;
+        f->error = error;
+        f->done = true;
+    }
+    f->cv.notify_all();
+    if (error) std::rethrow_exception(error);
+    return v;
+}
+
+ReadThroughStats ReadThroughCache::stats() const {
+    ReadThroughStats s;
+    s.hits = hits_.load(std::memory_order_relaxed);
+    s.loads = loads_.load(std::memory_order_relaxed);
+    s.coalesced = coalesced_.load(std::memory_order_relaxed);
+    return s;
+}
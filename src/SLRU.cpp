@@ -0,0 +1,76 @@
+#include "SLRU.h"
+
+SLRUCache::SLRUCache(size_t cap, double protectedShare)
+    : cap_(cap), protectedCap_((uint32_t)(cap * protectedShare)), nodes_(cap), index_(cap) {
+    free_.reserve(cap);
+    for (size_t i = cap; i > 0; --i) free_.push_back((uint32_t)(i - 1));
+}
+
+void SLRUCache::onHit(uint32_t i) {
+    Node& n = nodes_[i];
+    if (n.prot) { protected_.moveToFront(nodes_, i); return; }
+    probation_.unlink(nodes_, i);
+    n.prot = true;
+    protected_.pushFront(nodes_, i);
+    if (protected_.size > protectedCap_) {
+        // Хвост protected получает второй шанс в начале probation
+        uint32_t d = protected_.tail;
+        protected_.unlink(nodes_, d);
+        nodes_[d].prot = false;
+        probation_.pushFront(nodes_, d);
+    }
+}
+
+std::optional<int> SLRUCache::get(int key) {
+    cnt_.gets++;
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) { cnt_.misses++; return std::nullopt; }
+    onHit(i);
+    cnt_.hits++;
+    return nodes_[i].val;
+}
+
+void SLRUCache::put(int key, int value) {
+    cnt_.puts++;
+    if (cap_ == 0) return;
+    uint32_t i = index_.find(key);
+    if (i != FlatIndex::kEmpty) { nodes_[i].val = value; onHit(i); return; }
+    if (sz_ == cap_) {
+        uint32_t v = !probation_.empty() ? probation_.tail : protected_.tail;
+        Node& victim = nodes_[v];
+        (victim.prot ? protected_ : probation_).unlink(nodes_, v);
+        index_.erase(victim.key);
+        free_.push_back(v);
+        sz_--;
+        cnt_.evictions++;
+        notifyEvict(victim.key, victim.val, EvictReason::Capacity);
+    }
+    i = free_.back();
+    free_.pop_back();
+    nodes_[i].key = key;
+    nodes_[i].val = value;
+    nodes_[i].prot = false;
+    probation_.pushFront(nodes_, i);
+    index_.insert(key, i);
+    sz_++;
+}
+
+bool SLRUCache::erase(int key) {
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) return false;
+    Node& n = nodes_[i];
+    (n.prot ? protected_ : probation_).unlink(nodes_, i);
+    index_.erase(key);
+    free_.push_back(i);
+    sz_--;
+    notifyEvict(key, n.val, EvictReason::Erase);
+    return true;
+}
+
+void SLRUCache::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    const size_t payload = sizeof(int) * 2;
+    theoretical = cap_ * payload;
+    actual = sz_ * payload;
+    overhead = nodes_.capacity() * sizeof(Node) + free_.capacity() * sizeof(uint32_t)
+             + index_.bytes() - actual;
+}
@@ -0,0 +1,209 @@
+#include "SetAssoc.h"
+#include "FlatIndex.h"
+#include <algorithm>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SETASSOC_X86 1
+#endif
+
+namespace {
+// Маска путей (бит i — ways[i] == key); ключи набора выровнены на 64 байта
+uint32_t matchScalar(const int* k, int key, int ways) {
+    uint32_t m = 0;
+    for (int i = 0; i < ways; ++i) m |= (uint32_t)(k[i] == key) << i;
+    return m;
+}
+
+#ifdef SETASSOC_X86
+uint32_t matchSSE2(const int* k, int key, int ways) {
+    __m128i needle = _mm_set1_epi32(key);
+    uint32_t m = 0;
+    for (int i = 0; i < ways; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(k + i)), needle);
+        m |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(eq)) << i;
+    }
+    return m;
+}
+
+__attribute__((target("avx2")))
+uint32_t matchAVX2(const int* k, int key, int ways) {
+    __m256i needle = _mm256_set1_epi32(key);
+    uint32_t m = 0;
+    for (int i = 0; i < ways; i += 8) {
+        __m256i eq = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i*>(k + i)), needle);
+        m |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(eq)) << i;
+    }
+    return m;
+}
+#endif
+}
+
+SimdLevel detectSimd() {
+#ifdef SETASSOC_X86
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    return SimdLevel::SSE2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char* simdName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::SSE2:   return "sse2";
+    case SimdLevel::AVX2:   return "avx2";
+    }
+    return "?";
+}
+
+SetAssocCache::SetAssocCache(size_t cap, int ways, SetPolicy policy, SimdLevel simd)
+    : cap_(cap), ways_(ways == 16 ? 16 : 8), shift_(ways_ == 16 ? 4 : 3), policy_(policy),
+      simd_(std::min(simd, detectSimd())) {
+    sets_ = (uint32_t)std::max<size_t>(1, (cap + ways_ - 1) / ways_);
+    size_t rest = cap - (size_t)(sets_ - 1) * ways_;
+    lastMask_ = cap ? (uint32_t)((1ull << rest) - 1) : 0;
+    lines_.resize((size_t)sets_ * ways_ / 8);
+    valid_.assign(sets_, 0);
+    if (policy_ == SetPolicy::PLRU) plru_.assign(sets_, 0);
+    else freq_.assign((size_t)sets_ * ways_, 0);
+}
+
+// Набор — по старшим битам хеша, умножением (число наборов не обязано быть степенью 2)
+uint32_t SetAssocCache::setOf(int key) const {
+    return (uint32_t)(((uint64_t)FlatIndex::mix(key) * sets_) >> 32);
+}
+
+uint32_t SetAssocCache::match(uint32_t s, int key) const {
+    const int* k = keysOf(s);
+    uint32_t m;
+    switch (simd_) {
+#ifdef SETASSOC_X86
+    case SimdLevel::AVX2: m = matchAVX2(k, key, ways_); break;
+    case SimdLevel::SSE2: m = matchSSE2(k, key, ways_); break;
+#endif
+    default:              m = matchScalar(k, key, ways_); break;
+    }
+    return m & valid_[s];
+}
+
+// Дерево псевдо-LRU: узел i (корень 1, дети 2i и 2i+1), бит 0 — жертва слева.
+// Обращение разворачивает биты на пути от корня так, чтобы они смотрели от пути w.
+void SetAssocCache::touch(uint32_t s, int w) {
+    if (policy_ == SetPolicy::PLRU) {
+        uint16_t bits = plru_[s];
+        for (int level = shift_ - 1, node = 1; level >= 0; --level) {
+            int right = (w >> level) & 1;
+            if (right) bits &= (uint16_t)~(1u << node); else bits |= (uint16_t)(1u << node);
+            node = node * 2 + right;
+        }
+        plru_[s] = bits;
+        return;
+    }
+    uint8_t* f = &freq_[(size_t)s * ways_];
+    if (f[w] < kFreqMax) { f[w]++; return; }
+    // Насыщение: все счётчики набора пополам — старые частоты постепенно забываются
+    for (int i = 0; i < ways_; ++i) f[i] >>= 1;
+    f[w]++;
+}
+
+void SetAssocCache::onInsert(uint32_t s, int w) {
+    if (policy_ == SetPolicy::PLRU) touch(s, w);
+    else freq_[(size_t)s * ways_ + w] = 1;
+}
+
+int SetAssocCache::victim(uint32_t s) const {
+    if (policy_ == SetPolicy::PLRU) {
+        uint16_t bits = plru_[s];
+        int node = 1;
+        for (int level = 0; level < shift_; ++level) node = node * 2 + ((bits >> node) & 1);
+        int w = node - ways_;
+        // В неполном последнем наборе дерево может указать на закрытый путь
+        uint32_t open = openMask(s);
+        return (open >> w) & 1 ? w : __builtin_ctz(open);
+    }
+    const uint8_t* f = &freq_[(size_t)s * ways_];
+    uint32_t open = openMask(s);
+    int best = -1;
+    for (int i = 0; i < ways_; ++i)
+        if (((open >> i) & 1) && (best < 0 || f[i] < f[best])) best = i;
+    return best;
+}
+
+std::optional<int> SetAssocCache::get(int key) {
+    cnt_.gets++;
+    uint32_t s = setOf(key);
+    uint32_t m = match(s, key);
+    if (!m) { cnt_.misses++; return std::nullopt; }
+    int w = __builtin_ctz(m);
+    touch(s, w);
+    cnt_.hits++;
+    return keysOf(s)[ways_ + w];
+}
+
+void SetAssocCache::put(int key, int value) {
+    cnt_.puts++;
+    if (cap_ == 0) return;
+    uint32_t s = setOf(key);
+    int* k = keysOf(s);
+    if (uint32_t m = match(s, key)) {
+        int w = __builtin_ctz(m);
+        k[ways_ + w] = value;
+        touch(s, w);
+        return;
+    }
+    uint32_t free = openMask(s) & ~(uint32_t)valid_[s];
+    int w;
+    if (free) {
+        w = __builtin_ctz(free);
+        valid_[s] |= (uint16_t)(1u << w);
+        sz_++;
+    } else {
+        w = victim(s);
+        cnt_.evictions++;
+        notifyEvict(k[w], k[ways_ + w], EvictReason::Capacity);
+    }
+    k[w] = key;
+    k[ways_ + w] = value;
+    onInsert(s, w);
+}
+
+bool SetAssocCache::erase(int key) {
+    uint32_t s = setOf(key);
+    uint32_t m = match(s, key);
+    if (!m) return false;
+    int w = __builtin_ctz(m);
+    valid_[s] &= (uint16_t)~(1u << w);
+    sz_--;
+    notifyEvict(key, keysOf(s)[ways_ + w], EvictReason::Erase);
+    return true;
+}
+
+// Пакет: сначала хеши и предвыборка строк наборов, потом сами поиски
+void SetAssocCache::getMany(const int* keys, size_t n, std::optional<int>* out) {
+    uint32_t sets[kBatchGroup];
+    for (size_t base = 0; base < n; base += kBatchGroup) {
+        size_t m = std::min(kBatchGroup, n - base);
+        for (size_t i = 0; i < m; ++i) {
+            sets[i] = setOf(keys[base + i]);
+            __builtin_prefetch(keysOf(sets[i]));
+        }
+        for (size_t i = 0; i < m; ++i) {
+            cnt_.gets++;
+            uint32_t s = sets[i];
+            uint32_t hit = match(s, keys[base + i]);
+            if (!hit) { cnt_.misses++; out[base + i] = std::nullopt; continue; }
+            int w = __builtin_ctz(hit);
+            touch(s, w);
+            cnt_.hits++;
+            out[base + i] = keysOf(s)[ways_ + w];
+        }
+    }
+}
+
+void SetAssocCache::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    const size_t payload = sizeof(int) * 2;
+    theoretical = cap_ * payload;
+    actual = sz_ * payload;
+    overhead = lines_.capacity() * sizeof(Line) + valid_.capacity() * sizeof(uint16_t)
+             + plru_.capacity() * sizeof(uint16_t) + freq_.capacity() * sizeof(uint8_t) - actual;
+}
@@ -0,0 +1,95 @@
+#include "Sharded.h"
+#include "FlatIndex.h"
+#include <cstdint>
+#include <vector>
+
+ShardedCache::ShardedCache(size_t cap, size_t shards, const Factory& make)
+    : cap_(cap), n_(shards ? shards : 1), shards_(new Shard[n_]) {
+    for (size_t i = 0; i < n_; ++i)
+        shards_[i].cache = make(cap_ / n_ + (i < cap_ % n_ ? 1 : 0));
+}
+
+// Шард выбирается по старшим битам хеша: младшие использует FlatIndex внутри шарда
+ShardedCache::Shard& ShardedCache::shardFor(int key) const {
+    uint64_t h = FlatIndex::mix(key);
+    return shards_[(h * n_) >> 32];
+}
+
+void ShardedCache::addEvictions(const OpCounters& before, const OpCounters& after) {
+    if (after.evictions != before.evictions) stats_.add(StatField::Evictions, after.evictions - before.evictions);
+    if (after.expired != before.expired) stats_.add(StatField::Expired, after.expired - before.expired);
+}
+
+void ShardedCache::put(int key, int value) {
+    stats_.add(StatField::Puts);
+    Shard& s = shardFor(key);
+    std::lock_guard<std::mutex> lock(s.mu);
+    OpCounters before = s.cache->counters();
+    s.cache->put(key, value);
+    addEvictions(before, s.cache->counters());
+}
+
+std::optional<int> ShardedCache::get(int key) {
+    Shard& s = shardFor(key);
+    std::optional<int> v;
+    {
+        std::lock_guard<std::mutex> lock(s.mu);
+        long long expired = s.cache->counters().expired;
+        v = s.cache->get(key);
+        long long now = s.cache->counters().expired;
+        if (now != expired) stats_.add(StatField::Expired, now - expired);
+    }
+    stats_.add(v ? StatField::Hits : StatField::Misses);
+    return v;
+}
+
+bool ShardedCache::erase(int key) {
+    Shard& s = shardFor(key);
+    std::lock_guard<std::mutex> lock(s.mu);
+    return s.cache->erase(key);
+}
+
+void ShardedCache::setEvictionListener(EvictionListener* l) {
+    listener_ = l;
+    for (size_t i = 0; i < n_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mu);
+        shards_[i].cache->setEvictionListener(l);
+    }
+}
+
+size_t ShardedCache::size() const {
+    size_t total = 0;
+    for (size_t i = 0; i < n_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mu);
+        total += shards_[i].cache->size();
+    }
+    return total;
+}
+
+const OpCounters& ShardedCache::counters() const {
+    total_ = stats_.snapshot();
+    return total_;
+}
+
+// Порядок «от жертвы к ценным» соблюдается внутри каждого шарда
+bool ShardedCache::exportEntries(std::vector<SnapshotEntry>& out) const {
+    size_t from = out.size();
+    for (size_t i = 0; i < n_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mu);
+        if (!shards_[i].cache->exportEntries(out)) { out.resize(from); return false; }
+    }
+    return true;
+}
+
+// Записи расходятся по своим шардам с сохранением порядка; если шарду досталось
+// больше его ёмкости, остаются самые ценные (последние)
+void ShardedCache::importEntries(const SnapshotEntry* e, size_t n) {
+    std::vector<std::vector<SnapshotEntry>> parts(n_);
+    for (size_t i = 0; i < n; ++i) parts[&shardFor(e[i].key) - shards_.get()].push_back(e[i]);
+    for (size_t i = 0; i < n_; ++i) {
+        std::lock_guard<std::mutex> lock(shards_[i].mu);
+        size_t cap = shards_[i].cache->capacity();
+        size_t skip = parts[i].size() > cap ? parts[i].size() - cap : 0;
+        shards_[i].cache->importEntries(parts[i].data() + skip, parts[i].size() - skip);
+    }
+}
@@ -0,0 +1,84 @@
+#include "SlabArena.h"
+#include <algorithm>
+#include <cstring>
+
+SlabArena::SlabArena(size_t bytes, uint32_t pageSize, uint32_t maxChunk)
+    : pageSize_(pageSize) {
+    maxChunk = std::min(maxChunk, pageSize);
+    for (uint32_t s = kMinChunk; s < maxChunk; s = ((uint32_t)(s * 1.25) + 7) & ~7u)
+        classes_.push_back(s);
+    classes_.push_back(maxChunk);
+    partial_.resize(classes_.size());
+
+    size_t n = std::max<size_t>(1, (bytes + pageSize - 1) / pageSize);
+    mem_ = makeTrackedBuffer(n * pageSize);
+    pages_.resize(n);
+    freePages_.reserve(n);
+    for (size_t i = n; i > 0; --i) freePages_.push_back((uint32_t)(i - 1));
+}
+
+uint32_t SlabArena::classOf(uint32_t bytes) const {
+    return (uint32_t)(std::lower_bound(classes_.begin(), classes_.end(), bytes) - classes_.begin());
+}
+
+SlabArena::Handle SlabArena::alloc(uint32_t bytes) {
+    if (bytes > classes_.back()) return kNone;
+    uint32_t cls = classOf(bytes);
+    IndexList& list = partial_[cls];
+    if (list.empty()) {
+        if (freePages_.empty()) return kNone;
+        uint32_t p = freePages_.back();
+        freePages_.pop_back();
+        Page& pg = pages_[p];
+        pg.cls = cls;
+        pg.used = 0;
+        pg.chunks = pageSize_ / classes_[cls];
+        pg.bump = 0;
+        pg.freeHead = IndexList::kNil;
+        list.pushFront(pages_, p);
+    }
+    uint32_t p = list.head;
+    Page& pg = pages_[p];
+    uint32_t c;
+    if (pg.freeHead != IndexList::kNil) {
+        c = pg.freeHead;
+        // Свободный кусок хранит номер следующего свободного в первых 4 байтах
+        std::memcpy(&pg.freeHead, mem_.get() + (size_t)p * pageSize_ + (size_t)c * classes_[cls], sizeof(uint32_t));
+    } else {
+        c = pg.bump++;
+    }
+    if (++pg.used == pg.chunks) list.unlink(pages_, p);
+    requested_ += bytes;
+    chunkBytes_ += classes_[cls];
+    return (p << kChunkBits) | c;
+}
+
+void SlabArena::free(Handle h, uint32_t bytes) {
+    uint32_t p = h >> kChunkBits;
+    uint32_t c = h & ((1u << kChunkBits) - 1);
+    Page& pg = pages_[p];
+    IndexList& list = partial_[pg.cls];
+    std::memcpy(data(h), &pg.freeHead, sizeof(uint32_t));
+    pg.freeHead = c;
+    if (pg.used-- == pg.chunks) list.pushFront(pages_, p);
+    requested_ -= bytes;
+    chunkBytes_ -= classes_[pg.cls];
+    if (pg.used == 0) {
+        list.unlink(pages_, p);
+        freePages_.push_back(p);
+    }
+}
+
+double SlabArena::internalFragmentation() const {
+    return chunkBytes_ ? (double)(chunkBytes_ - requested_) / chunkBytes_ * 100.0 : 0.0;
+}
+
+double SlabArena::externalFragmentation() const {
+    size_t reserved = reservedBytes();
+    return reserved ? (double)(reserved - chunkBytes_) / reserved * 100.0 : 0.0;
+}
+
+size_t SlabArena::bytes() const {
+    return pages_.capacity() * sizeof(Page) + freePages_.capacity() * sizeof(uint32_t)
+         + classes_.capacity() * sizeof(uint32_t) + partial_.capacity() * sizeof(IndexList);
+}
@@ -0,0 +1,44 @@
+#include "Snapshot.h"
+#include "Trace.h"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+long long saveSnapshot(const ICache& cache, const std::string& path) {
+    std::vector<SnapshotEntry> entries;
+    if (!cache.exportEntries(entries)) return -1;
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return -1;
+    uint8_t header[snapshot::kHeaderBytes] = {};
+    uint32_t entry_bytes = sizeof(SnapshotEntry);
+    uint64_t count = entries.size();
+    std::memcpy(header, snapshot::kMagic, sizeof(snapshot::kMagic));
+    std::memcpy(header + 8, &entry_bytes, sizeof(entry_bytes));
+    std::memcpy(header + 16, &count, sizeof(count));
+    bool ok = std::fwrite(header, 1, sizeof(header), f) == sizeof(header)
+              && std::fwrite(entries.data(), sizeof(SnapshotEntry), entries.size(), f) == entries.size();
+    ok = (std::fclose(f) == 0) && ok;
+    return ok ? (long long)count : -1;
+}
+
+long long loadSnapshot(ICache& cache, const std::string& path) {
+    if (cache.size() != 0) return -1;
+    MappedFile file;
+    if (!file.open(path) || file.size() < snapshot::kHeaderBytes) return -1;
+    const uint8_t* p = file.data();
+    uint32_t entry_bytes = 0;
+    uint64_t count = 0;
+    std::memcpy(&entry_bytes, p + 8, sizeof(entry_bytes));
+    std::memcpy(&count, p + 16, sizeof(count));
+    // count из файла не доверенный: сначала сравниваем его с тем, что помещается
+    // в файл (делением), и только потом точный размер — иначе произведение переполнится
+    const size_t body = file.size() - snapshot::kHeaderBytes;
+    if (std::memcmp(p, snapshot::kMagic, sizeof(snapshot::kMagic)) != 0 || entry_bytes != sizeof(SnapshotEntry)
+        || count > body / sizeof(SnapshotEntry) || body != count * sizeof(SnapshotEntry))
+        return -1;
+    // Заголовок кратен 4 байтам, mmap выровнен по странице — записи читаются на месте
+    const auto* e = reinterpret_cast<const SnapshotEntry*>(p + snapshot::kHeaderBytes);
+    size_t skip = count > cache.capacity() ? count - cache.capacity() : 0;
+    cache.importEntries(e + skip, count - skip);
+    return (long long)(count - skip);
+}
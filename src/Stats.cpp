@@ -0,0 +1,75 @@
+#include "Stats.h"
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <sched.h>
+
+OpCounters delta(const OpCounters& now, const OpCounters& prev) {
+    OpCounters d;
+    d.hits = now.hits - prev.hits;
+    d.misses = now.misses - prev.misses;
+    d.puts = now.puts - prev.puts;
+    d.gets = now.gets - prev.gets;
+    d.evictions = now.evictions - prev.evictions;
+    d.expired = now.expired - prev.expired;
+    return d;
+}
+
+ShardedStats::ShardedStats(size_t slots, StatSlotBy by)
+    : slots_(new Slot[std::max<size_t>(1, slots) + 1]), n_((uint32_t)std::max<size_t>(1, slots)), by_(by) {}
+
+namespace {
+// Пул номеров потоков: выдаётся наименьший свободный, при выходе потока номер
+// возвращается. Мьютекс берётся только при первом add потока и при его завершении.
+std::mutex g_tid_mu;
+std::vector<uint32_t> g_tid_free;
+uint32_t g_tid_next = 0;
+
+struct ThreadIndexRelease {
+    uint32_t id;
+    ~ThreadIndexRelease() {
+        std::lock_guard<std::mutex> lock(g_tid_mu);
+        g_tid_free.push_back(id);
+        std::push_heap(g_tid_free.begin(), g_tid_free.end(), std::greater<uint32_t>());
+    }
+};
+}
+
+uint32_t ShardedStats::acquireThreadIndex() {
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(g_tid_mu);
+        if (!g_tid_free.empty()) {
+            std::pop_heap(g_tid_free.begin(), g_tid_free.end(), std::greater<uint32_t>());
+            id = g_tid_free.back();
+            g_tid_free.pop_back();
+        } else {
+            id = g_tid_next++;
+        }
+    }
+    thread_local ThreadIndexRelease release{id};
+    return release.id;
+}
+
+// Ядро может смениться сразу после sched_getcpu — тогда поток просто пишет
+// в чужой слот; fetch_add от этого не ломается
+ShardedStats::Slot& ShardedStats::cpuSlot() {
+    int cpu = sched_getcpu();
+    return slots_[(uint32_t)(cpu < 0 ? 0 : cpu) % n_];
+}
+
+// gets — сумма hits и misses того же снимка (отдельного счётчика нет)
+OpCounters ShardedStats::snapshot() const {
+    OpCounters c;
+    for (uint32_t i = 0; i <= n_; ++i) {
+        const auto& v = slots_[i].v;
+        c.hits += v[(int)StatField::Hits].load(std::memory_order_relaxed);
+        c.misses += v[(int)StatField::Misses].load(std::memory_order_relaxed);
+        c.puts += v[(int)StatField::Puts].load(std::memory_order_relaxed);
+        c.evictions += v[(int)StatField::Evictions].load(std::memory_order_relaxed);
+        c.expired += v[(int)StatField::Expired].load(std::memory_order_relaxed);
+    }
+    c.gets = c.hits + c.misses;
+    return c;
+}
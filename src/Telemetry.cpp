@@ -0,0 +1,103 @@
+#include "Telemetry.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+
+namespace {
+constexpr char kTelemetryMagic[8] = {'C', 'T', 'E', 'L', 'E', 'M', '1', '\0'};
+}
+
+TelemetryStream::TelemetryStream(const std::string& path, TelemetryFormat format, std::string label,
+                                 size_t ring_capacity, int poll_ms)
+    : ring_(ring_capacity), format_(format), label_(std::move(label)), poll_ms_(poll_ms),
+      ns_per_tick_(latencyNsPerTick()) {
+    file_ = std::fopen(path.c_str(), format_ == TelemetryFormat::Binary ? "wb" : "w");
+    if (!file_) return;
+    if (format_ == TelemetryFormat::Csv) {
+        std::fputs("label,window,end_op,hits,misses,puts,evictions,hit_rate,avg_ns,p50_ns,max_ns\n", file_);
+    } else {
+        uint32_t rec = sizeof(WindowRecord), len = (uint32_t)label_.size();
+        std::fwrite(kTelemetryMagic, 1, sizeof(kTelemetryMagic), file_);
+        std::fwrite(&rec, sizeof(rec), 1, file_);
+        std::fwrite(&len, sizeof(len), 1, file_);
+        std::fwrite(label_.data(), 1, len, file_);
+        std::fwrite(&ns_per_tick_, sizeof(ns_per_tick_), 1, file_);
+    }
+    std::fflush(file_);
+    drainer_ = std::thread([this] { drainLoop(); });
+}
+
+TelemetryStream::~TelemetryStream() { stop(); }
+
+void TelemetryStream::stop() {
+    if (!drainer_.joinable()) {
+        if (file_) { std::fclose(file_); file_ = nullptr; }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+    }
+    cv_.notify_one();
+    drainer_.join();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+namespace {
+// to_chars вместо fprintf: строка CSV на окно собирается в буфере без разбора формата
+char* putInt(char* p, char* end, uint64_t v) { p = std::to_chars(p, end, v).ptr; *p++ = ','; return p; }
+char* putFixed(char* p, char* end, double v, int prec) {
+    return std::to_chars(p, end, v, std::chars_format::fixed, prec).ptr;
+}
+}
+
+void TelemetryStream::write(const WindowRecord& r) {
+    if (format_ == TelemetryFormat::Binary) {
+        std::fwrite(&r, sizeof(r), 1, file_);
+        return;
+    }
+    uint64_t gets = r.hits + r.misses;
+    uint64_t ops = gets + r.puts;
+    char buf[256];
+    char* end = buf + sizeof(buf);
+    char* p = buf;
+    p = std::copy(label_.begin(), label_.begin() + std::min<size_t>(label_.size(), 64), p);
+    *p++ = ',';
+    for (uint64_t v : {r.window, r.end_op, r.hits, r.misses, r.puts, r.evictions}) p = putInt(p, end, v);
+    p = putFixed(p, end, gets ? (double)r.hits / gets * 100.0 : 0.0, 4); *p++ = ',';
+    p = putFixed(p, end, ops ? (double)r.elapsed_ns / ops : 0.0, 2); *p++ = ',';
+    p = putFixed(p, end, r.p50_ticks * ns_per_tick_, 1); *p++ = ',';
+    p = putFixed(p, end, r.max_ticks * ns_per_tick_, 1); *p++ = '\n';
+    std::fwrite(buf, 1, p - buf, file_);
+}
+
+bool TelemetryStream::drainOnce() {
+    WindowRecord r;
+    long long n = 0;
+    while (ring_.pop(r)) { write(r); n++; }
+    if (n) {
+        std::fflush(file_);
+        written_.fetch_add(n, std::memory_order_relaxed);
+    }
+    return n > 0;
+}
+
+// Сборщик просыпается по таймеру: писателю не нужно никого будить, и publish
+// остаётся парой обычных записей в память. Условная переменная — только для stop().
+void TelemetryStream::drainLoop() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (!stop_) {
+        cv_.wait_for(lock, std::chrono::milliseconds(poll_ms_), [this] { return stop_; });
+        lock.unlock();
+        drainOnce();
+        lock.lock();
+    }
+    // stop() мог прийти раньше, чем поток впервые дошёл до цикла
+    lock.unlock();
+    drainOnce();
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    drain_cpu_ns_.store((long long)ts.tv_sec * 1000000000LL + ts.tv_nsec, std::memory_order_relaxed);
+}
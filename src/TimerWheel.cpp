@@ -0,0 +1,54 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+TimerWheel::TimerWheel(size_t n) : timers_(n) {
+    std::fill(std::begin(heads_), std::end(heads_), kNone);
+}
+
+void TimerWheel::schedule(uint32_t i, uint64_t when) {
+    cancel(i);
+    timers_[i].when = std::max(when, now_ + 1);
+    place(i);
+}
+
+// Уровень выбирается по расстоянию до дедлайна; дальше последнего уровня —
+// в его самый дальний слот, при ссыпании позиция пересчитается по настоящему when.
+void TimerWheel::place(uint32_t i) {
+    Timer& t = timers_[i];
+    uint64_t delta = t.when - now_;
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (1ull << (kBits * (level + 1)))) ++level;
+    uint64_t at = std::min<uint64_t>(t.when, now_ + (1ull << (kBits * kLevels)) - 1);
+    uint32_t b = (uint32_t)level * kSlots + ((uint32_t)(at >> (kBits * level)) & kMask);
+
+    t.bucket = b;
+    t.prev = kNone;
+    t.next = heads_[b];
+    if (heads_[b] != kNone) timers_[heads_[b]].prev = i;
+    heads_[b] = i;
+    occupied_[level] |= 1ull << (b & kMask);
+    count_++;
+}
+
+void TimerWheel::unlink(uint32_t i) {
+    Timer& t = timers_[i];
+    if (t.prev != kNone) timers_[t.prev].next = t.next; else heads_[t.bucket] = t.next;
+    if (t.next != kNone) timers_[t.next].prev = t.prev;
+    if (heads_[t.bucket] == kNone) occupied_[t.bucket / kSlots] &= ~(1ull << (t.bucket & kMask));
+    t.bucket = kNone;
+    count_--;
+}
+
+void TimerWheel::cascade(int level, uint32_t slot) {
+    uint32_t b = (uint32_t)level * kSlots + slot;
+    uint32_t i = heads_[b];
+    heads_[b] = kNone;
+    occupied_[level] &= ~(1ull << slot);
+    while (i != kNone) {
+        uint32_t next = timers_[i].next;
+        timers_[i].bucket = kNone;
+        count_--;
+        place(i);
+        i = next;
+    }
+}
@@ -0,0 +1,115 @@
+#include "TinyLFU.h"
+#include <algorithm>
+
+TinyLFUCache::TinyLFUCache(size_t cap)
+    : cap_(cap), nodes_(cap), index_(cap), sketch_(cap) {
+    windowCap_ = (uint32_t)std::min<size_t>(cap, std::max<size_t>(1, cap / 100));
+    mainCap_ = (uint32_t)(cap - windowCap_);
+    protectedCap_ = mainCap_ * 8 / 10;
+    free_.reserve(cap);
+    for (size_t i = cap; i > 0; --i) free_.push_back((uint32_t)(i - 1));
+}
+
+IndexList& TinyLFUCache::listOf(Segment s) {
+    return s == Window ? window_ : (s == Probation ? probation_ : protected_);
+}
+
+uint32_t TinyLFUCache::allocSlot() {
+    uint32_t i = free_.back();
+    free_.pop_back();
+    return i;
+}
+
+void TinyLFUCache::evict(uint32_t i) {
+    Node& n = nodes_[i];
+    listOf(n.seg).unlink(nodes_, i);
+    index_.erase(n.key);
+    free_.push_back(i);
+    sz_--;
+    cnt_.evictions++;
+    notifyEvict(n.key, n.val, EvictReason::Capacity);
+}
+
+// Попадание: в окне и protected — просто в начало; из probation — повышение
+// в protected, с переливом хвоста protected обратно в probation.
+void TinyLFUCache::onHit(uint32_t i) {
+    Node& n = nodes_[i];
+    if (n.seg != Probation) { listOf(n.seg).moveToFront(nodes_, i); return; }
+    probation_.unlink(nodes_, i);
+    n.seg = Protected;
+    protected_.pushFront(nodes_, i);
+    if (protected_.size > protectedCap_) {
+        uint32_t d = protected_.tail;
+        protected_.unlink(nodes_, d);
+        nodes_[d].seg = Probation;
+        probation_.pushFront(nodes_, d);
+    }
+}
+
+// Окно переполнено: его хвост — кандидат в основную область
+void TinyLFUCache::admitFromWindow() {
+    uint32_t cand = window_.tail;
+    if (probation_.size + protected_.size < mainCap_) {
+        window_.unlink(nodes_, cand);
+        nodes_[cand].seg = Probation;
+        probation_.pushFront(nodes_, cand);
+        return;
+    }
+    uint32_t victim = !probation_.empty() ? probation_.tail : protected_.tail;
+    if (victim != IndexList::kNil
+        && sketch_.estimate(nodes_[cand].key) > sketch_.estimate(nodes_[victim].key)) {
+        evict(victim);
+        window_.unlink(nodes_, cand);
+        nodes_[cand].seg = Probation;
+        probation_.pushFront(nodes_, cand);
+    } else {
+        rejected_++;
+        evict(cand);
+    }
+}
+
+std::optional<int> TinyLFUCache::get(int key) {
+    cnt_.gets++;
+    sketch_.increment(key);
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) { cnt_.misses++; return std::nullopt; }
+    onHit(i);
+    cnt_.hits++;
+    return nodes_[i].val;
+}
+
+void TinyLFUCache::put(int key, int value) {
+    cnt_.puts++;
+    if (cap_ == 0) return;
+    sketch_.increment(key);
+    uint32_t i = index_.find(key);
+    if (i != FlatIndex::kEmpty) { nodes_[i].val = value; onHit(i); return; }
+    if (window_.size >= windowCap_) admitFromWindow();
+    i = allocSlot();
+    nodes_[i].key = key;
+    nodes_[i].val = value;
+    nodes_[i].seg = Window;
+    window_.pushFront(nodes_, i);
+    index_.insert(key, i);
+    sz_++;
+}
+
+bool TinyLFUCache::erase(int key) {
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) return false;
+    Node& n = nodes_[i];
+    listOf(n.seg).unlink(nodes_, i);
+    index_.erase(key);
+    free_.push_back(i);
+    sz_--;
+    notifyEvict(key, n.val, EvictReason::Erase);
+    return true;
+}
+
+void TinyLFUCache::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    const size_t payload = sizeof(int) * 2;
+    theoretical = cap_ * payload;
+    actual = sz_ * payload;
+    overhead = nodes_.capacity() * sizeof(Node) + free_.capacity() * sizeof(uint32_t)
+             + index_.bytes() + sketch_.bytes() - actual;
+}
@@ -0,0 +1,197 @@
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ---- TraceWriter ----
+
+bool TraceWriter::open(const std::string& path, uint32_t flags) {
+    close();
+    f_ = std::fopen(path.c_str(), "wb");
+    if (!f_) return false;
+    flags_ = flags;
+    count_ = 0;
+    prevKey_ = 0;
+    prevTime_ = 0;
+    buf_.assign(1u << 20, 0);
+    used_ = 0;
+    uint8_t header[trace::kHeaderBytes] = {};
+    std::memcpy(header, trace::kMagic, sizeof(trace::kMagic));
+    std::memcpy(header + 8, &flags_, sizeof(flags_));
+    return std::fwrite(header, 1, sizeof(header), f_) == sizeof(header);
+}
+
+void TraceWriter::flush() {
+    if (used_) std::fwrite(buf_.data(), 1, used_, f_);
+    used_ = 0;
+}
+
+void TraceWriter::append(const TraceRecord& r) {
+    // Худший случай записи — три варинта по 10 байт
+    if (buf_.size() - used_ < 32) flush();
+    uint8_t* p = buf_.data() + used_;
+    uint32_t delta = trace::zigzag((int32_t)((uint32_t)r.key - (uint32_t)prevKey_));
+    p = trace::putVarint(p, ((uint64_t)delta << 1) | (r.op & 1));
+    if (flags_ & trace::kHasSize) p = trace::putVarint(p, r.size);
+    if (flags_ & trace::kHasTime) {
+        p = trace::putVarint(p, r.timestamp >= prevTime_ ? r.timestamp - prevTime_ : 0);
+        prevTime_ = std::max(prevTime_, r.timestamp);
+    }
+    used_ = (size_t)(p - buf_.data());
+    prevKey_ = r.key;
+    count_++;
+}
+
+bool TraceWriter::close() {
+    if (!f_) return true;
+    flush();
+    bool ok = std::fseek(f_, 16, SEEK_SET) == 0
+              && std::fwrite(&count_, sizeof(count_), 1, f_) == 1;
+    ok = (std::fclose(f_) == 0) && ok;
+    f_ = nullptr;
+    return ok;
+}
+
+// ---- MappedFile ----
+
+bool MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) { ::close(fd); return false; }
+    void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);     // отображение держит файл само
+    if (p == MAP_FAILED) return false;
+    data_ = static_cast<const uint8_t*>(p);
+    size_ = (size_t)st.st_size;
+    ::madvise(p, size_, MADV_SEQUENTIAL);
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+// madvise требует адрес, выровненный по странице
+static void adviseRange(const uint8_t* base, size_t size, size_t offset, size_t len, int advice) {
+    static const size_t page = (size_t)::sysconf(_SC_PAGESIZE);
+    if (!base || offset >= size) return;
+    size_t begin = offset / page * page;
+    size_t end = std::min(size, offset + len);
+    ::madvise(const_cast<uint8_t*>(base) + begin, end - begin, advice);
+}
+
+void MappedFile::prefetch(size_t offset, size_t len) const {
+    adviseRange(data_, size_, offset, len, MADV_WILLNEED);
+}
+
+void MappedFile::release(size_t offset, size_t len) const {
+    adviseRange(data_, size_, offset, len, MADV_DONTNEED);
+}
+
+// ---- TraceReader ----
+
+TraceReader::TraceReader(const MappedFile& file) : file_(file) {
+    if (file.size() < trace::kHeaderBytes
+        || std::memcmp(file.data(), trace::kMagic, sizeof(trace::kMagic)) != 0) return;
+    std::memcpy(&flags_, file.data() + 8, sizeof(flags_));
+    std::memcpy(&total_, file.data() + 16, sizeof(total_));
+    pos_ = trace::kHeaderBytes;
+    valid_ = true;
+}
+
+size_t TraceReader::next(TraceRecord* out, size_t max) {
+    if (!valid_) return 0;
+    const uint8_t* base = file_.data();
+    const uint8_t* end = base + file_.size();
+
+    // Окно впереди — в readahead, окно позади — отпускаем
+    if (pos_ + kWindow > prefetched_) {
+        file_.prefetch(pos_, 2 * kWindow);
+        prefetched_ = pos_ + 2 * kWindow;
+    }
+    if (pos_ > released_ + 2 * kWindow) {
+        size_t upto = pos_ - kWindow;
+        file_.release(released_, upto - released_);
+        released_ = upto;
+    }
+
+    const uint8_t* p = base + pos_;
+    size_t n = 0;
+    for (; n < max && done_ < total_; ++n, ++done_) {
+        uint64_t v;
+        const uint8_t* q = trace::getVarint(p, end, v);
+        if (!q) break;
+        TraceRecord& r = out[n];
+        r.op = (uint8_t)(v & 1);
+        r.key = (int)((uint32_t)prevKey_ + (uint32_t)trace::unzigzag((uint32_t)(v >> 1)));
+        if (flags_ & trace::kHasSize) {
+            if (!(q = trace::getVarint(q, end, v))) break;
+            r.size = (uint32_t)v;
+        }
+        if (flags_ & trace::kHasTime) {
+            if (!(q = trace::getVarint(q, end, v))) break;
+            prevTime_ += v;
+            r.timestamp = prevTime_;
+        }
+        prevKey_ = r.key;
+        p = q;
+    }
+    pos_ = (size_t)(p - base);
+    if (n < max && done_ < total_) valid_ = false;    // файл обрезан
+    return n;
+}
+
+// ---- Конвертер ----
+
+static bool parseOp(const std::string& s, uint8_t& op) {
+    std::string t;
+    for (char c : s) t += (char)std::tolower((unsigned char)c);
+    if (t == "get" || t == "g" || t == "0" || t == "read" || t == "r")  { op = kTraceGet; return true; }
+    if (t == "put" || t == "p" || t == "1" || t == "set" || t == "write" || t == "w") { op = kTracePut; return true; }
+    return false;
+}
+
+long long convertTextTrace(const std::string& in_path, const std::string& out_path) {
+    std::ifstream in(in_path);
+    if (!in) return -1;
+    TraceWriter w;
+    bool opened = false;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream ss(line);
+        std::vector<std::string> f;
+        for (std::string x; ss >> x;) f.push_back(x);
+        if (f.empty()) continue;
+
+        TraceRecord r;
+        size_t k = 0;
+        if (f.size() >= 2 && parseOp(f[0], r.op)) k = 1;      // "op,key,..."
+        else r.op = kTraceGet;                                  // только ключ
+        char* endp = nullptr;
+        long long key = std::strtoll(f[k].c_str(), &endp, 10);
+        if (*endp) continue;                                    // заголовок CSV или мусор
+        r.key = (int)key;
+        if (f.size() > k + 1) r.size = (uint32_t)std::strtoull(f[k + 1].c_str(), nullptr, 10);
+        if (f.size() > k + 2) r.timestamp = std::strtoull(f[k + 2].c_str(), nullptr, 10);
+
+        if (!opened) {
+            // Набор полей определяется по первой записи
+            uint32_t flags = (f.size() > k + 1 ? trace::kHasSize : 0) | (f.size() > k + 2 ? trace::kHasTime : 0);
+            if (!w.open(out_path, flags)) return -1;
+            opened = true;
+        }
+        w.append(r);
+    }
+    if (!opened && !w.open(out_path)) return -1;
+    long long n = (long long)w.records();
+    return w.close() ? n : -1;
+}
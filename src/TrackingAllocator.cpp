@@ -0,0 +1,102 @@
+#include "TrackingAllocator.h"
+#include "Stats.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <unistd.h>
+
+namespace {
+
+enum Field { Allocs, Frees, Requested, Usable, LiveRequested, LiveUsable, kFields };
+
+// Счётчики по слотам потоков, как в ShardedStats: поток с номером < kSlots — единственный
+// писатель своего слота (relaxed load + store, без lock-префикса и без общей кэш-линии),
+// остальные делят запасной слот через fetch_add. Память может освободить не тот поток,
+// что её выделил, поэтому live_* отдельного слота бывают отрицательными — верна только сумма.
+constexpr uint32_t kSlots = 64;
+
+struct alignas(64) Slot {
+    std::atomic<long long> v[kFields] = {};
+};
+
+Slot g_slots[kSlots + 1];   // константная инициализация: готов до любых статических конструкторов
+
+struct SlotWriter {
+    Slot& s;
+    bool shared;
+    void add(Field f, long long n) {
+        auto& v = s.v[f];
+        if (shared) v.fetch_add(n, std::memory_order_relaxed);
+        else v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+};
+
+SlotWriter mySlot() {
+    uint32_t t = ShardedStats::threadIndex();
+    return t < kSlots ? SlotWriter{g_slots[t], false} : SlotWriter{g_slots[kSlots], true};
+}
+
+} // namespace
+
+AllocStats allocSnapshot() {
+    long long v[kFields] = {};
+    for (const Slot& s : g_slots)
+        for (int f = 0; f < kFields; ++f) v[f] += s.v[f].load(std::memory_order_relaxed);
+    AllocStats s;
+    s.allocs = v[Allocs];
+    s.frees = v[Frees];
+    s.requested = v[Requested];
+    s.usable = v[Usable];
+    s.live_requested = v[LiveRequested];
+    s.live_usable = v[LiveUsable];
+    return s;
+}
+
+AllocStats allocDelta(const AllocStats& before, const AllocStats& after) {
+    AllocStats d;
+    d.allocs = after.allocs - before.allocs;
+    d.frees = after.frees - before.frees;
+    d.requested = after.requested - before.requested;
+    d.usable = after.usable - before.usable;
+    d.live_requested = after.live_requested - before.live_requested;
+    d.live_usable = after.live_usable - before.live_usable;
+    return d;
+}
+
+void* trackedAlloc(size_t bytes, size_t align) {
+    void* p = align > alignof(std::max_align_t)
+        ? std::aligned_alloc(align, (bytes + align - 1) / align * align)
+        : std::malloc(bytes ? bytes : 1);
+    if (!p) throw std::bad_alloc();
+    long long usable = (long long)malloc_usable_size(p);
+    SlotWriter w = mySlot();
+    w.add(Allocs, 1);
+    w.add(Requested, (long long)bytes);
+    w.add(Usable, usable);
+    w.add(LiveRequested, (long long)bytes);
+    w.add(LiveUsable, usable);
+    return p;
+}
+
+void trackedFree(void* p, size_t bytes) {
+    if (!p) return;
+    SlotWriter w = mySlot();
+    w.add(Frees, 1);
+    w.add(LiveRequested, -(long long)bytes);
+    w.add(LiveUsable, -(long long)malloc_usable_size(p));
+    std::free(p);
+}
+
+size_t residentBytes() {
+    FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) return 0;
+    unsigned long total = 0, resident = 0;
+    int n = std::fscanf(f, "%lu %lu", &total, &resident);
+    std::fclose(f);
+    return n == 2 ? (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+}
+
+void releaseFreeHeap() {
+    malloc_trim(0);
+}
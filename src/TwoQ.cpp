@@ -0,0 +1,105 @@
+#include "TwoQ.h"
+#include <algorithm>
+
+TwoQCache::TwoQCache(size_t cap)
+    : cap_(cap),
+      kin_((uint32_t)std::max<size_t>(1, cap / 4)),
+      kout_((uint32_t)std::max<size_t>(1, cap / 2)),
+      nodes_(cap + kout_), index_(cap + kout_) {
+    free_.reserve(nodes_.size());
+    for (size_t i = nodes_.size(); i > 0; --i) free_.push_back((uint32_t)(i - 1));
+}
+
+IndexList& TwoQCache::queueOf(Queue q) {
+    return q == A1in ? a1in_ : (q == A1out ? a1out_ : am_);
+}
+
+void TwoQCache::dropNode(uint32_t i) {
+    queueOf(nodes_[i].q).unlink(nodes_, i);
+    index_.erase(nodes_[i].key);
+    free_.push_back(i);
+}
+
+// Освобождает место под одну резидентную запись
+void TwoQCache::reclaim() {
+    if (a1in_.size > kin_ || am_.empty()) {
+        // Хвост A1in теряет значение и становится призраком в A1out
+        uint32_t i = a1in_.tail;
+        Node& n = nodes_[i];
+        cnt_.evictions++;
+        notifyEvict(n.key, n.val, EvictReason::Capacity);
+        a1in_.unlink(nodes_, i);
+        if (a1out_.size >= kout_) dropNode(a1out_.tail);
+        n.q = A1out;
+        a1out_.pushFront(nodes_, i);
+    } else {
+        uint32_t i = am_.tail;
+        Node& n = nodes_[i];
+        cnt_.evictions++;
+        notifyEvict(n.key, n.val, EvictReason::Capacity);
+        dropNode(i);
+    }
+    sz_--;
+}
+
+std::optional<int> TwoQCache::get(int key) {
+    cnt_.gets++;
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty || nodes_[i].q == A1out) { cnt_.misses++; return std::nullopt; }
+    if (nodes_[i].q == Am) am_.moveToFront(nodes_, i);   // в A1in порядок FIFO не меняется
+    cnt_.hits++;
+    return nodes_[i].val;
+}
+
+void TwoQCache::put(int key, int value) {
+    cnt_.puts++;
+    if (cap_ == 0) return;
+    uint32_t i = index_.find(key);
+    if (i != FlatIndex::kEmpty && nodes_[i].q != A1out) {
+        nodes_[i].val = value;
+        if (nodes_[i].q == Am) am_.moveToFront(nodes_, i);
+        return;
+    }
+    if (i != FlatIndex::kEmpty) {
+        // Призрак: ключ вернулся — сразу в Am
+        a1out_.unlink(nodes_, i);
+        if (sz_ == cap_) {
+            reclaim();
+            // reclaim мог добавить призрак; i уже вне списков и не вытесняется
+        }
+        nodes_[i].val = value;
+        nodes_[i].q = Am;
+        am_.pushFront(nodes_, i);
+        sz_++;
+        return;
+    }
+    if (sz_ == cap_) reclaim();
+    i = free_.back();
+    free_.pop_back();
+    nodes_[i].key = key;
+    nodes_[i].val = value;
+    nodes_[i].q = A1in;
+    a1in_.pushFront(nodes_, i);
+    index_.insert(key, i);
+    sz_++;
+}
+
+bool TwoQCache::erase(int key) {
+    uint32_t i = index_.find(key);
+    if (i == FlatIndex::kEmpty) return false;
+    bool resident = nodes_[i].q != A1out;
+    int val = nodes_[i].val;
+    dropNode(i);
+    if (!resident) return false;
+    sz_--;
+    notifyEvict(key, val, EvictReason::Erase);
+    return true;
+}
+
+void TwoQCache::estimateMemory(size_t& theoretical, size_t& actual, size_t& overhead) const {
+    const size_t payload = sizeof(int) * 2;
+    theoretical = cap_ * payload;
+    actual = sz_ * payload;
+    overhead = nodes_.capacity() * sizeof(Node) + free_.capacity() * sizeof(uint32_t)
+             + index_.bytes() - actual;
+}
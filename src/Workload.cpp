@@ -0,0 +1,196 @@
+#include "Workload.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <thread>
+
+Workload makeWorkload(int total_ops, int universe, double locality) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> uni(0, universe - 1);
+    int hot_universe = std::max(1, universe / 10);
+    std::uniform_int_distribution<int> hot(0, hot_universe - 1);
+
+    Workload wl;
+    wl.ops.reserve(total_ops);
+    wl.universe = universe;
+    wl.hot_limit = hot_universe;
+
+    for (int i = 0; i < total_ops; ++i) {
+        double p = rng() / (double)rng.max();
+        wl.ops.push_back(p < locality ? hot(rng) : uni(rng));
+    }
+    return wl;
+}
+
+Workload makeScanWorkload(int total_ops, int universe, int scan_len, int period, double locality) {
+    Workload base = makeWorkload(total_ops, universe, locality);
+    Workload wl;
+    wl.ops.reserve(base.ops.size() + (base.ops.size() / period + 1) * scan_len);
+    wl.universe = universe;
+    wl.hot_limit = base.hot_limit;
+
+    int next_cold = universe;
+    for (size_t i = 0; i < base.ops.size(); ++i) {
+        if (i > 0 && i % period == 0)
+            for (int s = 0; s < scan_len; ++s) wl.ops.push_back(next_cold++);
+        wl.ops.push_back(base.ops[i]);
+    }
+    return wl;
+}
+
+AliasSampler::AliasSampler(const std::vector<double>& weights)
+    : n_(weights.size()), threshold_(weights.size()), alias_(weights.size()) {
+    double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    std::vector<double> p(n_);
+    std::vector<uint32_t> small, large;
+    for (uint32_t i = 0; i < n_; ++i) {
+        p[i] = weights[i] * n_ / sum;
+        (p[i] < 1.0 ? small : large).push_back(i);
+    }
+    // Каждый «маленький» столбец добирается до 1 за счёт одного «большого»
+    while (!small.empty() && !large.empty()) {
+        uint32_t s = small.back(); small.pop_back();
+        uint32_t l = large.back();
+        threshold_[s] = (uint32_t)std::min(p[s] * 4294967296.0, 4294967295.0);
+        alias_[s] = l;
+        p[l] -= 1.0 - p[s];
+        if (p[l] < 1.0) { large.pop_back(); small.push_back(l); }
+    }
+    // Остатки — столбцы с вероятностью 1 (с точностью до округления)
+    for (uint32_t i : small) { threshold_[i] = UINT32_MAX; alias_[i] = i; }
+    for (uint32_t i : large) { threshold_[i] = UINT32_MAX; alias_[i] = i; }
+}
+
+namespace {
+
+struct SplitMix64 {
+    uint64_t s;
+    uint64_t next() {
+        uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+};
+
+constexpr long long kBlock = 1 << 16;
+
+double unit(uint64_t r) { return (r >> 11) * (1.0 / 9007199254740992.0); }
+
+} // namespace
+
+Workload generateWorkload(const WorkloadSpec& spec) {
+    const int universe = std::max(1, spec.universe);
+    const long long n = std::max(0LL, spec.ops);
+    const int hot_universe = std::max(1, universe / 10);
+    const int loop_len = spec.loop_len > 0 ? spec.loop_len : universe;
+    const bool rw = spec.write_ratio >= 0.0;
+
+    std::vector<double> w;
+    if (spec.dist == KeyDist::Zipf) {
+        w.resize(universe);
+        for (int r = 0; r < universe; ++r) w[r] = 1.0 / std::pow(r + 1.0, spec.zipf_alpha);
+    }
+    const AliasSampler zipf(spec.dist == KeyDist::Zipf ? w : std::vector<double>{1.0});
+
+    Workload wl;
+    wl.universe = universe;
+    wl.ops.resize(n);
+    if (rw) wl.writes.resize(n);
+
+    int threads = spec.threads > 0 ? spec.threads : (int)std::max(1u, std::thread::hardware_concurrency());
+    const long long blocks = (n + kBlock - 1) / kBlock;
+    threads = (int)std::max(1LL, std::min<long long>(threads, blocks));
+    std::atomic<long long> nextBlock{0};
+
+    auto worker = [&](int) {
+        for (long long b; (b = nextBlock.fetch_add(1)) < blocks;) {
+            SplitMix64 rng{spec.seed ^ ((uint64_t)b * 0xD1B54A32D192ED03ull)};
+            const long long end = std::min(n, (b + 1) * kBlock);
+            for (long long i = b * kBlock; i < end; ++i) {
+                int key;
+                uint64_t r = rng.next();
+                if (spec.scan_period > 0 && i % spec.scan_period < spec.scan_len) {
+                    // Скан: каждый раз новые ключи за пределами universe
+                    key = universe + (int)((i / spec.scan_period) * spec.scan_len + i % spec.scan_period);
+                } else {
+                    uint32_t rank;
+                    switch (spec.dist) {
+                        case KeyDist::Zipf:  rank = zipf.sample(r); break;
+                        case KeyDist::Loop:  rank = (uint32_t)(i % loop_len); break;
+                        default:
+                            rank = unit(r) < spec.locality ? (uint32_t)(rng.next() % hot_universe)
+                                                           : (uint32_t)(rng.next() % universe);
+                    }
+                    key = (int)((rank + driftShift(i, spec.drift_period, spec.drift_step, universe)) % universe);
+                }
+                wl.ops[i] = key;
+                if (rw) wl.writes[i] = unit(rng.next()) < spec.write_ratio;
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& th : pool) th.join();
+
+    // Метки: top-K ключей по числу обращений (при равенстве — меньший ключ).
+    // Счётчики — один массив на universe, заполняется проходом по готовой
+    // нагрузке (ключи скана лежат за universe и не считаются): копия на поток
+    // генерации стоила бы threads × universe памяти. При дрейфе обращения
+    // считаются по ключу до сдвига, поэтому метки — у рангов, а HotOracle
+    // сдвигает их вместе с горячим множеством.
+    wl.drift_period = spec.drift_period;
+    wl.drift_step = spec.drift_step;
+    std::vector<uint32_t> total(universe, 0);
+    for (long long i = 0; i < n; ++i) {
+        int key = wl.ops[i];
+        if ((uint32_t)key >= (uint32_t)universe) continue;
+        if (spec.drift_period > 0)
+            key = (key - driftShift(i, spec.drift_period, spec.drift_step, universe) + universe) % universe;
+        total[key]++;
+    }
+    const int top = std::max(1, std::min(universe, (int)(spec.hot_fraction * universe)));
+    std::vector<int> order(universe);
+    std::iota(order.begin(), order.end(), 0);
+    std::nth_element(order.begin(), order.begin() + (top - 1), order.end(), [&](int a, int b) {
+        return total[a] != total[b] ? total[a] > total[b] : a < b;
+    });
+    wl.hot.assign(universe, 0);
+    for (int i = 0; i < top; ++i) wl.hot[order[i]] = 1;
+    wl.hot_limit = top;
+    return wl;
+}
+
+Workload concatWorkloads(const std::vector<Workload>& parts) {
+    Workload wl;
+    size_t total = 0;
+    for (const auto& p : parts) { total += p.ops.size(); wl.universe = std::max(wl.universe, p.universe); }
+    wl.ops.reserve(total);
+    wl.writes.reserve(total);
+    wl.hot.assign(wl.universe, 0);
+    for (const auto& p : parts) {
+        for (size_t i = 0; i < p.ops.size(); ++i) {
+            wl.ops.push_back(p.ops[i]);
+            wl.writes.push_back(p.isWrite(i) ? 1 : 0);
+        }
+        HotOracle o = HotOracle::of(p);
+        const long long phases = o.drifts() ? ((long long)p.ops.size() + p.drift_period - 1) / p.drift_period : 1;
+        for (long long ph = 0; ph < std::max(1LL, phases); ++ph)
+            for (int k = 0; k < p.universe; ++k)
+                if (o.isHot(k, ph * p.drift_period)) wl.hot[k] = 1;
+    }
+    wl.hot_limit = (int)std::count(wl.hot.begin(), wl.hot.end(), 1);
+    return wl;
+}
+
+uint64_t workloadChecksum(const Workload& wl) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < wl.ops.size(); ++i) {
+        h = (h ^ (uint32_t)wl.ops[i]) * 1099511628211ull;
+        h = (h ^ (uint64_t)wl.isWrite(i)) * 1099511628211ull;
+    }
+    return h;
+}
@@ -7,96 +7,511 @@
 #include <iomanip>
 #include <fstream>
 #include <string>
+#include <sstream>
 #include <functional>
 #include <algorithm>
+#include <numeric>
+#include <climits>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <type_traits>
+#include <cmath>
+#include <cstring>
+#include <cstdio>
+#include <filesystem>
+#include <tuple>
+#include <map>
+#include <stdexcept>
 
 #include "CacheBase.h"
 #include "LRU.h"
 #include "LFU.h"
+#include "CacheT.h"
+#include "Sharded.h"
+#include "Clock.h"
+#include "TinyLFU.h"
+#include "ARC.h"
+#include "TwoQ.h"
+#include "SLRU.h"
+#include "GDS.h"
+#include "Trace.h"
+#include "Workload.h"
+#include "LatencyHistogram.h"
+#include "MissRatioCurve.h"
+#include "PerfCounters.h"
+#include "TrackingAllocator.h"
+#include "Snapshot.h"
+#include "ReadThrough.h"
+#include "SetAssoc.h"
+#include "Adaptive.h"
+#include "Stats.h"
+#include "Telemetry.h"
+#include "Experiment.h"
 #include "Metrics.h"
 
 using Clock = std::chrono::high_resolution_clock;
 using Ns    = std::chrono::nanoseconds;
 
-struct Workload {
-    std::vector<int> ops;
-    int universe = 0;
-    int hot_limit = 0;
-};
-
-// Нагрузка с локальностью доступа
-Workload makeWorkload(int total_ops, int universe, double locality = 0.75) {
-    std::mt19937 rng(42);
-    std::uniform_int_distribution<int> uni(0, universe - 1);
-    int hot_universe = std::max(1, universe / 10);
-    std::uniform_int_distribution<int> hot(0, hot_universe - 1);
-
-    Workload wl;
-    wl.ops.reserve(total_ops);
-    wl.universe = universe;
-    wl.hot_limit = hot_universe;
-
-    for (int i = 0; i < total_ops; ++i) {
-        double p = rng() / (double)rng.max();
-        wl.ops.push_back(p < locality ? hot(rng) : uni(rng));
-    }
-    return wl;
-}
-
 // Контекст выполнения сценария
 struct RunContext {
     WarmupSeries warm;            // из Metrics.h
     long long useful_evict = 0;   // вытеснены «холодные»
     long long harmful_evict = 0;  // вытеснены «горячие»
+    LatencyHistogram* latency = nullptr;  // если задана — замер каждой latency_every-й операции
+    int latency_every = 1;
+    PerfCounters* perf = nullptr;         // если задан — аппаратные счётчики на время прогона
+    PerfSample perf_sample;
+    bool prefill = true;                  // положить cap/2 ключей перед прогоном
+    TelemetryStream* telemetry = nullptr; // если задан — записи окон уходят в фоновый поток
+    int telemetry_window = 10000;         // операций в окне телеметрии
+};
+
+// Память экземпляра по TrackingAllocator и RSS процесса
+struct MemoryMeasure {
+    long long live_bytes = 0;         // держит в куче после прогона (malloc_usable_size)
+    long long requested_bytes = 0;    // из них запрошено
+    long long run_allocs = 0;         // выделений за прогон, без конструктора
+    long long run_alloc_bytes = 0;
+    long long rss_delta = 0;          // рост RSS от конструктора до конца прогона
+    size_t entries = 0;
+    double bytesPerEntry() const { return entries ? (double)live_bytes / entries : 0.0; }
+    double fragmentation() const {
+        return live_bytes > 0 ? (double)(live_bytes - requested_bytes) / live_bytes * 100.0 : 0.0;
+    }
 };
 
-// «Оракул» для определения горячих ключей
-struct HotOracle {
-    int hot_limit = 0;
-    bool isHot(int key) const { return key >= 0 && key < hot_limit; }
+// Снимки до конструктора, после него и в конце; кэш должен жить внутри этого окна
+class MemoryProbe {
+public:
+    MemoryProbe() : rss0_((releaseFreeHeap(), residentBytes())), start_(allocSnapshot()), built_(start_) {}
+    void constructed() { built_ = allocSnapshot(); }
+    MemoryMeasure finish(size_t entries) const {
+        AllocStats end = allocSnapshot();
+        AllocStats all = allocDelta(start_, end), run = allocDelta(built_, end);
+        MemoryMeasure m;
+        m.live_bytes = all.live_usable;
+        m.requested_bytes = all.live_requested;
+        m.run_allocs = run.allocs;
+        m.run_alloc_bytes = run.requested;
+        m.rss_delta = (long long)residentBytes() - (long long)rss0_;
+        m.entries = entries;
+        return m;
+    }
+private:
+    size_t rss0_;
+    AllocStats start_, built_;
+};
+
+// Учёт полезных/вредных вытеснений: слушатель вешается на экземпляр кэша
+// на время прогона. Явные удаления и истечения TTL сюда не считаются.
+// op — номер текущей операции нагрузки для оракула с дрейфом; прогон обновляет
+// его на границах фаз дрейфа (внутри фазы сдвиг один и тот же).
+struct EvictionAccounting : EvictionListener {
+    HotOracle oracle;
+    long long useful = 0;
+    long long harmful = 0;
+    long long op = 0;
+    explicit EvictionAccounting(HotOracle o) : oracle(o) {}
+    void onEvict(int key, int, EvictReason reason) override {
+        if (reason != EvictReason::Capacity) return;
+        if (oracle.isHot(key, op)) harmful++;
+        else                       useful++;
+    }
 };
 
-// Замер сценария + сбор warmup метрики
+// То же для потоков. onEvict зовётся в потоке, выполнившем операцию (у ShardedCache —
+// под мьютексом шарда), поэтому у каждого потока свой слот на отдельной кэш-линии
+// и обычные инкременты, а не атомик на общей линии. Рабочий поток выбирает слот
+// bindThread(1..threads) до первой операции; остальные пишут в слот 0. Номер
+// операции для оракула с дрейфом — тоже свой у потока (at). Суммы
+// useful()/harmful() читаются после join.
+class SharedEvictionAccounting : public EvictionListener {
+public:
+    SharedEvictionAccounting(HotOracle o, int threads) : oracle_(o), slots_(threads + 1) {}
+    static void bindThread(int slot) { slot_ = slot; }
+    const HotOracle& oracle() const { return oracle_; }
+    void at(long long op) { mine().op = op; }
+    void onEvict(int key, int, EvictReason reason) override {
+        if (reason != EvictReason::Capacity) return;
+        Slot& s = mine();
+        if (oracle_.isHot(key, s.op)) s.harmful++;
+        else                          s.useful++;
+    }
+    long long useful() const {
+        long long n = 0;
+        for (const auto& s : slots_) n += s.useful;
+        return n;
+    }
+    long long harmful() const {
+        long long n = 0;
+        for (const auto& s : slots_) n += s.harmful;
+        return n;
+    }
+private:
+    struct alignas(64) Slot { long long useful = 0, harmful = 0, op = 0; };
+    HotOracle oracle_;
+    std::vector<Slot> slots_;
+    static inline thread_local int slot_ = 0;
+
+    Slot& mine() { return slots_[(size_t)slot_ < slots_.size() ? slot_ : 0]; }
+};
+
+// Подключение слушателя к ICache или к шаблонному кэшу с DynamicEvictionListener;
+// у кэша с NoEvictionListener учёта вытеснений нет вовсе.
+template <class Cache>
+void attachEvictionListener(Cache& cache, EvictionListener* l) {
+    if constexpr (std::is_base_of_v<ICache, Cache>) cache.setEvictionListener(l);
+    else if constexpr (std::is_same_v<typename Cache::listener_type, DynamicEvictionListener>) cache.listener().target = l;
+}
+
+// События переключения AdaptiveCache; step — окно warmup.csv (по 1000 операций
+// после прогрева prefill ключами), чтобы события ложились на ту же ось
+void writeSwitches(std::ofstream& out, const char* workload, const AdaptiveCache& c, long long prefill, int window = 1000) {
+    for (const auto& e : c.switches())
+        out << workload << "," << e.op << "," << (e.op - prefill) / window << "," << policyName(e.from) << ","
+            << policyName(e.to) << "," << e.lru_hit_rate << "," << e.lfu_hit_rate << "\n";
+}
+
+// Замер сценария + сбор warmup метрики.
+// Шаблон: для конкретного типа кэша вызовы get/put инлайнятся,
+// для ICache остаются виртуальными.
+template <class Cache>
+long long runScenarioT(Cache& cache, const Workload& wl, RunContext& ctx, int window = 1000) {
+    EvictionAccounting acc(HotOracle::of(wl));
+    attachEvictionListener(cache, &acc);
+
+    if (ctx.perf) ctx.perf->start();
+    auto t0 = Clock::now();
+
+    // Прогрев кэша: положим половину ёмкости
+    if (ctx.prefill)
+        for (int k = 0; k < (int)cache.capacity() / 2; ++k) cache.put(k, k * 10);
+
+    OpCounters last;
+
+    auto step = [&](size_t i) {
+        int x = wl.ops[i];
+        if (!wl.isWrite(i)) (void)cache.get(x);
+        else                cache.put(x, x * 10);
+    };
+    // Всё, что делается не на каждой операции (замер задержки, выборка телеметрии,
+    // конец окна), — «события» с заранее известным номером операции. Между событиями
+    // идёт голый цикл step без счётчиков и ветвлений.
+    constexpr size_t kNever = SIZE_MAX;
+    const size_t n = wl.ops.size();
+    std::optional<WindowProbe> probe;
+    if (ctx.telemetry && ctx.telemetry_window > 0) probe.emplace(*ctx.telemetry);
+    size_t next_lat = ctx.latency ? 0 : kNever;
+    size_t next_tel = probe ? kTelemetrySampleEvery - 1 : kNever;
+    size_t next_win = window > 0 ? (size_t)window - 1 : kNever;
+    size_t next_twin = probe ? (size_t)ctx.telemetry_window - 1 : kNever;
+    // Граница фазы дрейфа — тоже событие: учёт вытеснений узнаёт новый номер операции
+    const size_t drift = acc.oracle.drifts() ? (size_t)acc.oracle.drift_period : 0;
+    size_t next_drift = drift ? drift : kNever;
+
+    for (size_t i = 0; i < n; ++i) {
+        size_t stop = std::min({next_lat, next_tel, next_win, next_twin, next_drift, n});
+        for (; i < stop; ++i) step(i);
+        if (i == n) break;
+
+        if (i == next_drift) { acc.op = (long long)i; next_drift += drift; }
+
+        if (i == next_lat || i == next_tel) {
+            uint64_t s = latencyTicks();
+            step(i);
+            uint64_t d = latencyTicks() - s;
+            if (i == next_lat) { ctx.latency->record(d); next_lat += ctx.latency_every; }
+            if (i == next_tel) { probe->sample(d); next_tel += kTelemetrySampleEvery; }
+        } else {
+            step(i);
+        }
+
+        if (i == next_win) {
+            next_win += window;
+            const OpCounters& c = cache.counters();
+            ctx.warm.hit_rates_over_time.push_back(hitRate(delta(c, last)));
+            last = c;
+        }
+        if (i == next_twin) {
+            next_twin += ctx.telemetry_window;
+            probe->closeWindow(cache.counters(), i + 1);
+        }
+    }
+
+    auto t1 = Clock::now();
+    if (ctx.perf) ctx.perf_sample = ctx.perf->stop();
+    attachEvictionListener(cache, nullptr);
+    ctx.useful_evict  += acc.useful;
+    ctx.harmful_evict += acc.harmful;
+    return std::chrono::duration_cast<Ns>(t1 - t0).count();
+}
+
 long long runScenario(ICache& cache, const Workload& wl, RunContext& ctx, int window = 1000) {
-    HotOracle oracle{wl.hot_limit};
+    return runScenarioT<ICache>(cache, wl, ctx, window);
+}
 
-    g_on_evict_key = [&](int key) {
-        if (oracle.isHot(key)) ctx.harmful_evict++;
-        else                   ctx.useful_evict++;
+// Пакетный сценарий: подряд идущие чтения уходят одним getMany, подряд идущие
+// записи — одним putMany, не больше batch операций в вызове (как в multi-get API).
+// Пакет обрывается на смене типа операции, поэтому порядок операций не меняется
+// и hit rate совпадает с поштучным прогоном; calls — сколько вызовов вышло.
+long long runScenarioBatched(ICache& cache, const Workload& wl, size_t batch, long long* calls = nullptr) {
+    for (int k = 0; k < (int)cache.capacity() / 2; ++k) cache.put(k, k * 10);
+
+    std::vector<int> gk, pk, pv;
+    std::vector<std::optional<int>> out(batch);
+    gk.reserve(batch); pk.reserve(batch); pv.reserve(batch);
+    long long n = 0;
+    auto flush = [&] {
+        if (!gk.empty()) { cache.getMany(gk.data(), gk.size(), out.data()); gk.clear(); n++; }
+        if (!pk.empty()) { cache.putMany(pk.data(), pv.data(), pk.size()); pk.clear(); pv.clear(); n++; }
     };
 
     auto t0 = Clock::now();
+    for (size_t i = 0; i < wl.ops.size(); ++i) {
+        int x = wl.ops[i];
+        if (!wl.isWrite(i)) {
+            if (!pk.empty() || gk.size() == batch) flush();
+            gk.push_back(x);
+        } else {
+            if (!gk.empty() || pk.size() == batch) flush();
+            pk.push_back(x); pv.push_back(x * 10);
+        }
+    }
+    flush();
+    auto t1 = Clock::now();
+    if (calls) *calls = n;
+    return std::chrono::duration_cast<Ns>(t1 - t0).count();
+}
 
-    // Прогрев кэша: положим половину ёмкости
+// Итог многопоточного прогона
+struct MTResult {
+    long long elapsed_ns = 0;
+    long long ops = 0;
+    long long hits = 0;
+    long long misses = 0;
+    long long useful_evict = 0;
+    long long harmful_evict = 0;
+    double opsPerSec() const { return elapsed_ns ? ops / (elapsed_ns / 1e9) : 0.0; }
+    double hitRate() const { return (hits + misses) ? (double)hits / (hits + misses) * 100.0 : 0.0; }
+};
+
+// Многопоточный сценарий: wl.ops режется на threads непрерывных кусков,
+// каждый поток гоняет свой кусок. Кэш должен быть потокобезопасным (ShardedCache).
+MTResult runScenarioMT(ICache& cache, const Workload& wl, int threads) {
+    SharedEvictionAccounting acc(HotOracle::of(wl), threads);
+    cache.setEvictionListener(&acc);
     for (int k = 0; k < (int)cache.capacity() / 2; ++k) cache.put(k, k * 10);
 
-    int ops_done = 0;
-    long long last_hits = 0, last_misses = 0;
+    std::vector<MTResult> parts(threads);
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> pool;
+    size_t chunk = (wl.ops.size() + threads - 1) / threads;
+
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            size_t begin = std::min(wl.ops.size(), t * chunk);
+            size_t end   = std::min(wl.ops.size(), begin + chunk);
+            SharedEvictionAccounting::bindThread(t + 1);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            // Счётчики — в локальных переменных: соседние parts[t] делят кэш-линию,
+            // и инкремент на каждый get гонял бы её между ядрами (false sharing)
+            long long hits = 0, misses = 0;
+            const HotOracle& o = acc.oracle();
+            size_t next_phase = o.drifts() ? begin : end;
+            for (size_t i = begin; i < end; ++i) {
+                if (i == next_phase) { acc.at((long long)i); next_phase = (i / o.drift_period + 1) * o.drift_period; }
+                int x = wl.ops[i];
+                if (!wl.isWrite(i)) { if (cache.get(x)) hits++; else misses++; }
+                else                cache.put(x, x * 10);
+            }
+            MTResult& r = parts[t];
+            r.hits = hits;
+            r.misses = misses;
+            r.ops = (long long)(end - begin);
+        });
+    }
+    while (ready.load() < threads) std::this_thread::yield();
+    auto t0 = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (auto& th : pool) th.join();
+    auto t1 = Clock::now();
+    cache.setEvictionListener(nullptr);
+
+    MTResult total;
+    total.elapsed_ns = std::chrono::duration_cast<Ns>(t1 - t0).count();
+    for (const auto& r : parts) {
+        total.ops += r.ops; total.hits += r.hits; total.misses += r.misses;
+    }
+    total.useful_evict = acc.useful();
+    total.harmful_evict = acc.harmful();
+    return total;
+}
+
+// Нагрузка с TTL: у ключа фиксированный срок жизни из смеси
+// «без срока / короткий / средний / долгий». Время — один тик на операцию.
+struct TTLWorkload {
+    Workload wl;
+    std::vector<uint32_t> ttl;       // TTL по ключу в тиках, 0 — без срока
+};
+
+TTLWorkload makeTTLWorkload(int total_ops, int universe) {
+    TTLWorkload tw;
+    tw.wl = makeWorkload(total_ops, universe, 0.75);
+    const uint32_t mix[4] = {0, 500, 5000, 50000};
+    std::mt19937 rng(11);
+    tw.ttl.resize(universe);
+    for (auto& t : tw.ttl) t = mix[rng() % 4];
+    return tw;
+}
 
-    for (int x : wl.ops) {
-        if (x % 10 < 7) (void)cache.get(x);
-        else            cache.put(x, x * 10);
+// Synthetic Workload -> бинарная трасса; тип операции — Workload::isWrite, как в runScenarioT
+bool writeWorkloadTrace(const Workload& wl, const std::string& path) {
+    TraceWriter w;
+    if (!w.open(path)) return false;
+    TraceRecord r;
+    for (size_t i = 0; i < wl.ops.size(); ++i) {
+        r.key = wl.ops[i];
+        r.op = wl.isWrite(i) ? kTracePut : kTraceGet;
+        w.append(r);
+    }
+    return w.close();
+}
 
-        ops_done++;
-        if (window > 0 && (ops_done % window == 0)) {
-            const auto& c = cache.counters();
-            long long dh = c.hits   - last_hits;
-            long long dm = c.misses - last_misses;
-            double hr = (dh + dm) ? (double)dh / (dh + dm) * 100.0 : 0.0;
-            ctx.warm.hit_rates_over_time.push_back(hr);
-            last_hits   = c.hits;
-            last_misses = c.misses;
+struct TraceRunResult {
+    bool ok = false;
+    long long records = 0;
+    long long elapsed_ns = 0;     // только операции кэша (+ прогрев, как в runScenarioT)
+    long long decode_ns = 0;      // чтение и разбор трассы — вне замера
+};
+
+// Воспроизведение трассы из отображённого файла: записи разбираются кусками
+// по chunk в переиспользуемый буфер, и в замер попадает только прогон куска по кэшу.
+template <class Cache>
+TraceRunResult runScenarioTrace(Cache& cache, const MappedFile& file, size_t chunk = 1 << 16) {
+    TraceRunResult res;
+    TraceReader reader(file);
+    if (!reader.valid()) return res;
+    std::vector<TraceRecord> buf(chunk);
+
+    auto t0 = Clock::now();
+    for (int k = 0; k < (int)cache.capacity() / 2; ++k) cache.put(k, k * 10);
+    res.elapsed_ns += std::chrono::duration_cast<Ns>(Clock::now() - t0).count();
+
+    for (;;) {
+        auto d0 = Clock::now();
+        size_t n = reader.next(buf.data(), chunk);
+        auto d1 = Clock::now();
+        res.decode_ns += std::chrono::duration_cast<Ns>(d1 - d0).count();
+        if (n == 0) break;
+        for (size_t i = 0; i < n; ++i) {
+            const TraceRecord& r = buf[i];
+            if (r.op == kTraceGet) (void)cache.get(r.key);
+            else                   cache.put(r.key, r.key * 10);
         }
+        res.elapsed_ns += std::chrono::duration_cast<Ns>(Clock::now() - d1).count();
+        res.records += (long long)n;
+    }
+    res.ok = reader.valid();
+    return res;
+}
+
+// Строки trace_replay.csv по основным движкам для одной трассы
+void replayTraceEngines(std::ostream& out, const char* source, const MappedFile& file, int capacity) {
+    auto replay = [&](const char* algo, const char* impl, ICache& c) {
+        TraceRunResult r = runScenarioTrace(c, file, 1 << 16);
+        if (!r.ok) { std::cerr << "Трасса повреждена: " << source << "\n"; return; }
+        const auto& cnt = c.counters();
+        double hr = hitRate(cnt);
+        double n = r.records ? (double)r.records : 1.0;
+        out << source << "," << algo << "," << impl << "," << capacity << "," << r.records << ","
+            << file.size() << "," << file.size() / n << "," << r.decode_ns << "," << r.elapsed_ns << ","
+            << r.elapsed_ns / n << "," << hr << "\n";
+    };
+    for (const EngineEntry* e : selectEngineList({"LRU/flat", "LFU/pool", "TinyLFU/window", "ARC/ghost", "CLOCK/lockfree"}))
+        replay(e->algo.c_str(), e->impl.c_str(), *e->make(capacity));
+}
+
+const char* kTraceReplayHeader =
+    "source,algo,impl,capacity,records,file_bytes,bytes_per_record,decode_ns,elapsed_ns,avg_ns,hit_rate\n";
+
+// Тот же цикл, что в runScenarioT, но перед каждой операцией время
+// продвигается на тик, а put передаёт TTL ключа (with_ttl = false — всегда 0).
+template <class Cache>
+long long runScenarioTTL(Cache& cache, const TTLWorkload& tw, RunContext& ctx, bool with_ttl = true) {
+    EvictionAccounting acc(HotOracle::of(tw.wl));
+    attachEvictionListener(cache, &acc);
+
+    auto t0 = Clock::now();
+    for (int k = 0; k < (int)cache.capacity() / 2; ++k) cache.put(k, k * 10, with_ttl ? tw.ttl[k] : 0);
+
+    uint64_t tick = cache.now();
+    for (size_t i = 0; i < tw.wl.ops.size(); ++i) {
+        int x = tw.wl.ops[i];
+        acc.op = (long long)i;
+        cache.advanceTime(++tick);
+        if (!tw.wl.isWrite(i)) (void)cache.get(x);
+        else                   cache.put(x, x * 10, with_ttl ? tw.ttl[x] : 0);
     }
 
     auto t1 = Clock::now();
-    g_on_evict_key = nullptr;
+    attachEvictionListener(cache, nullptr);
+    ctx.useful_evict  += acc.useful;
+    ctx.harmful_evict += acc.harmful;
     return std::chrono::duration_cast<Ns>(t1 - t0).count();
 }
 
-// Доп. метрика 11 — стоимость операции
-double calculateCostPerOperation(long long total_time_ns, long long operations, double time_value = 1.0) {
-    double time_in_seconds = total_time_ns / 1e9;
+// Нагрузка с объектами разного размера: у каждого ключа свой фиксированный
+// размер значения, распределённый лог-равномерно в [min_size, max_size].
+struct SizedWorkload {
+    Workload wl;
+    std::vector<uint32_t> sizes;     // размер значения по ключу
+};
+
+SizedWorkload makeSizedWorkload(int total_ops, int universe, uint32_t min_size, uint32_t max_size) {
+    SizedWorkload sw;
+    sw.wl = makeWorkload(total_ops, universe, 0.75);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> u(std::log((double)min_size), std::log((double)max_size));
+    sw.sizes.resize(universe);
+    for (auto& s : sw.sizes) s = (uint32_t)std::exp(u(rng));
+    return sw;
+}
+
+struct SizedResult {
+    long long elapsed_ns = 0;
+    long long gets = 0, hits = 0;
+    long long req_bytes = 0, hit_bytes = 0;
+    double hitRate() const { return gets ? (double)hits / gets * 100.0 : 0.0; }
+    double byteHitRate() const { return req_bytes ? (double)hit_bytes / req_bytes * 100.0 : 0.0; }
+};
+
+// Сценарий с подкачкой по промаху: каждый запрос — get, при промахе значение
+// «загружается» (put с размером и стоимостью, байты пишутся в арену).
+// Помимо доли попаданий по объектам считаем долю по байтам.
+template <class CostFn>
+SizedResult runScenarioSized(GDSCache& cache, const SizedWorkload& sw, CostFn cost) {
+    SizedResult r;
+    auto t0 = Clock::now();
+    for (int x : sw.wl.ops) {
+        uint32_t bytes = sw.sizes[x];
+        r.gets++;
+        r.req_bytes += bytes;
+        if (cache.get(x)) { r.hits++; r.hit_bytes += bytes; continue; }
+        cache.put(x, x * 10, bytes, cost(bytes));
+        if (char* p = cache.payload(x)) std::memset(p, x & 0xFF, bytes);
+    }
+    r.elapsed_ns = std::chrono::duration_cast<Ns>(Clock::now() - t0).count();
+    return r;
+}
+
+// Доп. метрика 11 — стоимость операции: время самого кэша плюс штраф промаха
+// (средняя задержка загрузки из бэкенда) на каждый промах, в секундах на операцию
+double calculateCostPerOperation(long long total_time_ns, long long operations, long long misses = 0,
+                                 double miss_penalty_ns = 0.0, double time_value = 1.0) {
+    double time_in_seconds = (total_time_ns + misses * miss_penalty_ns) / 1e9;
     return (operations > 0) ? (time_in_seconds * time_value) / operations : 0.0;
 }
 
@@ -116,7 +531,7 @@ CacheMetricsRow collectRow(const char* algo, const char* impl, const ICache& c,
 
     const auto& cnt = c.counters();
     row.gets = cnt.gets; row.puts = cnt.puts; row.evictions = cnt.evictions;
-    row.hit_rate  = (cnt.hits + cnt.misses) ? (double)cnt.hits / (cnt.hits + cnt.misses) * 100.0 : 0.0;
+    row.hit_rate  = hitRate(cnt);
     row.miss_rate = 100.0 - row.hit_rate;
     row.avg_time_ns = total_ops ? (double)elapsed_ns / total_ops : 0.0;
     row.ops_per_sec = elapsed_ns ? (double)total_ops / (elapsed_ns / 1e9) : 0.0;
@@ -139,6 +554,53 @@ CacheMetricsRow collectRow(const char* algo, const char* impl, const ICache& c,
     return row;
 }
 
+// Строка results_extended.csv
+void writeResultRow(std::ofstream& csv, const CacheMetricsRow& r, int warmup_ops, double cost_per_op, double frag_ratio,
+                    const PerfSample& perf, long long total_ops) {
+    csv << r.algo << "," << r.impl << "," << r.capacity << "," << r.elapsed_ns << ","
+        << r.gets << "," << r.puts << "," << r.evictions << ","
+        << r.hit_rate << "," << r.miss_rate << "," << r.avg_time_ns << "," << r.ops_per_sec << ","
+        << r.useful_evictions << "," << r.harmful_evictions << "," << r.eviction_efficiency << ","
+        << r.theoretical_memory << "," << r.actual_memory << "," << r.overhead_memory << ","
+        << r.memory_efficiency << "," << r.overhead_pct << ","
+        << warmup_ops << "," << cost_per_op << "," << frag_ratio << ","
+        << r.p50_ns << "," << r.p99_ns << "," << r.p999_ns << "," << r.max_ns;
+    writePerfColumns(csv, perf, total_ops);
+    csv << "," << r.estimated_memory << "," << r.bytes_per_entry << "," << r.allocs_per_op << ","
+        << r.alloc_bytes_per_op << "," << r.rss_delta;
+    csv << "\n";
+}
+
+// Серия warmup.csv одного варианта кэша
+void writeWarmupSeries(std::ofstream& out, const char* algo, const char* impl, const WarmupSeries& w) {
+    for (size_t i = 0; i < w.hit_rates_over_time.size(); ++i)
+        out << algo << "," << impl << "," << i << "," << w.hit_rates_over_time[i] << "\n";
+}
+
+// Окон до 95% от установившегося hit rate (среднее по последней четверти серии)
+int windowsToSteady(const std::vector<double>& hr) {
+    if (hr.empty()) return 0;
+    size_t from = hr.size() - hr.size() / 4;
+    double steady = 0.0;
+    for (size_t i = from; i < hr.size(); ++i) steady += hr[i];
+    steady /= (double)(hr.size() - from);
+    for (size_t i = 0; i < hr.size(); ++i)
+        if (hr[i] >= 0.95 * steady) return (int)i;
+    return (int)hr.size();
+}
+
+void writeLatencyHistogram(std::ofstream& out, const char* algo, const char* impl, const LatencyHistogram& h) {
+    double k = latencyNsPerTick();
+    uint64_t seen = 0;
+    for (int i = 0; i < LatencyHistogram::kBuckets && seen < h.count(); ++i) {
+        uint64_t c = h.countAt(i);
+        if (!c) continue;
+        seen += c;
+        out << algo << "," << impl << "," << LatencyHistogram::bucketLow(i) * k << ","
+            << (LatencyHistogram::bucketHigh(i) + 1) * k << "," << c << "," << (double)seen / h.count() << "\n";
+    }
+}
+
 // Простые юнит‑тесты корректности поведения LRU / LFU (итеративные версии)
 void runBasicCacheTests() {
     std::cout << "\n--- Проверка корректности LRU/LFU ---\n";
@@ -154,6 +616,15 @@ void runBasicCacheTests() {
                   && lru.get(1).value_or(-1) == 10 && lru.get(3).value_or(-1) == 30;
         std::cout << "LRU (iter) Test: " << (ok ? "OK" : "FAIL") << "\n";
     }
+    {
+        LRUCacheFlat lru(2);
+        lru.put(1, 10); lru.put(2, 20);
+        auto v1 = lru.get(1);
+        lru.put(3, 30);
+        bool ok = (!lru.get(2).has_value()) && v1.value_or(-1) == 10
+                  && lru.get(1).value_or(-1) == 10 && lru.get(3).value_or(-1) == 30;
+        std::cout << "LRU (flat) Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
 
     // Тест LFU: с частотами (1 используется чаще 2) — при вставке 3 вытесняется 2.
     {
@@ -165,12 +636,869 @@ void runBasicCacheTests() {
                   && lfu.get(3).value_or(-1) == 30;
         std::cout << "LFU (iter) Test: " << (ok ? "OK" : "FAIL") << "\n";
     }
+
+    // Тест LFU (pool): то же поведение + при равной частоте вытесняется самый давний.
+    {
+        LFUCachePool lfu(2);
+        lfu.put(1, 10); lfu.put(2, 20);
+        (void)lfu.get(1);
+        lfu.put(3, 30);
+        bool ok = (!lfu.get(2).has_value()) && lfu.get(1).value_or(-1) == 10
+                  && lfu.get(3).value_or(-1) == 30;
+        LFUCachePool tie(2);
+        tie.put(1, 10); tie.put(2, 20);
+        (void)tie.get(1); (void)tie.get(2);   // freq(1) = freq(2) = 2, 1 — давний
+        tie.put(3, 30);
+        ok = ok && !tie.get(1).has_value() && tie.get(2).value_or(-1) == 20;
+        std::cout << "LFU (pool) Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест Rec: Plain и Indexed дают одинаковые ответы и вытеснения (LRU — ещё и как flat);
+    // список на 1M записей освобождается без рекурсии.
+    {
+        LRUCacheRec lp(16), li(16, RecMode::Indexed);
+        LRUCacheFlat lf(16);
+        LFUCacheRec fp(16), fi(16, RecMode::Indexed);
+        std::mt19937 rng(7);
+        bool ok = li.mode() == RecMode::Indexed && lp.mode() == RecMode::Plain;
+        for (int i = 0; i < 20000 && ok; ++i) {
+            int k = (int)(rng() % 64), op = (int)(rng() % 10);
+            if (op < 4) { lp.put(k, i); li.put(k, i); lf.put(k, i); fp.put(k, i); fi.put(k, i); }
+            else if (op < 9) {
+                auto a = lp.get(k);
+                ok = a == li.get(k) && a == lf.get(k) && fp.get(k) == fi.get(k);
+            } else {
+                bool a = lp.erase(k);
+                ok = a == li.erase(k) && a == lf.erase(k) && fp.erase(k) == fi.erase(k);
+            }
+        }
+        ok = ok && lp.counters().evictions == li.counters().evictions
+                && li.counters().evictions == lf.counters().evictions
+                && fp.counters().evictions == fi.counters().evictions && fp.size() == fi.size();
+        {
+            LFUCacheRec big(1 << 20, RecMode::Indexed);
+            for (int k = 0; k < (1 << 20); ++k) big.put(k, k);
+            ok = ok && big.get(0).value_or(-1) == 0 && big.size() == (size_t)1 << 20;
+        }
+        // Второй (латентность и память) прогон results_extended.csv строит экземпляр
+        // той же фабрикой реестра: rec-idx должен остаться Indexed, а не стать Plain
+        for (const char* name : {"LRU/rec-idx", "LFU/rec-idx"}) {
+            auto fresh = findEngine(name)->make(16);
+            auto* lr = dynamic_cast<LRUCacheRec*>(fresh.get());
+            auto* fr = dynamic_cast<LFUCacheRec*>(fresh.get());
+            ok = ok && ((lr && lr->mode() == RecMode::Indexed) || (fr && fr->mode() == RecMode::Indexed));
+        }
+        releaseFreeHeap();   // освобождённые страницы не должны достаться следующим тестам
+        std::cout << "Rec Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест SetAssoc: скалярное, SSE2 и AVX2 сравнение тегов дают одни и те же ответы;
+    // записей не больше ёмкости (100 — неполный последний набор); в одном наборе
+    // PLRU после заполнения по порядку вытесняет первый ключ, LFU — самый редкий.
+    {
+        bool ok = true;
+        for (int ways : {8, 16})
+            for (SetPolicy pol : {SetPolicy::PLRU, SetPolicy::LFU}) {
+                SetAssocCache sc(100, ways, pol, SimdLevel::Scalar), s2(100, ways, pol, SimdLevel::SSE2),
+                              sv(100, ways, pol, SimdLevel::AVX2);
+                std::mt19937 rng(11);
+                for (int i = 0; i < 20000 && ok; ++i) {
+                    int k = (int)(rng() % 400), op = (int)(rng() % 10);
+                    if (op < 4) { sc.put(k, i); s2.put(k, i); sv.put(k, i); }
+                    else if (op < 9) { auto a = sc.get(k); ok = a == s2.get(k) && a == sv.get(k); }
+                    else { bool a = sc.erase(k); ok = a == s2.erase(k) && a == sv.erase(k); }
+                    ok = ok && sc.size() <= 100;
+                }
+                ok = ok && sc.counters().evictions == sv.counters().evictions && sc.size() == s2.size();
+            }
+        SetAssocCache pl(8, 8, SetPolicy::PLRU);
+        for (int k = 0; k < 8; ++k) pl.put(k, k);
+        pl.put(8, 8);
+        ok = ok && !pl.get(0).has_value() && pl.get(7).value_or(-1) == 7;
+        pl.put(9, 9);
+        ok = ok && pl.get(8).value_or(-1) == 8 && pl.size() == 8;
+        SetAssocCache lf(8, 8, SetPolicy::LFU);
+        for (int k = 0; k < 8; ++k) lf.put(k, k);
+        for (int k = 1; k < 8; ++k) (void)lf.get(k);
+        lf.put(8, 8);
+        ok = ok && !lf.get(0).has_value() && lf.get(1).value_or(-1) == 1;
+        std::cout << "SetAssoc Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест Adaptive: без переключений ведёт себя ровно как LRUCacheIter или LFUCacheIter;
+    // когда частые ключи перемежаются сканами длиннее ёмкости, уходит в LFU, а когда
+    // по кругу идёт новое множество меньше ёмкости (LFU держит старые частые ключи
+    // и гоняет новые через оставшиеся места) — возвращается в LRU.
+    {
+        bool ok = true;
+        AdaptiveSpec frozen;
+        frozen.margin_pp = 1e9;
+        AdaptiveCache al(32, frozen);
+        frozen.initial = AdaptivePolicy::LFU;
+        AdaptiveCache af(32, frozen);
+        LRUCacheIter rl(32); LFUCacheIter rf(32);
+        std::mt19937 rng(5);
+        for (int i = 0; i < 20000 && ok; ++i) {
+            int k = (int)(rng() % 96), op = (int)(rng() % 10);
+            if (op < 4) { al.put(k, i); rl.put(k, i); af.put(k, i); rf.put(k, i); }
+            else if (op < 9) ok = al.get(k) == rl.get(k) && af.get(k) == rf.get(k);
+            else ok = al.erase(k) == rl.erase(k) && af.erase(k) == rf.erase(k);
+        }
+        ok = ok && al.switches().empty() && af.switches().empty()
+                && al.counters().evictions == rl.counters().evictions
+                && af.counters().evictions == rf.counters().evictions && af.size() == rf.size();
+
+        AdaptiveCache ad(512);
+        for (int r = 0; r < 30; ++r) {
+            for (int k = 0; k < 200; ++k) { if (!ad.get(k)) ad.put(k, k); (void)ad.get(k); }
+            for (int j = 0; j < 1000; ++j) { int k = 100000 + r * 1000 + j; if (!ad.get(k)) ad.put(k, k); }
+        }
+        ok = ok && ad.policy() == AdaptivePolicy::LFU && ad.get(0).has_value();
+        for (int r = 0; r < 100; ++r)
+            for (int k = 10000; k < 10400; ++k) if (!ad.get(k)) ad.put(k, k);
+        const auto& sw = ad.switches();
+        ok = ok && ad.policy() == AdaptivePolicy::LRU && sw.size() >= 2
+                && sw[0].to == AdaptivePolicy::LFU && sw[1].to == AdaptivePolicy::LRU
+                && ad.get(10000).has_value() && ad.get(10399).has_value();
+        std::cout << "Adaptive Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест телеметрии: кольцо отдаёт записи по порядку и не принимает лишнюю,
+    // поток через runScenarioT пишет по записи на окно, счётчики окон в сумме
+    // совпадают со счётчиками кэша.
+    {
+        SpscRing<int> ring(3);
+        bool ok = ring.capacity() == 4;
+        for (int i = 0; i < 4; ++i) ok = ok && ring.push(i);
+        ok = ok && !ring.push(4);
+        int v = -1;
+        for (int i = 0; i < 4; ++i) ok = ok && ring.pop(v) && v == i;
+        ok = ok && !ring.pop(v) && ring.push(5) && ring.pop(v) && v == 5;
+
+        const char* path = "telemetry_selftest.bin";
+        WorkloadSpec spec;
+        spec.universe = 5000; spec.ops = 50000; spec.write_ratio = 0.3;
+        Workload wl = generateWorkload(spec);
+        LRUCacheFlat c(1000);
+        long long hits = 0, misses = 0, puts = 0, evictions = 0;
+        uint64_t end_op = 0;
+        long long written = 0;
+        {
+            TelemetryStream tel(path, TelemetryFormat::Binary, "selftest");
+            RunContext rc;
+            rc.telemetry = &tel;
+            runScenarioT(c, wl, rc);
+            tel.stop();
+            written = tel.written();
+            ok = ok && tel.dropped() == 0;
+        }
+        MappedFile mf;
+        if (mf.open(path) && mf.size() > 16) {
+            const char* p = reinterpret_cast<const char*>(mf.data());
+            uint32_t rec = 0, len = 0;
+            std::memcpy(&rec, p + 8, 4);
+            std::memcpy(&len, p + 12, 4);
+            size_t off = 16 + len + sizeof(double);
+            ok = ok && std::memcmp(p, "CTELEM1", 8) == 0 && rec == sizeof(WindowRecord)
+                    && (mf.size() - off) / rec == (size_t)written;
+            for (; off + rec <= mf.size(); off += rec) {
+                WindowRecord r;
+                std::memcpy(&r, p + off, rec);
+                hits += r.hits; misses += r.misses; puts += r.puts; evictions += r.evictions;
+                end_op = r.end_op;
+            }
+        } else ok = false;
+        const OpCounters& cc = c.counters();
+        ok = ok && written == 5 && end_op == 50000 && hits == cc.hits && misses == cc.misses
+                && puts == cc.puts && evictions == cc.evictions;
+        std::remove(path);
+        std::cout << "Telemetry Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест getMany/putMany: тот же результат и счётчики, что и поштучно.
+    {
+        const int keys[] = {1, 2, 3, 1, 4, 2, 5, 1};
+        const int vals[] = {10, 20, 30, 11, 40, 21, 50, 12};
+        auto same = [&](ICache& batched, ICache& single) {
+            batched.putMany(keys, vals, 8);
+            for (int i = 0; i < 8; ++i) single.put(keys[i], vals[i]);
+            std::optional<int> a[8];
+            batched.getMany(keys, 8, a);
+            bool eq = true;
+            for (int i = 0; i < 8; ++i) eq = eq && a[i] == single.get(keys[i]);
+            const auto& cb = batched.counters();
+            const auto& cs = single.counters();
+            return eq && cb.hits == cs.hits && cb.misses == cs.misses && cb.evictions == cs.evictions;
+        };
+        LRUCacheIter a1(3), a2(3); LFUCacheIter b1(3), b2(3);
+        LRUCacheFlat c1(3), c2(3); LFUCachePool d1(3), d2(3);
+        bool ok = same(a1, a2) && same(b1, b2) && same(c1, c2) && same(d1, d2);
+        // Пакетный сценарий не переставляет чтения и записи: счётчики — как поштучно
+        Workload mixed = makeWorkload(20000, 2000, 0.75);
+        LRUCacheFlat p1(256), p32(256);
+        long long calls1 = 0, calls32 = 0;
+        runScenarioBatched(p1, mixed, 1, &calls1);
+        runScenarioBatched(p32, mixed, 32, &calls32);
+        ok = ok && calls1 == 20000 && calls32 < calls1 && p1.counters().hits == p32.counters().hits
+                && p1.counters().misses == p32.counters().misses
+                && p1.counters().evictions == p32.counters().evictions;
+        std::cout << "Batch Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест слушателей: свой у каждого экземпляра, получают значение и причину.
+    {
+        struct Log : EvictionListener {
+            std::vector<std::pair<int,int>> cap, erased;
+            void onEvict(int k, int v, EvictReason r) override {
+                (r == EvictReason::Erase ? erased : cap).push_back({k, v});
+            }
+        };
+        Log la, lb;
+        LRUCacheFlat a(1); LFUCachePool b(1);
+        a.setEvictionListener(&la); b.setEvictionListener(&lb);
+        a.put(1, 10); a.put(2, 20);            // 1 вытеснен по ёмкости
+        b.put(7, 70); bool erased = b.erase(7); b.put(8, 80);
+        bool ok = la.cap.size() == 1 && la.cap[0] == std::make_pair(1, 10) && la.erased.empty()
+                  && erased && lb.cap.empty() && lb.erased.size() == 1 && lb.erased[0] == std::make_pair(7, 70)
+                  && b.get(8).value_or(-1) == 80 && b.size() == 1;
+        std::cout << "Eviction listener Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест W-TinyLFU: редкий кандидат из окна не вытесняет частый ключ из probation.
+    {
+        TinyLFUCache t(2);                 // окно 1, основная область 1
+        t.put(1, 10);
+        (void)t.get(1); (void)t.get(1); (void)t.get(1);
+        t.put(2, 20);                      // 1 уходит из окна в probation
+        t.put(3, 30);                      // кандидат 2 (freq 1) против 1 (freq 4) — отклонён
+        bool ok = t.get(1).value_or(-1) == 10 && !t.get(2).has_value()
+                  && t.get(3).value_or(-1) == 30 && t.rejected() == 1 && t.size() == 2;
+        std::cout << "TinyLFU Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест устойчивости к сканам: ключи, к которым обращались повторно,
+    // переживают проход по втрое большему числу одноразовых ключей.
+    {
+        auto survivesScan = [](ICache& c) {
+            c.put(1, 10); c.put(2, 20);
+            for (int k = 1000; k < 1004; ++k) c.put(k, k);   // 2Q: 1 и 2 уходят в A1out
+            c.put(1, 10); c.put(2, 20);
+            (void)c.get(1); (void)c.get(2);
+            for (int k = 100; k < 112; ++k) c.put(k, k);
+            return c.get(1).value_or(-1) == 10 && c.get(2).value_or(-1) == 20 && c.size() == c.capacity();
+        };
+        ARCCache arc(4); TwoQCache twoq(4); SLRUCache slru(4);
+        bool ok = survivesScan(arc) && survivesScan(twoq) && survivesScan(slru);
+        std::cout << "Scan resistance Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест бинарной трассы: запись -> mmap -> чтение возвращает те же записи,
+    // обрезанный файл распознаётся.
+    {
+        const char* path = "trace_selftest.bin";
+        std::vector<TraceRecord> src = {
+            {5, kTraceGet, 64, 100}, {-7, kTracePut, 70000, 100}, {INT_MAX, kTraceGet, 1, 250},
+            {INT_MIN, kTracePut, 0, 1u << 31}, {3, kTraceGet, 4096, (1ull << 40)}};
+        TraceWriter w;
+        bool ok = w.open(path, trace::kHasSize | trace::kHasTime);
+        for (const auto& r : src) w.append(r);
+        ok = w.close() && ok;
+        {
+            MappedFile f;
+            ok = ok && f.open(path);
+            TraceReader rd(f);
+            TraceRecord got[8];
+            size_t n = rd.valid() ? rd.next(got, 8) : 0;
+            ok = ok && n == src.size() && rd.next(got, 8) == 0 && rd.valid();
+            for (size_t i = 0; ok && i < n; ++i)
+                ok = got[i].key == src[i].key && got[i].op == src[i].op
+                     && got[i].size == src[i].size && got[i].timestamp == src[i].timestamp;
+        }
+        {
+            // Отрезаем последний байт: последняя запись обрывается посреди варинта
+            std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+            MappedFile f;
+            ok = ok && f.open(path);
+            TraceReader rd(f);
+            TraceRecord got[8];
+            ok = ok && rd.next(got, 8) == src.size() - 1 && !rd.valid();
+        }
+        std::remove(path);
+        std::cout << "Trace Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест снимков: восстановленный кэш дальше ведёт себя как исходный (тот же
+    // порядок вытеснения и частоты); движок без снимков и непустой кэш — -1.
+    {
+        const char* path = "snapshot_selftest.bin";
+        std::mt19937 rng(11);
+        std::vector<int> keys(4000);
+        for (int& k : keys) k = (int)(rng() % 200);
+        auto drive = [&](ICache& c, size_t from, size_t to, std::vector<int>& got) {
+            for (size_t i = from; i < to; ++i) {
+                if (i % 3 == 0) c.put(keys[i], (int)i);
+                else got.push_back(c.get(keys[i]).value_or(-1));
+            }
+        };
+        auto same = [&](auto make) {
+            auto a = make();
+            std::vector<int> ga, gb;
+            drive(*a, 0, 2000, ga);
+            auto b = make();
+            if (saveSnapshot(*a, path) != (long long)a->size() || loadSnapshot(*b, path) != (long long)a->size())
+                return false;
+            ga.clear();
+            drive(*a, 2000, keys.size(), ga);
+            drive(*b, 2000, keys.size(), gb);
+            return ga == gb && b->size() == a->size();
+        };
+        bool ok = same([] { return std::make_unique<LRUCacheIter>(64); })
+               && same([] { return std::make_unique<LRUCacheRec>(64); })
+               && same([] { return std::make_unique<LRUCacheRec>(64, RecMode::Indexed); })
+               && same([] { return std::make_unique<LRUCacheFlat>(64); })
+               && same([] { return std::make_unique<LFUCacheIter>(64); })
+               && same([] { return std::make_unique<LFUCacheRec>(64); })
+               && same([] { return std::make_unique<LFUCacheRec>(64, RecMode::Indexed); })
+               && same([] { return std::make_unique<LFUCachePool>(64); })
+               && same([] { return std::make_unique<ClockCache>(64); })
+               && same([] { return std::make_unique<ShardedCache>(64, 4,
+                                [](size_t c) { return std::make_unique<LRUCacheFlat>(c); }); });
+        {
+            // Снимок LRU в меньший LFU: остаются самые свежие записи с частотой 1
+            LRUCacheFlat src(64);
+            for (int k = 0; k < 64; ++k) src.put(k, k);
+            LFUCachePool dst(16);
+            ok = ok && saveSnapshot(src, path) == 64 && loadSnapshot(dst, path) == 16
+                    && dst.get(63).value_or(-1) == 63 && !dst.get(47).has_value()
+                    && loadSnapshot(dst, path) == -1;
+            ARCCache arc(16);
+            ok = ok && saveSnapshot(arc, path) == -1;
+            // Подделанный count: 24 + 12 · (64 + 2^62) по модулю 2^64 равно размеру файла
+            uint64_t forged = 64 + (1ull << 62);
+            std::FILE* f = nullptr;
+            ok = ok && saveSnapshot(src, path) == 64 && (f = std::fopen(path, "r+b"))
+                    && std::fseek(f, 16, SEEK_SET) == 0 && std::fwrite(&forged, sizeof(forged), 1, f) == 1;
+            if (f) std::fclose(f);
+            LFUCachePool victim(16);
+            ok = ok && loadSnapshot(victim, path) == -1 && victim.size() == 0;
+        }
+        std::remove(path);
+        std::cout << "Snapshot Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест read-through: 8 потоков, промахнувшихся по одному ключу, дают одну
+    // загрузку; без single-flight — несколько; ошибка загрузчика доходит до вызывающего;
+    // средние распределений задержки бэкенда сходятся к mean_us.
+    {
+        bool ok = true;
+        for (bool sf : {true, false}) {
+            SimulatedBackend backend{BackendSpec{BackendLatency::Fixed, 20000.0, 1.0, true, 1}};
+            ShardedCache cache(16, 1, [](size_t c) { return std::make_unique<LRUCacheFlat>(c); });
+            ReadThroughCache rt(cache, [&](int k) { return backend.load(k); }, sf);
+            std::vector<int> got(8, -1);
+            std::vector<std::thread> pool;
+            for (int t = 0; t < 8; ++t) pool.emplace_back([&, t] { got[t] = rt.get(7); });
+            for (auto& th : pool) th.join();
+            ReadThroughStats st = rt.stats();
+            ok = ok && std::count(got.begin(), got.end(), 70) == 8 && rt.get(7) == 70
+                    && (sf ? st.loads == 1 && st.coalesced == 7 : st.loads > 1);
+        }
+        {
+            LRUCacheFlat cache(4);
+            ReadThroughCache rt(cache, [](int k) { if (k < 0) throw std::runtime_error("load"); return k; });
+            bool thrown = false;
+            try { rt.get(-1); } catch (const std::runtime_error&) { thrown = true; }
+            ok = ok && thrown && rt.get(3) == 3 && rt.get(3) == 3 && rt.stats().hits == 1 && cache.size() == 1;
+        }
+        for (BackendLatency d : {BackendLatency::Exponential, BackendLatency::LogNormal}) {
+            SimulatedBackend b{BackendSpec{d, 10.0, 1.0, false, 3}};
+            double sum = 0.0;
+            for (int i = 0; i < 200000; ++i) sum += b.sampleNs();
+            ok = ok && std::abs(sum / 200000 - 10000.0) < 300.0;
+        }
+        std::cout << "ReadThrough Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест TTL: запись снимается ровно на своём тике, а её место
+    // занимает новый ключ без вытеснения живых записей.
+    {
+        auto ttlOk = [](auto& c) {
+            c.put(1, 10, 5);
+            c.put(2, 20); c.put(3, 30);
+            c.advanceTime(4);
+            bool alive = c.get(1).value_or(-1) == 10;
+            c.advanceTime(5);
+            c.put(4, 40);                  // кэш не полон: 1 уже истёк
+            return alive && !c.get(1).has_value() && c.size() == 3
+                   && c.counters().expired == 1 && c.counters().evictions == 0;
+        };
+        LRUCacheFlat lru(3); LFUCachePool lfu(3);
+        bool ok = ttlOk(lru) && ttlOk(lfu);
+        std::cout << "TTL Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест GreedyDual-Size: при cost = 1 первыми уходят крупные объекты,
+    // а после удаления всех записей арена возвращает все страницы.
+    {
+        GDSCache g(4 * 4096, 4096);        // 4 страницы по 4 КБ
+        g.put(1, 10, 4000, 1.0);
+        g.put(2, 20, 100, 1.0); g.put(3, 30, 100, 1.0);
+        g.put(4, 40, 4000, 1.0); g.put(5, 50, 4000, 1.0);
+        g.put(6, 60, 4000, 1.0);           // не помещается: вытесняется самый старый крупный — 1
+        bool ok = g.get(2).value_or(-1) == 20 && g.get(3).value_or(-1) == 30
+                  && !g.get(1).has_value() && g.get(6).value_or(-1) == 60 && g.counters().evictions == 1
+                  && g.usedBytes() <= g.byteBudget() && g.arena().reservedBytes() <= g.arena().capacityBytes();
+        for (int k : {2, 3, 4, 5, 6}) ok = ok && g.erase(k);
+        ok = ok && g.size() == 0 && g.arena().reservedBytes() == 0 && g.arena().requestedBytes() == 0;
+
+        // Обновление с меньшей стоимостью понижает H: запись должна подняться
+        // к вершине кучи и уйти первой, хотя обращались к ней последней
+        GDSCache d(4 * 4096, 4096);
+        for (int k = 1; k <= 4; ++k) d.put(k, k * 10, 4000, 100.0);
+        d.put(3, 31, 4000, 1.0);
+        d.put(5, 50, 4000, 100.0);
+        ok = ok && !d.get(3).has_value() && d.get(1).value_or(-1) == 10 && d.get(5).value_or(-1) == 50
+             && d.counters().evictions == 1;
+
+        // Смесь классов размеров при нехватке кусков арены: вытеснение минимума
+        // своего класса не должно сдвигать L назад
+        GDSCache m(16 * 4096, 4096);
+        std::mt19937 rng(3);
+        const uint32_t sizes[] = {100, 700, 2000, 4000};
+        double last = 0.0;
+        bool monotone = true;
+        for (int i = 0; i < 20000; ++i) {
+            int k = (int)(rng() % 400);
+            if (!m.get(k)) m.put(k, k, sizes[k % 4], 1.0 + rng() % 100);
+            monotone = monotone && m.inflation() >= last;
+            last = m.inflation();
+        }
+        ok = ok && monotone && m.arenaEvictions() > 0 && last > 0.0;
+        std::cout << "GDS Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест генератора нагрузок: результат не зависит от числа потоков,
+    // у Zipf(1.2) ранг 0 — самый частый и помечен горячим, доля put ~ write_ratio.
+    {
+        WorkloadSpec spec;
+        spec.ops = 300000; spec.universe = 5000; spec.zipf_alpha = 1.2;
+        spec.drift_period = 100000; spec.drift_step = 50;
+        spec.scan_period = 30000; spec.scan_len = 500; spec.write_ratio = 0.25;
+        spec.threads = 1;
+        Workload a = generateWorkload(spec);
+        spec.threads = 4;
+        Workload b = generateWorkload(spec);
+        long long first = 0, second = 0, writes = 0, scans = 0;
+        for (size_t i = 0; i < a.ops.size(); ++i) {
+            if (i < 100000) { first += a.ops[i] == 0; second += a.ops[i] == 1; }
+            writes += a.isWrite(i);
+            scans += a.ops[i] >= a.universe;
+        }
+        AliasSampler coin({1.0, 3.0});
+        long long ones = 0;
+        for (uint64_t r = 0; r < 4000; ++r) ones += coin.sample(r * 0x9E3779B97F4A7C15ull) == 1;
+        int labeled = 0;
+        for (uint8_t h : a.hot) labeled += h;
+        // Метки следуют за дрейфом: в последней фазе самые частые ключи этой фазы —
+        // горячие для оракула на её операциях, а ранг 0 переехал на ключ 100
+        HotOracle oracle = HotOracle::of(a);
+        std::vector<int> cnt(a.universe, 0);
+        for (size_t i = 200000; i < a.ops.size(); ++i)
+            if (a.ops[i] < a.universe) cnt[a.ops[i]]++;
+        std::vector<int> byCount(a.universe);
+        std::iota(byCount.begin(), byCount.end(), 0);
+        std::partial_sort(byCount.begin(), byCount.begin() + 500, byCount.end(),
+                          [&](int x, int y) { return cnt[x] > cnt[y]; });
+        int agree = 0;
+        for (int i = 0; i < 500; ++i) agree += oracle.isHot(byCount[i], 200000);
+        bool ok = a.ops == b.ops && a.writes == b.writes && a.hot == b.hot
+                  && workloadChecksum(a) == workloadChecksum(b)
+                  && first > second && second > 0 && oracle.isHot(0)
+                  && oracle.isHot(100, 250000) && !oracle.isHot(0, 250000) && agree >= 450
+                  && labeled == 500 && scans == 10 * 500
+                  && std::abs((double)writes / a.ops.size() - 0.25) < 0.01
+                  && ones > 2800 && ones < 3200;
+        std::cout << "Workload Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест гистограммы задержек: корзины покрывают значения без дыр,
+    // процентили попадают в корзину с ошибкой ≤ 1/32, merge складывает счётчики.
+    {
+        bool ok = true;
+        for (uint64_t v : {(uint64_t)0, (uint64_t)63, (uint64_t)64, (uint64_t)65, (uint64_t)1000, (uint64_t)123456789, UINT64_MAX}) {
+            int b = LatencyHistogram::bucketOf(v);
+            ok = ok && b < LatencyHistogram::kBuckets
+                    && LatencyHistogram::bucketLow(b) <= v && v <= LatencyHistogram::bucketHigh(b);
+        }
+        for (int b = 1; b < LatencyHistogram::kBuckets; ++b)
+            ok = ok && LatencyHistogram::bucketLow(b) == LatencyHistogram::bucketHigh(b - 1) + 1;
+        LatencyHistogram h, h2;
+        for (uint64_t v = 1; v <= 10000; ++v) h.record(v);
+        h2.record(1000000);
+        h.merge(h2);
+        uint64_t p50 = h.valueAt(0.5), p99 = h.valueAt(0.99);
+        ok = ok && h.count() == 10001 && h.min() == 1 && h.max() == 1000000
+                && p50 >= 5000 && p50 <= 5000 + 5000 / 32 && p99 >= 9900 && p99 <= 9900 + 9900 / 32
+                && h.valueAt(1.0) == 1000000;
+        std::cout << "Latency Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест MRC: кривая за один проход совпадает с прогонами LRU/flat на каждой ёмкости
+    // (с заполнением по промаху); 30000 обращений переполняют слоты — работает компакция.
+    {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> hotk(0, 99), coldk(0, 2999);
+        std::vector<int> keys(30000);
+        for (auto& k : keys) k = (rng() % 4) ? hotk(rng) : coldk(rng);
+        StackDistanceMRC mrc;
+        for (int k : keys) mrc.access(k);
+        std::vector<size_t> caps = {1, 7, 50, 100, 400, 3000};
+        std::vector<double> hr = mrc.hitRates(caps);
+        bool ok = mrc.distinct() <= 3000 && mrc.sampled() == keys.size();
+        for (size_t i = 0; i < caps.size(); ++i) {
+            LRUCacheFlat c(caps[i]);
+            long long hits = 0;
+            for (int k : keys) { if (c.get(k)) hits++; else c.put(k, k); }
+            ok = ok && std::abs(hr[i] - hits * 100.0 / keys.size()) < 1e-9;
+        }
+        StackDistanceMRC sh(0.1);
+        for (int k : keys) sh.access(k);
+        ok = ok && sh.sampled() < keys.size() / 4 && std::abs(sh.hitRates({400})[0] - hr[4]) < 10.0;
+        std::cout << "MRC Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест счётчиков: значение есть только у открытых событий; открытые instructions
+    // насчитывают больше, чем итераций в замеряемом цикле, а page-faults — хотя бы
+    // один промах по новой странице. Закрытые события дают пустые колонки, и прогон
+    // не ломается (без PMU остаются программные события).
+    {
+        PerfCounters pc;
+        const size_t n = 1 << 20, stride = 1024;     // 1024 int — одна страница на итерацию
+        const double loop_ops = (double)(n / stride);
+        std::unique_ptr<int[]> touch(new int[n]);     // без инициализации: страницы ещё не тронуты
+        pc.start();
+        for (size_t i = 0; i < n; i += stride) touch[i] = (int)i;
+        PerfSample ps = pc.stop();
+        std::ostringstream out;
+        writePerfColumns(out, ps, 1000);
+        std::string cols = out.str();
+        int filled = 0;
+        bool ok = std::count(cols.begin(), cols.end(), ',') == kPerfEventCount;
+        for (int e = 0; e < kPerfEventCount; ++e) {
+            ok = ok && (!ps.valid[e] || pc.opened(e));
+            filled += ps.valid[e];
+        }
+        if (pc.opened(kPerfInstructions))
+            ok = ok && ps.valid[kPerfInstructions] && ps.value[kPerfInstructions] > loop_ops;
+        if (pc.opened(kPerfPageFaults))
+            ok = ok && ps.valid[kPerfPageFaults] && ps.value[kPerfPageFaults] > 0;
+        ok = ok && filled <= pc.available();
+        std::cout << "Perf Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест учёта памяти: узловые движки выделяют на вставку и всё возвращают,
+    // плоские выделяют только в конструкторе.
+    {
+        AllocStats s0 = allocSnapshot();
+        bool ok = true;
+        {
+            LRUCacheIter lru(100);
+            AllocStats s1 = allocSnapshot();
+            for (int k = 0; k < 100; ++k) lru.put(k, k);
+            AllocStats d = allocDelta(s1, allocSnapshot());
+            ok = ok && d.allocs >= 200 && d.live_usable >= 100 * (long long)(2 * sizeof(int) + 2 * sizeof(void*));
+            LRUCacheRec rec(10);
+            for (int k = 0; k < 20; ++k) rec.put(k, k);
+            ok = ok && allocDelta(s1, allocSnapshot()).allocs >= 220;
+        }
+        ok = ok && allocDelta(s0, allocSnapshot()).live_usable == 0;
+        {
+            LRUCacheFlat flat(100);
+            AllocStats s1 = allocSnapshot();
+            ok = ok && allocDelta(s0, s1).live_usable >= 100 * (long long)(2 * sizeof(int));
+            for (int k = 0; k < 300; ++k) { flat.put(k, k); (void)flat.get(k / 2); }
+            ok = ok && allocDelta(s1, allocSnapshot()).allocs == 0;
+        }
+        ok = ok && allocDelta(s0, allocSnapshot()).live_usable == 0 && residentBytes() > 0;
+        {
+            // Счётчики по слотам потоков: выделяют 4 потока, освобождает главный —
+            // у слотов live разного знака, а сумма сходится
+            std::vector<std::vector<char*>> blocks(4);
+            AllocStats s1 = allocSnapshot();
+            std::vector<std::thread> pool;
+            for (int t = 0; t < 4; ++t)
+                pool.emplace_back([&blocks, t] { for (int i = 0; i < 1000; ++i) blocks[t].push_back((char*)trackedAlloc(24, 8)); });
+            for (auto& th : pool) th.join();
+            AllocStats d = allocDelta(s1, allocSnapshot());
+            ok = ok && d.allocs == 4000 && d.requested == 4000 * 24 && d.live_usable >= d.live_requested;
+            for (auto& b : blocks) for (char* p : b) trackedFree(p, 24);
+            d = allocDelta(s1, allocSnapshot());
+            ok = ok && d.frees == 4000 && d.live_requested == 0 && d.live_usable == 0;
+        }
+        std::cout << "Memory Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест CLOCK: ключ с выставленным битом обращения переживает проход стрелки.
+    {
+        ClockCache clk(2);
+        clk.put(1, 10); clk.put(2, 20);
+        auto v1 = clk.get(1);          // ref(1) = 1
+        clk.put(3, 30);                // стрелка: сбросит ref(1), вытеснит 2
+        bool ok = v1.value_or(-1) == 10 && !clk.get(2).has_value()
+                  && clk.get(1).value_or(-1) == 10 && clk.get(3).value_or(-1) == 30
+                  && clk.counters().evictions == 1;
+        std::cout << "CLOCK Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест ShardedCache: с одним шардом ведёт себя как обёрнутая политика.
+    {
+        ShardedCache lru(2, 1, [](size_t c) { return std::make_unique<LRUCacheIter>(c); });
+        lru.put(1, 10); lru.put(2, 20);
+        (void)lru.get(1);
+        lru.put(3, 30);
+        ShardedCache many(64, 8, [](size_t c) { return std::make_unique<LFUCachePool>(c); });
+        for (int k = 0; k < 64; ++k) many.put(k, k);
+        bool ok = !lru.get(2).has_value() && lru.get(1).value_or(-1) == 10
+                  && many.capacity() == 64 && many.get(63).value_or(-1) == 63
+                  && many.counters().puts == 64;
+        // Вытеснения из 4 потоков: слоты SharedEvictionAccounting в сумме дают все
+        // вытеснения по ёмкости (слушатель подключён до прогрева)
+        ShardedCache mt(256, 8, [](size_t c) { return std::make_unique<LRUCacheFlat>(c); });
+        MTResult r = runScenarioMT(mt, makeWorkload(40000, 4096, 0.9), 4);
+        ok = ok && r.ops == 40000 && r.useful_evict + r.harmful_evict == mt.counters().evictions
+                && mt.counters().evictions > 0;
+        std::cout << "Sharded Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест ShardedStats: 4 потока пишут, снимки на ходу не убывают и согласованы,
+    // итог точный; ShardedCache считает вытеснения внутренних шардов.
+    {
+        ShardedStats st(2);
+        std::atomic<bool> stop{false};
+        bool ok = st.slots() == 2;
+        std::thread reader([&] {
+            OpCounters prev;
+            while (!stop.load()) {
+                OpCounters c = st.snapshot();
+                if (c.hits < prev.hits || c.puts < prev.puts || c.gets != c.hits + c.misses) ok = false;
+                prev = c;
+            }
+        });
+        std::vector<std::thread> pool;
+        for (int t = 0; t < 4; ++t)
+            pool.emplace_back([&] {
+                for (int i = 0; i < 100000; ++i) { st.add(i % 4 ? StatField::Hits : StatField::Misses); st.add(StatField::Puts); }
+            });
+        for (auto& th : pool) th.join();
+        stop = true;
+        reader.join();
+        OpCounters c = st.snapshot();
+        OpCounters half;
+        half.hits = 150000; half.misses = 50000; half.gets = 200000;
+        OpCounters d = delta(c, half);
+        ok = ok && c.hits == 300000 && c.misses == 100000 && c.puts == 400000 && c.gets == 400000
+                && d.hits == 150000 && d.gets == 200000 && hitRate(c) == 75.0 && hitRate(OpCounters{}) == 0.0
+                && opsPerSec(d, 1000000000LL) == 600000.0;
+
+        ShardedCache sc(2, 1, [](size_t cap) { return std::make_unique<LRUCacheFlat>(cap); });
+        sc.put(1, 1); sc.put(2, 2); sc.put(3, 3);
+        (void)sc.get(1); (void)sc.get(3);
+        const OpCounters& sn = sc.counters();
+        ok = ok && sn.evictions == 1 && sn.puts == 3 && sn.hits == 1 && sn.misses == 1 && sn.gets == 2;
+        std::cout << "Stats Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест матрицы экспериментов: разбор настроек и масок движков, все движки
+    // реестра строятся, маленькая матрица пишет по строке на метрику каждого повтора.
+    {
+        MatrixSpec spec;
+        std::string err;
+        bool ok = applyMatrixSetting(spec, "engines = LRU/flat, CLOCK/*  # комментарий", err)
+               && applyMatrixSetting(spec, "capacities=1Ki,2K", err)
+               && applyMatrixSetting(spec, "workload = hot dist=hotset locality=0.8 universe=3x writes=0.2", err)
+               && applyMatrixSetting(spec, "ops = 20K", err) && applyMatrixSetting(spec, "warmup = 25%", err)
+               && applyMatrixSetting(spec, "threads = 1, 2", err) && applyMatrixSetting(spec, "batch=1,8", err)
+               && applyMatrixSetting(spec, "trials = 2", err) && applyMatrixSetting(spec, "discard=1", err)
+               && applyMatrixSetting(spec, "pin = auto", err)
+               && applyMatrixSetting(spec, "output = matrix_selftest.csv", err);
+        ok = ok && spec.capacities == std::vector<size_t>{1024, 2000} && spec.ops == 20000
+                && spec.warmup_fraction == 0.25 && spec.workloads.size() == 1
+                && spec.workloads[0].universe_per_cap == 3.0 && spec.workloads[0].spec.dist == KeyDist::HotSet
+                && !applyMatrixSetting(spec, "engines = FIFO/list", err)
+                && !applyMatrixSetting(spec, "warmup = 1.5", err) && !applyMatrixSetting(spec, "speed = 11", err)
+                && selectEngines("all").size() == engineRegistry().size()
+                && selectEngines("*/flat").size() == 1 && selectEngines("LFU/*").size() == 6;
+        for (const auto& e : engineRegistry()) {
+            auto c = e.make(16);
+            size_t th = 0, ac = 0, ov = 0;
+            c->put(1, 10);
+            e.estimate(*c, th, ac, ov);
+            ok = ok && c->capacity() == 16 && c->get(1).value_or(-1) == 10 && th > 0 && findEngine(e.name()) == &e;
+        }
+
+        std::ostringstream log;
+        long long runs = runMatrix(spec, log);
+        std::ifstream in("matrix_selftest.csv");
+        std::string line;
+        long long lines = 0, hit_rows = 0;
+        while (std::getline(in, line)) {
+            lines++;
+            if (line.find(",hit_rate,") != std::string::npos) hit_rows++;
+        }
+        // 2 движка × 2 ёмкости × 1 нагрузка × 2 потока × 2 пакета × 2 повтора, 10 метрик
+        ok = ok && runs == 32 && hit_rows == 32 && lines == 1 + 32 * 10;
+        std::remove("matrix_selftest.csv");
+        std::cout << "Matrix Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+
+    // Тест шаблонных кэшей на не-int ключах и значениях-структурах.
+    {
+        struct Payload { int id = 0; double score = 0.0; };
+        LRUCacheT<std::string, Payload> lru(2);
+        lru.put("a", {1, 0.5}); lru.put("b", {2, 1.5});
+        (void)lru.get("a");
+        lru.put("c", {3, 2.5});
+        LFUCacheT<uint64_t, int> lfu(2);
+        lfu.put(1ull << 40, 10); lfu.put(2ull << 40, 20);
+        (void)lfu.get(1ull << 40);
+        lfu.put(3ull << 40, 30);
+        bool ok = !lru.get("b").has_value() && lru.get("a").value_or(Payload{}).id == 1
+                  && lru.get("c").value_or(Payload{}).id == 3
+                  && !lfu.get(2ull << 40).has_value() && lfu.get(1ull << 40).value_or(-1) == 10;
+        std::cout << "LRU/LFU (template) Test: " << (ok ? "OK" : "FAIL") << "\n";
+    }
+}
+
+// Режим --dispatch-bench: цена виртуального вызова ICache.
+// Один и тот же движок гоняется через CacheAdapter (ICache&) и напрямую как шаблон;
+// Bare — тот же движок без слушателя вытеснений (вызов вырезан при компиляции).
+template <class Impl, class Bare>
+void benchDispatch(std::ofstream& out, const char* algo, const Workload& wl, int capacity, int reps) {
+    long long best_adapter = LLONG_MAX, best_direct = LLONG_MAX, best_bare = LLONG_MAX;
+    double hr_adapter = 0.0, hr_direct = 0.0;
+    for (int r = 0; r < reps; ++r) {
+        CacheAdapter<Impl> a(capacity);
+        RunContext ra;
+        best_adapter = std::min(best_adapter, runScenario(a, wl, ra, 0));
+        hr_adapter = hitRate(a.counters());
+
+        Impl d(capacity);
+        RunContext rd;
+        best_direct = std::min(best_direct, runScenarioT(d, wl, rd, 0));
+        hr_direct = hitRate(d.counters());
+
+        Bare b(capacity);
+        RunContext rb;
+        best_bare = std::min(best_bare, runScenarioT(b, wl, rb, 0));
+    }
+    double ops = (double)wl.ops.size() + capacity / 2;
+    double avg_a = best_adapter / ops, avg_d = best_direct / ops, avg_b = best_bare / ops;
+    double pct = best_direct ? (double)(best_adapter - best_direct) / best_direct * 100.0 : 0.0;
+    out << algo << "," << capacity << "," << best_adapter << "," << best_direct << ","
+        << avg_a << "," << avg_d << "," << (avg_a - avg_d) << "," << pct << ","
+        << hr_adapter << "," << hr_direct << "," << avg_b << "\n";
+    std::cout << algo << ": adapter " << std::fixed << std::setprecision(2) << avg_a
+              << " ns/op, direct " << avg_d << " ns/op, dispatch " << (avg_a - avg_d)
+              << " ns/op (" << pct << "%), direct без слушателя " << avg_b << " ns/op\n";
+}
+
+int runDispatchBench() {
+    const int capacity = 128;
+    const int reps = 5;
+    Workload wl = makeWorkload(500000, 2000, 0.75);
+    std::ofstream out("dispatch_overhead.csv");
+    out << "algo,capacity,adapter_ns,direct_ns,adapter_avg_ns,direct_avg_ns,dispatch_ns_per_op,overhead_pct,"
+           "adapter_hit_rate,direct_hit_rate,direct_nolistener_avg_ns\n";
+    std::cout << "\n--- Цена виртуальной диспетчеризации (лучшее из " << reps << ") ---\n";
+    using Dyn = DynamicEvictionListener;
+    benchDispatch<LRUCacheT<int,int,HashOf<int>,Dyn>, LRUCacheT<int,int>>(out, "LRU", wl, capacity, reps);
+    benchDispatch<LFUCacheT<int,int,HashOf<int>,Dyn>, LFUCacheT<int,int>>(out, "LFU", wl, capacity, reps);
+    std::cout << "CSV: dispatch_overhead.csv\n";
+    return 0;
+}
+
+// Режим --telemetry: долгий прогон LRU flat с потоковой записью окон в path
+// (.bin — бинарный формат, иначе CSV); за ходом можно следить через tail -f
+int runTelemetryWatch(const std::string& path, long long ops, int capacity) {
+    WorkloadSpec spec;
+    spec.dist = KeyDist::Zipf; spec.zipf_alpha = 0.99; spec.write_ratio = 0.3;
+    spec.universe = capacity * 8; spec.ops = ops;
+    spec.drift_period = ops / 4; spec.drift_step = capacity;   // горячее множество меняется трижды
+    Workload wl = generateWorkload(spec);
+    bool binary = path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    TelemetryStream tel(path, binary ? TelemetryFormat::Binary : TelemetryFormat::Csv, "LRU-flat");
+    if (!tel.ok()) { std::cerr << "Не открыть " << path << "\n"; return 1; }
+    LRUCacheFlat c(capacity);
+    RunContext rc;
+    rc.telemetry = &tel;
+    long long t = runScenarioT(c, wl, rc);
+    tel.stop();
+    std::cout << "Телеметрия: " << tel.written() << " окон (потеряно " << tel.dropped() << ") -> " << path
+              << ", прогон " << t / 1e6 << " мс\n";
+    return 0;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--dispatch-bench") return runDispatchBench();
+    if (argc > 1 && std::string(argv[1]) == "--matrix") {
+        // --matrix [файл] [ключ=значение…]: настройки применяются по порядку,
+        // так что ключи из командной строки перекрывают файл
+        MatrixSpec spec;
+        std::string err;
+        for (int i = 2; i < argc; ++i) {
+            std::string a = argv[i];
+            bool ok = a.find('=') != std::string::npos ? applyMatrixSetting(spec, a, err) : loadMatrixConfig(spec, a, err);
+            if (!ok) { std::cerr << "matrix: " << err << "\n"; return 1; }
+        }
+        long long runs = runMatrix(spec, std::cout);
+        if (runs < 0) return 1;
+        std::cout << "Повторов: " << runs << " -> " << spec.output << "\n";
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--telemetry")
+        return runTelemetryWatch(argv[2], argc > 3 ? std::atoll(argv[3]) : 50000000LL, argc > 4 ? std::atoi(argv[4]) : 65536);
+    if (argc > 3 && std::string(argv[1]) == "--convert-trace") {
+        long long n = convertTextTrace(argv[2], argv[3]);
+        if (n < 0) { std::cerr << "Не удалось сконвертировать " << argv[2] << " -> " << argv[3] << "\n"; return 1; }
+        std::cout << "Записей: " << n << " -> " << argv[3] << "\n";
+        return 0;
+    }
+    if (argc > 2 && std::string(argv[1]) == "--replay-trace") {
+        MappedFile f;
+        if (!f.open(argv[2]) || !TraceReader(f).valid()) { std::cerr << "Не трасса: " << argv[2] << "\n"; return 1; }
+        int cap = argc > 3 ? std::atoi(argv[3]) : 1024;
+        std::ofstream out("trace_replay.csv");
+        out << kTraceReplayHeader;
+        replayTraceEngines(out, argv[2], f, cap);
+        std::cout << "CSV: trace_replay.csv\n";
+        return 0;
+    }
+
     // Небольшая проверка корректности
     runBasicCacheTests();
 
+    // Аппаратные счётчики: --no-perf выключает; недоступные события дают пустые колонки
+    bool no_perf = false;
+    for (int i = 1; i < argc; ++i) no_perf = no_perf || std::string(argv[i]) == "--no-perf";
+    PerfCounters perf_counters;
+    PerfCounters* perf = (!no_perf && perf_counters.available()) ? &perf_counters : nullptr;
+    std::cout << "perf_event_open: " << (perf ? perf_counters.available() : 0) << "/" << kPerfEventCount
+              << " событий";
+    const char* sep = ": ";
+    for (int e = 0; perf && e < kPerfEventCount; ++e)
+        if (perf_counters.opened(e)) { std::cout << sep << PerfCounters::name(e); sep = ", "; }
+    std::cout << "\n";
+
+    // Штраф промаха для cost_per_op — средняя фактическая задержка загрузки
+    // из имитируемого бэкенда по умолчанию (BackendSpec: 100 мкс, фиксированная)
+    double miss_penalty_ns = 0.0;
+    {
+        SimulatedBackend backend{BackendSpec{}};
+        for (int k = 0; k < 200; ++k) (void)backend.load(k);
+        miss_penalty_ns = backend.meanLatencyNs();
+        std::cout << "Штраф промаха (бэкенд): " << miss_penalty_ns / 1000.0 << " мкс\n";
+    }
+
     const int capacity  = 128;
     const int total_ops = 20000;
     const int universe  = 2000;
@@ -182,152 +1510,923 @@ int main() {
     csv << "algo,impl,capacity,elapsed_ns,gets,puts,evictions,hit_rate,miss_rate,avg_ns,ops_per_sec,"
            "useful_evictions,harmful_evictions,eviction_efficiency,"
            "theoretical_memory,actual_memory,overhead_memory,memory_efficiency,overhead_pct,"
-           "warmup_ops,cost_per_op,fragmentation_ratio\n";
+           "warmup_ops,cost_per_op,fragmentation_ratio,p50_ns,p99_ns,p999_ns,max_ns" << kPerfCsvColumns
+        << ",estimated_memory,bytes_per_entry,allocs_per_op,alloc_bytes_per_op,rss_delta\n";
 
     // Для графика прогрева сохраним warmup.csv (последнего прогона каждого варианта)
     std::ofstream warmcsv("warmup.csv");
-    warmcsv << "step,hit_rate\n";
-
-    // ---- LRU (iter) ----
-    LRUCacheIter lru_it(capacity);
-    RunContext ctx1;
-    long long t1 = runScenario(lru_it, wl, ctx1);
-    size_t th=0, ac=0, ov=0; lru_it.estimateMemory(th,ac,ov);
-
-    // оценка warmup и стоимости операции
-    int warm1 = (int)ctx1.warm.hit_rates_over_time.size(); // упрощённый warmup_ops (по окнам)
-    for (size_t i = 0; i < ctx1.warm.hit_rates_over_time.size(); ++i)
-        warmcsv << i << "," << ctx1.warm.hit_rates_over_time[i] << "\n";
-    double cost1 = calculateCostPerOperation(t1, (int)wl.ops.size() + capacity/2);
-
-    // простая оценка «фрагментации»: (peak - current)/peak (%)
-    // здесь peak примем как теоретическую ёмкость, current — реальное использование
-    double frag1 = th ? (double)(th > ac ? (th - ac) : 0) / th * 100.0 : 0.0;
-
-    auto r1 = collectRow("LRU","iter", lru_it, t1, ctx1.useful_evict, ctx1.harmful_evict, th, ac, ov,
-                         (int)wl.ops.size() + capacity/2, warm1, cost1, frag1);
-    csv << r1.algo << "," << r1.impl << "," << r1.capacity << "," << r1.elapsed_ns << ","
-        << r1.gets << "," << r1.puts << "," << r1.evictions << ","
-        << r1.hit_rate << "," << r1.miss_rate << "," << r1.avg_time_ns << "," << r1.ops_per_sec << ","
-        << r1.useful_evictions << "," << r1.harmful_evictions << "," << r1.eviction_efficiency << ","
-        << r1.theoretical_memory << "," << r1.actual_memory << "," << r1.overhead_memory << ","
-        << r1.memory_efficiency << "," << r1.overhead_pct << ","
-        << warm1 << "," << cost1 << "," << frag1 << "\n";
-
-    // ---- LRU (rec) ----
-    LRUCacheRec lru_rc(capacity);
-    RunContext ctx2;
-    long long t2 = runScenario(lru_rc, wl, ctx2);
-    lru_rc.estimateMemory(th,ac,ov);
-    int warm2 = (int)ctx2.warm.hit_rates_over_time.size();
-    double cost2 = calculateCostPerOperation(t2, (int)wl.ops.size() + capacity/2);
-    double frag2 = th ? (double)(th > ac ? (th - ac) : 0) / th * 100.0 : 0.0;
-    auto r2 = collectRow("LRU","rec",  lru_rc, t2, ctx2.useful_evict, ctx2.harmful_evict, th, ac, ov,
-                         (int)wl.ops.size() + capacity/2, warm2, cost2, frag2);
-    csv << r2.algo << "," << r2.impl << "," << r2.capacity << "," << r2.elapsed_ns << ","
-        << r2.gets << "," << r2.puts << "," << r2.evictions << ","
-        << r2.hit_rate << "," << r2.miss_rate << "," << r2.avg_time_ns << "," << r2.ops_per_sec << ","
-        << r2.useful_evictions << "," << r2.harmful_evictions << "," << r2.eviction_efficiency << ","
-        << r2.theoretical_memory << "," << r2.actual_memory << "," << r2.overhead_memory << ","
-        << r2.memory_efficiency << "," << r2.overhead_pct << ","
-        << warm2 << "," << cost2 << "," << frag2 << "\n";
-
-    // ---- LFU (iter) ----
-    LFUCacheIter lfu_it(capacity);
-    RunContext ctx3;
-    long long t3 = runScenario(lfu_it, wl, ctx3);
-    lfu_it.estimateMemory(th,ac,ov);
-    int warm3 = (int)ctx3.warm.hit_rates_over_time.size();
-    double cost3 = calculateCostPerOperation(t3, (int)wl.ops.size() + capacity/2);
-    double frag3 = th ? (double)(th > ac ? (th - ac) : 0) / th * 100.0 : 0.0;
-    auto r3 = collectRow("LFU","iter", lfu_it, t3, ctx3.useful_evict, ctx3.harmful_evict, th, ac, ov,
-                         (int)wl.ops.size() + capacity/2, warm3, cost3, frag3);
-    csv << r3.algo << "," << r3.impl << "," << r3.capacity << "," << r3.elapsed_ns << ","
-        << r3.gets << "," << r3.puts << "," << r3.evictions << ","
-        << r3.hit_rate << "," << r3.miss_rate << "," << r3.avg_time_ns << "," << r3.ops_per_sec << ","
-        << r3.useful_evictions << "," << r3.harmful_evictions << "," << r3.eviction_efficiency << ","
-        << r3.theoretical_memory << "," << r3.actual_memory << "," << r3.overhead_memory << ","
-        << r3.memory_efficiency << "," << r3.overhead_pct << ","
-        << warm3 << "," << cost3 << "," << frag3 << "\n";
-
-    // ---- LFU (rec) ----
-    LFUCacheRec lfu_rc(capacity);
-    RunContext ctx4;
-    long long t4 = runScenario(lfu_rc, wl, ctx4);
-    lfu_rc.estimateMemory(th,ac,ov);
-    int warm4 = (int)ctx4.warm.hit_rates_over_time.size();
-    double cost4 = calculateCostPerOperation(t4, (int)wl.ops.size() + capacity/2);
-    double frag4 = th ? (double)(th > ac ? (th - ac) : 0) / th * 100.0 : 0.0;
-    auto r4 = collectRow("LFU","rec",  lfu_rc, t4, ctx4.useful_evict, ctx4.harmful_evict, th, ac, ov,
-                         (int)wl.ops.size() + capacity/2, warm4, cost4, frag4);
-    csv << r4.algo << "," << r4.impl << "," << r4.capacity << "," << r4.elapsed_ns << ","
-        << r4.gets << "," << r4.puts << "," << r4.evictions << ","
-        << r4.hit_rate << "," << r4.miss_rate << "," << r4.avg_time_ns << "," << r4.ops_per_sec << ","
-        << r4.useful_evictions << "," << r4.harmful_evictions << "," << r4.eviction_efficiency << ","
-        << r4.theoretical_memory << "," << r4.actual_memory << "," << r4.overhead_memory << ","
-        << r4.memory_efficiency << "," << r4.overhead_pct << ","
-        << warm4 << "," << cost4 << "," << frag4 << "\n";
+    warmcsv << "algo,impl,step,hit_rate\n";
+
+    // Гистограммы задержек (непустые корзины) для CDF
+    std::ofstream latcsv("latency_hist.csv");
+    latcsv << "algo,impl,low_ns,high_ns,count,cdf\n";
+
+    // Прогнанные экземпляры остаются до конца main (нужны, например, журналу ADAPT)
+    std::map<std::string, std::unique_ptr<ICache>> ran;
+    // Прогон одного варианта из реестра: строка results_extended.csv + серия warmup.csv
+    auto runResult = [&](const EngineEntry& e) {
+        const char* algo = e.algo.c_str();
+        const char* impl = e.impl.c_str();
+        const int total_ops = (int)wl.ops.size() + capacity/2;
+        auto owned = e.make(capacity);
+        ICache& cache = *owned;
+        RunContext ctx;
+        ctx.perf = perf;
+        long long t = runScenario(cache, wl, ctx);
+        size_t th=0, ac=0, ov=0; e.estimate(cache, th, ac, ov);
+
+        // оценка warmup и стоимости операции
+        int warm = (int)ctx.warm.hit_rates_over_time.size(); // упрощённый warmup_ops (по окнам)
+        writeWarmupSeries(warmcsv, algo, impl, ctx.warm);
+        double cost = calculateCostPerOperation(t, total_ops, cache.counters().misses, miss_penalty_ns);
+
+        // Второй прогон на свежем экземпляре: задержки (rdtsc на каждой операции
+        // не попадает в elapsed_ns основного прогона) и измеренная память.
+        // Экземпляр — из той же фабрики e.make, поэтому параметры конструктора
+        // (RecMode у rec-idx, ways у set8/set16) совпадают с основным прогоном.
+        LatencyHistogram h;
+        MemoryMeasure mem;
+        {
+            MemoryProbe probe;
+            auto fresh = e.make(capacity);
+            probe.constructed();
+            RunContext lctx;
+            lctx.latency = &h;
+            runScenario(*fresh, wl, lctx, 0);
+            mem = probe.finish(fresh->size());
+        }
+        writeLatencyHistogram(latcsv, algo, impl, h);
+
+        // Память — по TrackingAllocator: theoretical — полезная нагрузка (ключ + значение),
+        // actual — всё, что экземпляр держит в куче; фрагментация — округление malloc
+        size_t payload = mem.entries * 2 * sizeof(int);
+        size_t live = (size_t)std::max(0LL, mem.live_bytes);
+        double frag = mem.fragmentation();
+        auto r = collectRow(algo, impl, cache, t, ctx.useful_evict, ctx.harmful_evict,
+                            payload, live, live > payload ? live - payload : 0, total_ops, warm, cost, frag);
+        r.memory_efficiency = live ? (double)payload / live * 100.0 : 0.0;
+
+        r.estimated_memory = ac + ov;
+        r.bytes_per_entry = mem.bytesPerEntry();
+        r.allocs_per_op = (double)mem.run_allocs / total_ops;
+        r.alloc_bytes_per_op = (double)mem.run_alloc_bytes / total_ops;
+        r.rss_delta = mem.rss_delta;
+
+        LatencySummary ls = summarizeLatency(h);
+        r.p50_ns = ls.p50_ns; r.p99_ns = ls.p99_ns; r.p999_ns = ls.p999_ns; r.max_ns = ls.max_ns;
+        writeResultRow(csv, r, warm, cost, frag, ctx.perf_sample, total_ops);
+        ran[e.name()] = std::move(owned);
+        return r;
+    };
+
+    std::map<std::string, CacheMetricsRow> rows;
+    for (const auto& e : engineRegistry()) rows[e.name()] = runResult(e);
 
     csv.close();
     warmcsv.close();
+    latcsv.close();
 
     // ---- Масштабируемость по размерам ----
     std::vector<int> sizes = {16, 32, 64, 128, 256, 512, 1024};
     std::ofstream scsv("scalability_extended.csv");
-    scsv << "size,algo,impl,elapsed_ns,avg_ns,ops_per_sec,hit_rate,useful_evictions,harmful_evictions,eviction_efficiency\n";
+    scsv << "size,algo,impl,elapsed_ns,avg_ns,ops_per_sec,hit_rate,useful_evictions,harmful_evictions,eviction_efficiency"
+         << kPerfCsvColumns << "\n";
+
+    auto runScal = [&](int cap, const char* algo, const char* impl, ICache& c, const Workload& wl2) {
+        RunContext rc;
+        rc.perf = perf;
+        auto t = runScenario(c, wl2, rc);
+        const auto& cnt = c.counters();
+        double hr   = hitRate(cnt);
+        double avg  = (double)t / (wl2.ops.size() + cap / 2);
+        double opsp = (double)(wl2.ops.size() + cap / 2) / (t / 1e9);
+        double eff  = (cnt.evictions > 0) ? (double)rc.useful_evict / cnt.evictions * 100.0 : 0.0;
+        scsv << cap << "," << algo << "," << impl << "," << t << "," << avg << "," << opsp << "," << hr << ","
+             << rc.useful_evict << "," << rc.harmful_evict << "," << eff;
+        writePerfColumns(scsv, rc.perf_sample, (long long)wl2.ops.size() + cap / 2);
+        scsv << "\n";
+    };
 
+    Workload wl2 = makeWorkload(15000, 4000, 0.75);
     for (int cap : sizes) {
-        Workload wl2 = makeWorkload(15000, 4000, 0.75);
-        {
-            LRUCacheIter c(cap);
-            RunContext rc;
-            auto t = runScenario(c, wl2, rc);
-            const auto& cnt = c.counters();
-            double hr   = (cnt.hits + cnt.misses) ? (double)cnt.hits / (cnt.hits + cnt.misses) * 100.0 : 0.0;
-            double avg  = (double)t / (wl2.ops.size() + cap / 2);
-            double opsp = (double)(wl2.ops.size() + cap / 2) / (t / 1e9);
-            double eff  = (cnt.evictions > 0) ? (double)rc.useful_evict / cnt.evictions * 100.0 : 0.0;
-            scsv << cap << ",LRU,iter," << t << "," << avg << "," << opsp << "," << hr << ","
-                 << rc.useful_evict << "," << rc.harmful_evict << "," << eff << "\n";
+        for (const auto& e : engineRegistry()) {
+            auto c = e.make(cap);
+            runScal(cap, e.algo.c_str(), e.impl.c_str(), *c, wl2);
         }
-        {
-            LFUCacheIter c(cap);
+    }
+    scsv.close();
+
+    // ---- Односвязные Rec-движки до 1M записей ----
+    // rec_scaling.csv: LRU/LFU rec в режимах Plain и Indexed против flat/pool.
+    // Нагрузка — Zipf(0.9) по вселенной 2·cap, 4·cap обращений (не меньше 64K), 30% put.
+    // Plain проходит список на каждой операции, поэтому меряется только до 4096 записей.
+    // bytes_per_entry — живые байты аллокатора после прогона на запись,
+    // teardown_ms — время деструктора (он итеративный, стек от размера не зависит).
+    std::ofstream rsccsv("rec_scaling.csv");
+    rsccsv << "size,algo,impl,ops,elapsed_ns,avg_ns,ops_per_sec,hit_rate,bytes_per_entry,teardown_ms\n";
+    {
+        const size_t kPlainLimit = 4096;
+        for (size_t cap = 1024; cap <= ((size_t)1 << 20); cap *= 4) {
+            WorkloadSpec spec;
+            spec.dist = KeyDist::Zipf; spec.zipf_alpha = 0.9; spec.write_ratio = 0.3;
+            spec.universe = (int)(2 * cap);
+            spec.ops = (long long)std::max<size_t>(4 * cap, (size_t)1 << 16);
+            Workload rw = generateWorkload(spec);
+            auto runRec = [&](const char* algo, const char* impl, auto make) {
+                AllocStats s0 = allocSnapshot();
+                auto c = make();
+                RunContext rc;
+                long long t = runScenario(*c, rw, rc, 0);
+                long long live = allocDelta(s0, allocSnapshot()).live_usable;
+                const auto& cnt = c->counters();
+                double hr  = hitRate(cnt);
+                double ops = (double)(rw.ops.size() + cap / 2);
+                double bpe = c->size() ? (double)live / c->size() : 0.0;
+                auto d0 = Clock::now();
+                c.reset();
+                double td = std::chrono::duration<double, std::milli>(Clock::now() - d0).count();
+                rsccsv << cap << "," << algo << "," << impl << "," << rw.ops.size() << "," << t << ","
+                       << t / ops << "," << ops / (t / 1e9) << "," << hr << "," << bpe << "," << td << "\n";
+            };
+            for (const EngineEntry* e : selectEngineList({"*/rec", "*/rec-idx", "LRU/flat", "LFU/pool"}))
+                if (e->impl != "rec" || cap <= kPlainLimit)
+                    runRec(e->algo.c_str(), e->impl.c_str(), [&] { return e->make(cap); });
+        }
+    }
+    rsccsv.close();
+
+    // ---- Множественно-ассоциативный кэш (SetAssoc.h) ----
+    // set_assoc.csv: 8 и 16 путей, PLRU и приближённый LFU, скалярное/SSE2/AVX2 сравнение
+    // тегов против точных LRU (flat) и LFU (pool) на той же нагрузке: Zipf(0.9) по 2·cap
+    // ключам, 4·cap обращений (не меньше 256K), 30% put. Типизированный прогон — без
+    // виртуальных вызовов, время — лучшее из трёх; hit_loss_pp — потеря в процентных пунктах.
+    std::ofstream sacsv("set_assoc.csv");
+    sacsv << "size,algo,impl,ways,simd,ops,hit_rate,ref_impl,ref_hit_rate,hit_loss_pp,avg_ns,ref_avg_ns,speedup\n";
+    {
+        for (int cap : {1024, 16384, 262144}) {
+            WorkloadSpec spec;
+            spec.dist = KeyDist::Zipf; spec.zipf_alpha = 0.9; spec.write_ratio = 0.3;
+            spec.universe = 2 * cap;
+            spec.ops = std::max<long long>(4LL * cap, 1 << 18);
+            Workload sw = generateWorkload(spec);
+            double ops = (double)(sw.ops.size() + cap / 2);
+            // hit rate и лучшее среднее время операции
+            auto measure = [&](auto make) {
+                double best = 1e300, hr = 0.0;
+                for (int rep = 0; rep < 3; ++rep) {
+                    auto c = make();
+                    RunContext rc;
+                    long long t = runScenarioT(c, sw, rc, 0);
+                    const auto& cnt = c.counters();
+                    hr = hitRate(cnt);
+                    best = std::min(best, t / ops);
+                }
+                return std::make_pair(hr, best);
+            };
+            auto lru = measure([&] { return LRUCacheFlat(cap); });
+            auto lfu = measure([&] { return LFUCachePool(cap); });
+            for (SetPolicy pol : {SetPolicy::PLRU, SetPolicy::LFU})
+                for (int ways : {8, 16})
+                    for (SimdLevel simd : {SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2}) {
+                        if (simd > detectSimd()) continue;
+                        auto r = measure([&] { return SetAssocCache(cap, ways, pol, simd); });
+                        const auto& ref = pol == SetPolicy::PLRU ? lru : lfu;
+                        sacsv << cap << "," << (pol == SetPolicy::PLRU ? "LRU" : "LFU") << ",set" << ways << ","
+                              << ways << "," << simdName(simd) << "," << sw.ops.size() << "," << r.first << ","
+                              << (pol == SetPolicy::PLRU ? "flat" : "pool") << "," << ref.first << ","
+                              << ref.first - r.first << "," << r.second << "," << ref.second << ","
+                              << ref.second / r.second << "\n";
+                    }
+        }
+    }
+    sacsv.close();
+
+    // ---- Адаптивный выбор LRU/LFU (Adaptive.h) ----
+    // Четыре фазы по 150K операций, ёмкость 1000. Фаза freq — Zipf(0.9) по 20K ключам
+    // со сканами 3000 новых ключей раз в 10K операций (выигрывает LFU); фаза recency —
+    // горячее множество на отдельном диапазоне ключей, сдвигается раз в 2000 операций
+    // (выигрывает LRU, LFU держит прежние частые ключи). adaptive_phases.csv — hit rate
+    // по окнам в 1000 операций, adaptive_switches.csv — переключения здесь и в results.
+    std::ofstream apcsv("adaptive_phases.csv");
+    std::ofstream swcsv("adaptive_switches.csv");
+    apcsv << "step,phase,algo,hit_rate\n";
+    swcsv << "workload,op,step,from,to,lru_shadow_hit_rate,lfu_shadow_hit_rate\n";
+    writeSwitches(swcsv, "results", static_cast<const AdaptiveCache&>(*ran.at("ADAPT/shadow")), capacity / 2);
+    {
+        const int cap = 1000;
+        const long long phase_ops = 150000;
+        WorkloadSpec fs;
+        fs.dist = KeyDist::Zipf; fs.zipf_alpha = 0.9; fs.universe = 20000; fs.write_ratio = 0.3;
+        fs.ops = phase_ops; fs.scan_period = 10000; fs.scan_len = 3000;
+        WorkloadSpec rs;
+        rs.dist = KeyDist::HotSet; rs.locality = 0.9; rs.universe = 20000; rs.write_ratio = 0.3;
+        rs.ops = phase_ops; rs.drift_period = 2000; rs.drift_step = 200;
+        std::vector<Workload> parts;
+        std::vector<const char*> names;
+        for (int ph = 0; ph < 4; ++ph) {
+            bool freq = ph % 2 == 0;
+            WorkloadSpec spec = freq ? fs : rs;
+            spec.seed = 42 + ph;
+            Workload w = generateWorkload(spec);
+            if (!freq) for (int& k : w.ops) k += 1 << 24;   // свой диапазон ключей
+            parts.push_back(std::move(w));
+            names.push_back(freq ? "freq" : "recency");
+        }
+        Workload pw = concatWorkloads(parts);
+        auto series = [&](const char* algo, ICache& c) {
             RunContext rc;
-            auto t = runScenario(c, wl2, rc);
+            rc.prefill = false;
+            runScenario(c, pw, rc);
+            const auto& hr = rc.warm.hit_rates_over_time;
+            for (size_t i = 0; i < hr.size(); ++i)
+                apcsv << i << "," << names[std::min<size_t>(3, i * 1000 / phase_ops)] << "," << algo << "," << hr[i] << "\n";
             const auto& cnt = c.counters();
-            double hr   = (cnt.hits + cnt.misses) ? (double)cnt.hits / (cnt.hits + cnt.misses) * 100.0 : 0.0;
-            double avg  = (double)t / (wl2.ops.size() + cap / 2);
-            double opsp = (double)(wl2.ops.size() + cap / 2) / (t / 1e9);
-            double eff  = (cnt.evictions > 0) ? (double)rc.useful_evict / cnt.evictions * 100.0 : 0.0;
-            scsv << cap << ",LFU,iter," << t << "," << avg << "," << opsp << "," << hr << ","
-                 << rc.useful_evict << "," << rc.harmful_evict << "," << eff << "\n";
+            return hitRate(cnt);
+        };
+        LRUCacheIter pl(cap);
+        LFUCacheIter pf(cap);
+        AdaptiveCache pa(cap);
+        double hl = series("LRU", pl), hf = series("LFU", pf), ha = series("ADAPT", pa);
+        writeSwitches(swcsv, "phases", pa, 0);
+        std::cout << "\nAdaptive (фазы freq/recency): hit rate LRU " << hl << "%, LFU " << hf
+                  << "%, ADAPT " << ha << "%, переключений " << pa.switches().size() << "\n";
+    }
+    apcsv.close();
+    swcsv.close();
+
+    // ---- Цена телеметрии (Telemetry.h) ----
+    // Один и тот же прогон (Zipf(0.99), 2M обращений, ёмкость 16K) без телеметрии,
+    // ещё раз без неё (контроль: разброс самого замера), с CSV и с бинарным потоком;
+    // окна телеметрии по 10K операций, время — до конца stop() (дописан весь хвост).
+    // Время соседних прогонов на виртуалке плавает на проценты, поэтому прогоны идут
+    // четвёрками в чередующемся порядке, а overhead_pct — медиана отношения к прогону
+    // без телеметрии из той же четвёрки. drain_cpu_pct — процессорное время
+    // потока-сборщика к лучшему времени без телеметрии, от соседей не зависит.
+    // Последние прогоны остаются в telemetry.csv и telemetry.bin.
+    std::ofstream tocsv("telemetry_overhead.csv");
+    tocsv << "algo,impl,sink,ops,best_ns,avg_ns,overhead_pct,drain_cpu_pct,windows,written,dropped\n";
+    {
+        const int cap = 16384, reps = 15;
+        WorkloadSpec spec;
+        spec.dist = KeyDist::Zipf; spec.zipf_alpha = 0.99; spec.write_ratio = 0.3;
+        spec.universe = 200000; spec.ops = 2000000;
+        Workload tw = generateWorkload(spec);
+        const char* sinks[] = {"none", "none-control", "csv", "binary"};
+        auto bench = [&](const char* algo, const char* impl, auto make) {
+            long long best[4] = {LLONG_MAX, LLONG_MAX, LLONG_MAX, LLONG_MAX};
+            long long written[4] = {}, dropped[4] = {}, drain_ns[4] = {};
+            std::vector<double> ratio[4];
+            for (int r = 0; r < reps; ++r) {
+                long long t[4];
+                for (int j = 0; j < 4; ++j) {
+                    int m = r % 2 ? 3 - j : j;
+                    auto c = make();
+                    std::optional<TelemetryStream> tel;
+                    if (m == 2) tel.emplace("telemetry.csv", TelemetryFormat::Csv, std::string(algo) + "-" + impl);
+                    if (m == 3) tel.emplace("telemetry.bin", TelemetryFormat::Binary, std::string(algo) + "-" + impl);
+                    RunContext rc;
+                    rc.telemetry = tel ? &*tel : nullptr;
+                    auto s0 = Clock::now();
+                    runScenarioT(c, tw, rc);
+                    if (tel) tel->stop();
+                    t[m] = std::chrono::duration_cast<Ns>(Clock::now() - s0).count();
+                    best[m] = std::min(best[m], t[m]);
+                    if (tel) { written[m] = tel->written(); dropped[m] = tel->dropped(); drain_ns[m] += tel->drainCpuNs(); }
+                }
+                for (int m = 0; m < 4; ++m) ratio[m].push_back((double)t[m] / t[0]);
+            }
+            double ops = (double)tw.ops.size() + cap / 2;
+            for (int m = 0; m < 4; ++m) {
+                std::sort(ratio[m].begin(), ratio[m].end());
+                tocsv << algo << "," << impl << "," << sinks[m] << "," << tw.ops.size() << "," << best[m] << ","
+                      << best[m] / ops << "," << (ratio[m][reps / 2] - 1.0) * 100.0 << ","
+                      << (double)drain_ns[m] / reps / best[0] * 100.0 << ","
+                      << (m >= 2 ? tw.ops.size() / 10000 : 0) << "," << written[m] << "," << dropped[m] << "\n";
+            }
+        };
+        bench("LRU", "flat", [&] { return LRUCacheFlat(cap); });
+        bench("LFU", "pool", [&] { return LFUCachePool(cap); });
+    }
+    tocsv.close();
+
+    // ---- Цена счётчиков операций по потокам (Stats.h) ----
+    // Каждый поток делает 2M «операций» — инкремент hits или misses (3:1 по ключам
+    // нагрузки), как get в движке. Варианты:
+    //   local       — обычные поля OpCounters у каждого потока (так считают однопоточные движки);
+    //   shared      — один набор атомиков на всех (прежний ClockCache);
+    //   packed      — атомики по потокам, но подряд, без выравнивания (ложное разделение);
+    //   sharded     — ShardedStats, слот по номеру потока;
+    //   sharded-cpu — ShardedStats, слот по sched_getcpu.
+    // Для атомарных вариантов сторонний поток раз в миллисекунду снимает сумму на ходу:
+    // snapshot_ns — цена снимка, monotonic — ни одно поле не уменьшилось и gets = hits + misses.
+    // exact — итог совпал с числом операций. Лучшее из 3 повторов.
+    std::ofstream stcsv("stats_counters.csv");
+    stcsv << "threads,mode,ops,elapsed_ns,ns_per_op,mops_per_sec,snapshots,snapshot_ns,monotonic,exact\n";
+    {
+        const size_t per_thread = 2000000;
+        WorkloadSpec spec;
+        spec.universe = 1 << 20; spec.ops = per_thread;
+        Workload sw = generateWorkload(spec);
+        struct alignas(64) LocalSlot { OpCounters c; };
+        struct SharedCnt { std::atomic<long long> hits{0}, misses{0}; };
+        struct PackedCnt { std::atomic<long long> hits{0}, misses{0}; };
+        const char* modes[] = {"local", "shared", "packed", "sharded", "sharded-cpu"};
+        for (int threads : {1, 2, 4, 8, 16}) {
+            for (int mode = 0; mode < 5; ++mode) {
+                long long best = LLONG_MAX, snaps = 0, snap_ns = 0;
+                bool monotonic = true, exact = true;
+                for (int rep = 0; rep < 3; ++rep) {
+                    std::vector<LocalSlot> local(threads);
+                    SharedCnt shared;
+                    std::vector<PackedCnt> packed(threads);
+                    std::optional<ShardedStats> st;
+                    if (mode >= 3) st.emplace(ShardedStats::kDefaultSlots, mode == 4 ? StatSlotBy::Cpu : StatSlotBy::Thread);
+                    auto snapshot = [&]() -> OpCounters {
+                        OpCounters c;
+                        if (mode == 1) { c.hits = shared.hits.load(std::memory_order_relaxed);
+                                         c.misses = shared.misses.load(std::memory_order_relaxed); }
+                        else if (mode == 2) for (auto& p : packed) { c.hits += p.hits.load(std::memory_order_relaxed);
+                                                                     c.misses += p.misses.load(std::memory_order_relaxed); }
+                        else if (st) return st->snapshot();
+                        c.gets = c.hits + c.misses;
+                        return c;
+                    };
+
+                    std::atomic<int> ready{0}, done{0};
+                    std::atomic<bool> go{false};
+                    std::vector<std::thread> pool;
+                    for (int t = 0; t < threads; ++t) {
+                        pool.emplace_back([&, t] {
+                            ready.fetch_add(1);
+                            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                            const int* keys = sw.ops.data();
+                            switch (mode) {
+                            case 0: { OpCounters& c = local[t].c;
+                                      for (size_t i = 0; i < per_thread; ++i) { if (keys[i] & 3) c.hits++; else c.misses++; }
+                                      break; }
+                            case 1: for (size_t i = 0; i < per_thread; ++i)
+                                        (keys[i] & 3 ? shared.hits : shared.misses).fetch_add(1, std::memory_order_relaxed);
+                                    break;
+                            case 2: for (size_t i = 0; i < per_thread; ++i)
+                                        (keys[i] & 3 ? packed[t].hits : packed[t].misses).fetch_add(1, std::memory_order_relaxed);
+                                    break;
+                            default: for (size_t i = 0; i < per_thread; ++i)
+                                         st->add(keys[i] & 3 ? StatField::Hits : StatField::Misses);
+                                    break;
+                            }
+                            done.fetch_add(1, std::memory_order_release);
+                        });
+                    }
+                    while (ready.load() < threads) std::this_thread::yield();
+                    std::thread poller;
+                    long long rep_snaps = 0, rep_snap_ns = 0;
+                    if (mode > 0) {
+                        poller = std::thread([&] {
+                            OpCounters prev;
+                            while (done.load(std::memory_order_acquire) < threads) {
+                                auto p0 = Clock::now();
+                                OpCounters c = snapshot();
+                                rep_snap_ns += std::chrono::duration_cast<Ns>(Clock::now() - p0).count();
+                                rep_snaps++;
+                                if (c.hits < prev.hits || c.misses < prev.misses || c.gets != c.hits + c.misses)
+                                    monotonic = false;
+                                prev = c;
+                                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                            }
+                        });
+                    }
+                    auto t0 = Clock::now();
+                    go.store(true, std::memory_order_release);
+                    for (auto& th : pool) th.join();
+                    long long el = std::chrono::duration_cast<Ns>(Clock::now() - t0).count();
+                    if (poller.joinable()) poller.join();
+
+                    OpCounters total = snapshot();
+                    if (mode == 0) for (auto& l : local) { total.hits += l.c.hits; total.misses += l.c.misses; }
+                    exact = exact && total.hits + total.misses == (long long)(per_thread * threads);
+                    if (el < best) { best = el; snaps = rep_snaps; snap_ns = rep_snap_ns; }
+                }
+                double ops = (double)per_thread * threads;
+                stcsv << threads << "," << modes[mode] << "," << (long long)ops << "," << best << ","
+                      << best / ops << "," << ops / (best / 1e9) / 1e6 << "," << snaps << ","
+                      << (snaps ? (double)snap_ns / snaps : 0.0) << "," << (mode > 0 ? (int)monotonic : 0) << ","
+                      << (int)exact << "\n";
+            }
         }
-        {
-            LRUCacheRec c(cap);
-            RunContext rc;
-            auto t = runScenario(c, wl2, rc);
+    }
+    stcsv.close();
+
+    // ---- Тёплый рестарт из снимка (Snapshot.h) ----
+    // «Прошлая жизнь» — 200K обращений Zipf(0.9) по 100K ключам, после неё снимок.
+    // Новый экземпляр проходит следующие 200K обращений того же распределения
+    // холодным (cold) и восстановленным из снимка (warm), без прогрева cap/2 ключами.
+    // restore_ms — mmap файла и массовая сборка; import_ms и import_put_ms — сборка из
+    // снимка в памяти массово и поштучными put (без частот), чтобы сравнить сами пути;
+    // warmup_windows — окна по 1000 операций до 95% от установившегося hit rate.
+    std::ofstream wrcsv("warm_restart.csv");
+    std::ofstream wrseries("warm_restart_series.csv");
+    wrcsv << "algo,impl,capacity,entries,snapshot_bytes,save_ms,restore_ms,import_ms,import_put_ms,"
+             "cold_hit_rate,warm_hit_rate,cold_warmup_windows,warm_warmup_windows\n";
+    wrseries << "algo,impl,start,step,hit_rate\n";
+    {
+        const size_t r_capacity = 8192;
+        const char* snap_path = "cache_snapshot.bin";
+        WorkloadSpec spec;
+        spec.ops = 200000; spec.universe = 100000; spec.zipf_alpha = 0.9; spec.write_ratio = 0.3;
+        Workload before = generateWorkload(spec);
+        spec.seed = 43;
+        Workload after = generateWorkload(spec);
+        auto ms = [](auto t0) { return std::chrono::duration<double, std::milli>(Clock::now() - t0).count(); };
+        auto runRestart = [&](const char* algo, const char* impl, auto make) {
+            auto old = make(r_capacity);
+            RunContext rc0;
+            rc0.prefill = false;
+            runScenario(*old, before, rc0, 0);
+            auto t0 = Clock::now();
+            long long entries = saveSnapshot(*old, snap_path);
+            double save_ms = ms(t0);
+            if (entries < 0) return;
+
+            auto warm = make(r_capacity);
+            t0 = Clock::now();
+            loadSnapshot(*warm, snap_path);
+            double restore_ms = ms(t0);
+
+            std::vector<SnapshotEntry> dump;
+            old->exportEntries(dump);
+            auto bulk = make(r_capacity);
+            t0 = Clock::now();
+            bulk->importEntries(dump.data(), dump.size());
+            double import_ms = ms(t0);
+            auto viaPut = make(r_capacity);
+            t0 = Clock::now();
+            viaPut->ICache::importEntries(dump.data(), dump.size());
+            double put_ms = ms(t0);
+
+            auto cold = make(r_capacity);
+            RunContext rc_cold, rc_warm;
+            rc_cold.prefill = rc_warm.prefill = false;
+            runScenario(*cold, after, rc_cold);
+            runScenario(*warm, after, rc_warm);
+            const auto& hc = rc_cold.warm.hit_rates_over_time;
+            const auto& hw = rc_warm.warm.hit_rates_over_time;
+            for (size_t i = 0; i < hc.size(); ++i) wrseries << algo << "," << impl << ",cold," << i << "," << hc[i] << "\n";
+            for (size_t i = 0; i < hw.size(); ++i) wrseries << algo << "," << impl << ",warm," << i << "," << hw[i] << "\n";
+            wrcsv << algo << "," << impl << "," << r_capacity << "," << entries << ","
+                  << std::filesystem::file_size(snap_path) << "," << save_ms << "," << restore_ms << "," << import_ms << "," << put_ms << ","
+                  << hitRate(cold->counters()) << "," << hitRate(warm->counters()) << ","
+                  << windowsToSteady(hc) << "," << windowsToSteady(hw) << "\n";
+            std::cout << "Тёплый рестарт " << algo << "/" << impl << ": " << entries << " записей, save "
+                      << save_ms << " мс, restore " << restore_ms << " мс (сборка " << import_ms << " мс, поштучно "
+                      << put_ms << " мс)\n";
+        };
+        for (const EngineEntry* e : selectEngineList({"LRU/iter", "LRU/rec-idx", "LRU/flat", "LFU/iter", "LFU/rec-idx",
+                                                      "LFU/pool", "CLOCK/lockfree"}))
+            runRestart(e->algo.c_str(), e->impl.c_str(), e->make);
+        runRestart("LRU", "flat x8", [](size_t c) {
+            return std::make_unique<ShardedCache>(c, 8, [](size_t s) { return std::make_unique<LRUCacheFlat>(s); });
+        });
+        std::remove(snap_path);
+    }
+    wrcsv.close();
+    wrseries.close();
+
+    // ---- Кривые промахов (MRC) за один проход ----
+    // source=scal — тот же поток, что в scalability_extended.csv: lru-exact (стековые
+    // расстояния) и lfu-irm (частоты) против lru-measured/lfu-measured — прогонов
+    // LRU/flat и LFU/pool на каждой ёмкости. Модель MRC — заполнение по промаху
+    // (get, при промахе put), тип операции из нагрузки не учитывается.
+    // source=zipf — 10M обращений Zipf(0.9), ёмкости 1K..10M: точная кривая и SHARDS;
+    // mae — средняя абсолютная ошибка hit rate (п.п.) относительно lru-exact.
+    std::ofstream mrccsv("mrc.csv");
+    mrccsv << "source,method,capacity,hit_rate,sample_rate,accesses,sampled,build_ms,bytes,mae\n";
+    {
+        auto emit = [&](const char* source, const std::string& method, const std::vector<size_t>& caps,
+                        const std::vector<double>& hr, double rate, uint64_t accesses, uint64_t sampled,
+                        double ms, size_t bytes, double mae) {
+            for (size_t i = 0; i < caps.size(); ++i)
+                mrccsv << source << "," << method << "," << caps[i] << "," << hr[i] << "," << rate << ","
+                       << accesses << "," << sampled << "," << ms << "," << bytes << "," << mae << "\n";
+        };
+        auto mae = [](const std::vector<double>& a, const std::vector<double>& b) {
+            double e = 0.0;
+            for (size_t i = 0; i < a.size(); ++i) e += std::abs(a[i] - b[i]);
+            return a.empty() ? 0.0 : e / a.size();
+        };
+        auto demandFill = [](ICache& c, const std::vector<int>& keys) {
+            for (int k : keys) if (!c.get(k)) c.put(k, k * 10);
             const auto& cnt = c.counters();
-            double hr   = (cnt.hits + cnt.misses) ? (double)cnt.hits / (cnt.hits + cnt.misses) * 100.0 : 0.0;
-            double avg  = (double)t / (wl2.ops.size() + cap / 2);
-            double opsp = (double)(wl2.ops.size() + cap / 2) / (t / 1e9);
-            double eff  = (cnt.evictions > 0) ? (double)rc.useful_evict / cnt.evictions * 100.0 : 0.0;
-            scsv << cap << ",LRU,rec," << t << "," << avg << "," << opsp << "," << hr << ","
-                 << rc.useful_evict << "," << rc.harmful_evict << "," << eff << "\n";
+            return hitRate(cnt);
+        };
+
+        std::vector<size_t> scaps(sizes.begin(), sizes.end());
+        StackDistanceMRC lru;
+        FrequencyMRC lfu;
+        auto t0 = Clock::now();
+        for (int k : wl2.ops) { lru.access(k); lfu.access(k); }
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        std::vector<double> exact = lru.hitRates(scaps), irm = lfu.hitRates(scaps);
+        std::vector<double> mlru, mlfu;
+        for (size_t cap : scaps) {
+            mlru.push_back(demandFill(*findEngine("LRU/flat")->make(cap), wl2.ops));
+            mlfu.push_back(demandFill(*findEngine("LFU/pool")->make(cap), wl2.ops));
         }
-        {
-            LFUCacheRec c(cap);
+        emit("scal", "lru-exact", scaps, exact, 1.0, lru.accesses(), lru.sampled(), ms, lru.bytes(), 0.0);
+        emit("scal", "lfu-irm", scaps, irm, 1.0, lfu.accesses(), lfu.accesses(), ms, 0, mae(irm, mlfu));
+        emit("scal", "lru-measured", scaps, mlru, 1.0, wl2.ops.size(), wl2.ops.size(), 0.0, 0, mae(mlru, exact));
+        emit("scal", "lfu-measured", scaps, mlfu, 1.0, wl2.ops.size(), wl2.ops.size(), 0.0, 0, 0.0);
+
+        WorkloadSpec zs;
+        zs.ops = 10000000; zs.universe = 10000000; zs.zipf_alpha = 0.9;
+        Workload zw = generateWorkload(zs);
+        std::vector<size_t> zcaps;
+        for (size_t c = 1000; c <= 10000000; c *= 10)
+            for (size_t m : {1, 2, 5}) if (c * m <= 10000000) zcaps.push_back(c * m);
+
+        auto build = [&](double rate, std::vector<double>& out) {
+            StackDistanceMRC m(rate);
+            auto s0 = Clock::now();
+            for (int k : zw.ops) m.access(k);
+            double bms = std::chrono::duration<double, std::milli>(Clock::now() - s0).count();
+            out = m.hitRates(zcaps);
+            return std::make_tuple(bms, m.sampled(), m.bytes());
+        };
+        std::vector<double> zexact;
+        auto [ems, esampled, ebytes] = build(1.0, zexact);
+        emit("zipf", "lru-exact", zcaps, zexact, 1.0, zw.ops.size(), esampled, ems, ebytes, 0.0);
+        for (double rate : {0.1, 0.01, 0.001}) {
+            std::vector<double> hr;
+            auto [bms, smp, by] = build(rate, hr);
+            // Расстояния шагают по 1/rate, поэтому ёмкости меньше 10/rate не пишем
+            std::vector<size_t> c2;
+            std::vector<double> h2, e2;
+            for (size_t i = 0; i < zcaps.size(); ++i)
+                if (zcaps[i] * rate >= 10) { c2.push_back(zcaps[i]); h2.push_back(hr[i]); e2.push_back(zexact[i]); }
+            emit("zipf", "lru-shards", c2, h2, rate, zw.ops.size(), smp, bms, by, mae(h2, e2));
+        }
+        FrequencyMRC zlfu;
+        auto f0 = Clock::now();
+        for (int k : zw.ops) zlfu.access(k);
+        double fms = std::chrono::duration<double, std::milli>(Clock::now() - f0).count();
+        emit("zipf", "lfu-irm", zcaps, zlfu.hitRates(zcaps), 1.0, zw.ops.size(), zw.ops.size(), fms, 0, 0.0);
+    }
+    mrccsv.close();
+
+    // ---- Масштабируемость по потокам (ShardedCache) ----
+    // shards = 1 — по сути LRU/LFU под одним мьютексом; видно, где упирается в блокировку.
+    // CLOCK сам потокобезопасен и идёт без обёртки (shards = 1).
+    std::ofstream tcsv("threads_scalability.csv");
+    tcsv << "threads,algo,impl,shards,elapsed_ns,ops_per_sec,hit_rate,useful_evictions,harmful_evictions\n";
+    {
+        Workload wl3 = makeWorkload(200000, 4000, 0.75);
+        const int mt_capacity = 1024;
+        auto makeLRU = [](size_t c) { return std::make_unique<LRUCacheFlat>(c); };
+        auto makeLFU = [](size_t c) { return std::make_unique<LFUCachePool>(c); };
+        for (int threads : {1, 2, 4, 8, 16, 32, 64}) {
+            for (size_t shards : {1, 16}) {
+                ShardedCache lru(mt_capacity, shards, makeLRU);
+                MTResult a = runScenarioMT(lru, wl3, threads);
+                tcsv << threads << ",LRU,flat," << shards << "," << a.elapsed_ns << "," << a.opsPerSec() << ","
+                     << a.hitRate() << "," << a.useful_evict << "," << a.harmful_evict << "\n";
+                ShardedCache lfu(mt_capacity, shards, makeLFU);
+                MTResult b = runScenarioMT(lfu, wl3, threads);
+                tcsv << threads << ",LFU,pool," << shards << "," << b.elapsed_ns << "," << b.opsPerSec() << ","
+                     << b.hitRate() << "," << b.useful_evict << "," << b.harmful_evict << "\n";
+            }
+            ClockCache clock(mt_capacity);
+            MTResult c = runScenarioMT(clock, wl3, threads);
+            tcsv << threads << ",CLOCK,lockfree,1," << c.elapsed_ns << "," << c.opsPerSec() << ","
+                 << c.hitRate() << "," << c.useful_evict << "," << c.harmful_evict << "\n";
+        }
+    }
+    tcsv.close();
+
+    // ---- Read-through: сквозная задержка и нагрузка на бэкенд (ReadThrough.h) ----
+    // read_through.csv: один поток, 30K get Zipf(0.9) по 10K ключам, ёмкость 1024,
+    // промах идёт в имитируемый бэкенд со средней задержкой 10 мкс (ожидание активное).
+    // e2e_* — задержка get вместе с загрузкой, backend_qps — загрузок в секунду прогона,
+    // miss_penalty_ns — средняя фактическая задержка загрузки, cost_per_op — секунд
+    // на get вместе с загрузками.
+    std::ofstream rtcsv("read_through.csv");
+    rtcsv << "algo,impl,backend,mean_us,ops,hit_rate,loads,elapsed_ns,e2e_avg_ns,e2e_p50_ns,e2e_p99_ns,e2e_p999_ns,"
+             "backend_qps,miss_penalty_ns,cost_per_op\n";
+    {
+        WorkloadSpec spec;
+        spec.ops = 30000; spec.universe = 10000; spec.zipf_alpha = 0.9; spec.write_ratio = 0.0;
+        Workload rw = generateWorkload(spec);
+        const std::pair<const char*, BackendLatency> backends[] = {
+            {"fixed", BackendLatency::Fixed}, {"exp", BackendLatency::Exponential}, {"lognormal", BackendLatency::LogNormal}};
+        auto runRT = [&](const char* algo, const char* impl, auto make) {
+            for (const auto& [bname, dist] : backends) {
+                auto c = make();
+                SimulatedBackend backend{BackendSpec{dist, 10.0, 1.0, false, 42}};
+                ReadThroughCache rt(*c, [&](int k) { return backend.load(k); });
+                LatencyHistogram h;
+                auto t0 = Clock::now();
+                for (int k : rw.ops) {
+                    uint64_t s0 = latencyTicks();
+                    (void)rt.get(k);
+                    h.record(latencyTicks() - s0);
+                }
+                long long t = std::chrono::duration_cast<Ns>(Clock::now() - t0).count();
+                ReadThroughStats st = rt.stats();
+                LatencySummary ls = summarizeLatency(h);
+                double n = (double)rw.ops.size();
+                rtcsv << algo << "," << impl << "," << bname << "," << backend.spec().mean_us << "," << rw.ops.size() << ","
+                      << st.hits / n * 100.0 << "," << st.loads << "," << t << "," << t / n << ","
+                      << ls.p50_ns << "," << ls.p99_ns << "," << ls.p999_ns << "," << st.loads / (t / 1e9) << ","
+                      << backend.meanLatencyNs() << "," << calculateCostPerOperation(t, (long long)n) << "\n";
+            }
+        };
+        for (const EngineEntry* e : selectEngineList({"LRU/flat", "LFU/pool", "TinyLFU/window", "ARC/ghost"}))
+            runRT(e->algo.c_str(), e->impl.c_str(), [e] { return e->make(1024); });
+    }
+    rtcsv.close();
+
+    // read_through_mt.csv: потоки делят 8K get Zipf(1.2) по 2K ключам поверх
+    // ShardedCache(LRU/flat, 16 шардов, ёмкость 256); бэкенд спит 200 мкс, так что
+    // загрузки разных потоков перекрываются. mode: single-flight или naive
+    // (каждый промах — своя загрузка); coalesced — промахи, дождавшиеся чужой загрузки.
+    std::ofstream rtmt("read_through_mt.csv");
+    rtmt << "threads,mode,ops,elapsed_ns,hit_rate,loads,coalesced,backend_qps,e2e_p50_ns,e2e_p99_ns\n";
+    {
+        WorkloadSpec spec;
+        spec.ops = 8000; spec.universe = 2000; spec.zipf_alpha = 1.2; spec.write_ratio = 0.0;
+        Workload mw = generateWorkload(spec);
+        for (int threads : {1, 2, 4, 8, 16}) {
+            for (bool sf : {false, true}) {
+                ShardedCache cache(256, 16, [](size_t c) { return std::make_unique<LRUCacheFlat>(c); });
+                SimulatedBackend backend{BackendSpec{BackendLatency::Fixed, 200.0, 1.0, true, 42}};
+                ReadThroughCache rt(cache, [&](int k) { return backend.load(k); }, sf);
+                std::vector<LatencyHistogram> hist(threads);
+                std::vector<std::thread> pool;
+                size_t chunk = (mw.ops.size() + threads - 1) / threads;
+                auto t0 = Clock::now();
+                for (int t = 0; t < threads; ++t) {
+                    pool.emplace_back([&, t] {
+                        size_t begin = std::min(mw.ops.size(), t * chunk);
+                        size_t end   = std::min(mw.ops.size(), begin + chunk);
+                        for (size_t i = begin; i < end; ++i) {
+                            uint64_t s0 = latencyTicks();
+                            (void)rt.get(mw.ops[i]);
+                            hist[t].record(latencyTicks() - s0);
+                        }
+                    });
+                }
+                for (auto& th : pool) th.join();
+                long long el = std::chrono::duration_cast<Ns>(Clock::now() - t0).count();
+                for (int t = 1; t < threads; ++t) hist[0].merge(hist[t]);
+                LatencySummary ls = summarizeLatency(hist[0]);
+                ReadThroughStats st = rt.stats();
+                rtmt << threads << "," << (sf ? "single-flight" : "naive") << "," << mw.ops.size() << "," << el << ","
+                     << (double)st.hits / mw.ops.size() * 100.0 << "," << st.loads << "," << st.coalesced << ","
+                     << st.loads / (el / 1e9) << "," << ls.p50_ns << "," << ls.p99_ns << "\n";
+            }
+        }
+    }
+    rtmt.close();
+
+    // ---- Пакетные операции: пропускная способность по размеру пакета ----
+    // Ёмкость и множество ключей заведомо больше кешей процессора,
+    // чтобы было видно, сколько параллелизма по памяти даёт пакет.
+    std::ofstream bcsv("batch_throughput.csv");
+    bcsv << "algo,impl,batch,capacity,elapsed_ns,avg_ns,ops_per_sec,hit_rate,ops_per_call\n";
+    {
+        const int b_capacity = 1 << 18;
+        Workload wl4 = makeWorkload(1000000, 1 << 21, 0.75);
+        auto runBatch = [&](const char* algo, const char* impl, auto factory) {
+            for (size_t batch : {1, 8, 32, 128}) {
+                auto c = factory();
+                long long calls = 0;
+                long long t = runScenarioBatched(*c, wl4, batch, &calls);
+                const auto& cnt = c->counters();
+                double hr  = hitRate(cnt);
+                double ops = (double)wl4.ops.size();
+                bcsv << algo << "," << impl << "," << batch << "," << b_capacity << "," << t << ","
+                     << t / ops << "," << ops / (t / 1e9) << "," << hr << "," << (calls ? ops / calls : 0.0) << "\n";
+            }
+        };
+        for (const EngineEntry* e : selectEngineList({"LRU/iter", "LFU/iter", "LRU/flat", "LFU/pool"}))
+            runBatch(e->algo.c_str(), e->impl.c_str(), [&] { return e->make(b_capacity); });
+    }
+    bcsv.close();
+
+    // ---- Память на масштабе: байты на запись и RSS ----
+    // Кэш заполняется до ёмкости и прогоняется ещё столько же вставок новых ключей
+    // (каждая — вытеснение). rec — на 5000 записей: заполнение у них O(n²).
+    std::ofstream memcsv("memory.csv");
+    memcsv << "algo,impl,capacity,entries,live_bytes,requested_bytes,bytes_per_entry,estimated_bytes,"
+              "estimated_per_entry,run_allocs_per_op,fragmentation_pct,rss_delta,rss_per_entry\n";
+    {
+        auto measure = [&](const EngineEntry& e, size_t cap) {
+            const char* algo = e.algo.c_str();
+            const char* impl = e.impl.c_str();
+            MemoryProbe probe;
+            auto c = e.make(cap);
+            probe.constructed();
+            for (size_t k = 0; k < 2 * cap; ++k) c->put((int)k, (int)k);
+            MemoryMeasure m = probe.finish(c->size());
+            size_t th = 0, ac = 0, ov = 0;
+            e.estimate(*c, th, ac, ov);
+            memcsv << algo << "," << impl << "," << cap << "," << m.entries << "," << m.live_bytes << ","
+                   << m.requested_bytes << "," << m.bytesPerEntry() << "," << ac + ov << ","
+                   << (m.entries ? (double)(ac + ov) / m.entries : 0.0) << ","
+                   << (double)m.run_allocs / (2 * cap) << "," << m.fragmentation() << "," << m.rss_delta << ","
+                   << (m.entries ? (double)m.rss_delta / m.entries : 0.0) << "\n";
+        };
+        const size_t big = 200000, small = 5000;
+        for (const EngineEntry* e : selectEngineList({"LRU/iter", "LRU/rec", "LFU/iter", "LFU/rec", "LRU/flat", "LFU/pool",
+                                                      "CLOCK/*", "TinyLFU/*", "ARC/*", "2Q/*", "SLRU/*"}))
+            measure(*e, e->impl == "rec" ? small : big);
+    }
+    memcsv.close();
+
+    // ---- Устойчивость к сканам ----
+    // Горячее множество помещается в кэш, но каждые 2000 операций по кэшу
+    // проходит скан длиной в две ёмкости. LRU теряет горячие ключи при каждом скане,
+    // ARC/2Q/SLRU/TinyLFU должны держать их в защищённой части.
+    std::ofstream sccsv("scan_resistance.csv");
+    sccsv << "algo,impl,capacity,elapsed_ns,avg_ns,hit_rate,useful_evictions,harmful_evictions,eviction_efficiency\n";
+    {
+        const int s_capacity = 256;
+        Workload wl5 = makeScanWorkload(100000, 1000, 2 * s_capacity, 2000);
+        auto runScan = [&](const char* algo, const char* impl, ICache& c) {
             RunContext rc;
-            auto t = runScenario(c, wl2, rc);
+            long long t = runScenario(c, wl5, rc);
             const auto& cnt = c.counters();
-            double hr   = (cnt.hits + cnt.misses) ? (double)cnt.hits / (cnt.hits + cnt.misses) * 100.0 : 0.0;
-            double avg  = (double)t / (wl2.ops.size() + cap / 2);
-            double opsp = (double)(wl2.ops.size() + cap / 2) / (t / 1e9);
-            double eff  = (cnt.evictions > 0) ? (double)rc.useful_evict / cnt.evictions * 100.0 : 0.0;
-            scsv << cap << ",LFU,rec," << t << "," << avg << "," << opsp << "," << hr << ","
-                 << rc.useful_evict << "," << rc.harmful_evict << "," << eff << "\n";
+            double hr  = hitRate(cnt);
+            double eff = (cnt.evictions > 0) ? (double)rc.useful_evict / cnt.evictions * 100.0 : 0.0;
+            sccsv << algo << "," << impl << "," << s_capacity << "," << t << ","
+                  << (double)t / (wl5.ops.size() + s_capacity / 2) << "," << hr << ","
+                  << rc.useful_evict << "," << rc.harmful_evict << "," << eff << "\n";
+        };
+        for (const EngineEntry* e : selectEngineList({"LRU/iter", "LRU/flat", "LFU/iter", "LFU/pool",
+                                                      "TinyLFU/*", "ARC/*", "2Q/*", "SLRU/*"}))
+            runScan(e->algo.c_str(), e->impl.c_str(), *e->make(s_capacity));
+    }
+    sccsv.close();
+
+    // ---- Воспроизведение бинарной трассы через mmap ----
+    // Тот же поток, что и в памяти (source=memory), записывается в трассу и
+    // проигрывается из файла (source=trace): hit rate должен совпасть, а avg_ns —
+    // отличаться лишь на шум, потому что разбор трассы идёт вне замера.
+    std::ofstream trcsv("trace_replay.csv");
+    trcsv << kTraceReplayHeader;
+    {
+        const int tr_capacity = 1024;
+        Workload wl6 = makeWorkload(2000000, 8192, 0.75);
+        const char* path = "workload_trace.bin";
+        {
+            auto memRow = [&](const char* algo, const char* impl, ICache& c) {
+                RunContext rc;
+                long long t = runScenario(c, wl6, rc, 0);
+                const auto& cnt = c.counters();
+                double hr = hitRate(cnt);
+                double n = (double)wl6.ops.size();
+                trcsv << "memory," << algo << "," << impl << "," << tr_capacity << "," << wl6.ops.size() << ","
+                      << wl6.ops.size() * sizeof(int) << "," << sizeof(int) << ",0," << t << "," << t / n << "," << hr << "\n";
+            };
+            for (const EngineEntry* e : selectEngineList({"LRU/flat", "LFU/pool", "TinyLFU/window", "ARC/ghost", "CLOCK/lockfree"}))
+                memRow(e->algo.c_str(), e->impl.c_str(), *e->make(tr_capacity));
         }
+        MappedFile f;
+        if (writeWorkloadTrace(wl6, path) && f.open(path)) replayTraceEngines(trcsv, "trace", f, tr_capacity);
+        else std::cerr << "Не удалось записать " << path << "\n";
+        std::remove(path);
     }
-    scsv.close();
+    trcsv.close();
+
+    // ---- TTL: истечение через колесо таймеров ----
+    // off — обычный прогон runScenarioT без времени и TTL; clock — время идёт
+    // тиком на операцию, но TTL не задаётся (цена пустого advanceTime);
+    // ttl — у ключей TTL из смеси makeTTLWorkload.
+    // overhead_ns — разница ns/op с режимом off для того же движка.
+    std::ofstream ttlcsv("ttl.csv");
+    ttlcsv << "algo,impl,mode,capacity,elapsed_ns,avg_ns,hit_rate,evictions,expired,"
+              "useful_evictions,harmful_evictions,overhead_ns\n";
+    {
+        const int t_capacity = 1024;
+        TTLWorkload tw = makeTTLWorkload(500000, 4000);
+        auto runTTL = [&](const char* algo, const char* impl, auto factory) {
+            double off_avg = 0.0;
+            for (const char* mode : {"off", "clock", "ttl"}) {
+                auto c = factory();
+                RunContext rc;
+                std::string m = mode;
+                long long t = (m == "off") ? runScenarioT(*c, tw.wl, rc, 0) : runScenarioTTL(*c, tw, rc, m == "ttl");
+                const auto& cnt = c->counters();
+                double hr  = hitRate(cnt);
+                double avg = (double)t / (tw.wl.ops.size() + t_capacity / 2);
+                if (m == "off") off_avg = avg;
+                ttlcsv << algo << "," << impl << "," << mode << "," << t_capacity << ","
+                       << t << "," << avg << "," << hr << "," << cnt.evictions << "," << cnt.expired << ","
+                       << rc.useful_evict << "," << rc.harmful_evict << "," << (avg - off_avg) << "\n";
+            }
+        };
+        runTTL("LRU", "flat", [&]() { return std::make_unique<LRUCacheFlat>(t_capacity); });
+        runTTL("LFU", "pool", [&]() { return std::make_unique<LFUCachePool>(t_capacity); });
+    }
+    ttlcsv.close();
+
+    // ---- Генератор нагрузок: параллельная генерация и паттерны доступа ----
+    // workload_gen.csv — время генерации 20M операций Zipf(0.99) по числу потоков;
+    // checksum одинаковый во всех строках (генерация детерминирована).
+    std::ofstream gencsv("workload_gen.csv");
+    gencsv << "threads,ops,universe,gen_ms,mops_per_sec,checksum\n";
+    {
+        WorkloadSpec spec;
+        spec.ops = 20000000; spec.universe = 1000000; spec.zipf_alpha = 0.99; spec.write_ratio = 0.3;
+        int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int t = 1; t <= std::max(8, hw); t *= 2) {
+            spec.threads = t;
+            auto t0 = Clock::now();
+            Workload g = generateWorkload(spec);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            gencsv << t << "," << spec.ops << "," << spec.universe << "," << ms << ","
+                   << spec.ops / ms / 1000.0 << ",0x" << std::hex << workloadChecksum(g) << std::dec << "\n";
+        }
+    }
+    gencsv.close();
+
+    // workloads.csv — движки на наборе паттернов. Горячие ключи для useful/harmful
+    // берутся из меток генератора (top 10% по числу обращений), а не из hot_limit.
+    // elapsed_ns/avg_ns и счётчики — из прогона без замера задержек; процентили —
+    // из второго прогона на свежем экземпляре с замером каждой операции.
+    std::ofstream wlcsv("workloads.csv");
+    wlcsv << "pattern,algo,impl,capacity,ops,write_ratio,elapsed_ns,avg_ns,hit_rate,evictions,"
+             "useful_evictions,harmful_evictions,eviction_efficiency,p50_ns,p99_ns,p999_ns\n";
+    {
+        const int w_capacity = 2048;
+        WorkloadSpec base;
+        base.ops = 1000000; base.universe = 100000; base.zipf_alpha = 1.0; base.write_ratio = 0.3;
+        std::vector<std::pair<const char*, WorkloadSpec>> patterns;
+        { WorkloadSpec s = base; s.dist = KeyDist::HotSet; s.universe = 20000;  patterns.push_back({"hotset", s}); }
+        { WorkloadSpec s = base; s.zipf_alpha = 0.8;                            patterns.push_back({"zipf0.8", s}); }
+        { WorkloadSpec s = base; s.zipf_alpha = 1.2;                            patterns.push_back({"zipf1.2", s}); }
+        { WorkloadSpec s = base; s.drift_period = 50000; s.drift_step = 1000;   patterns.push_back({"drift", s}); }
+        { WorkloadSpec s = base; s.scan_period = 20000; s.scan_len = 4 * w_capacity; patterns.push_back({"scan", s}); }
+        { WorkloadSpec s = base; s.dist = KeyDist::Loop; s.loop_len = 8 * w_capacity;
+          patterns.push_back({"loop", s}); }
+        { WorkloadSpec s = base; s.write_ratio = 0.5;                           patterns.push_back({"zipf-rw50", s}); }
+
+        for (const auto& [name, spec] : patterns) {
+            Workload pw = generateWorkload(spec);
+            auto runPattern = [&](const char* algo, const char* impl, auto make) {
+                auto owned = make();
+                ICache& c = *owned;
+                RunContext rc;
+                long long t = runScenario(c, pw, rc, 0);
+                LatencyHistogram h;
+                {
+                    auto fresh = make();
+                    RunContext lctx;
+                    lctx.latency = &h;
+                    runScenario(*fresh, pw, lctx, 0);
+                }
+                LatencySummary ls = summarizeLatency(h);
+                const auto& cnt = c.counters();
+                double hr  = hitRate(cnt);
+                double eff = (cnt.evictions > 0) ? (double)rc.useful_evict / cnt.evictions * 100.0 : 0.0;
+                wlcsv << name << "," << algo << "," << impl << "," << w_capacity << "," << pw.ops.size() << ","
+                      << spec.write_ratio << "," << t << "," << (double)t / (pw.ops.size() + w_capacity / 2) << ","
+                      << hr << "," << cnt.evictions << "," << rc.useful_evict << "," << rc.harmful_evict << ","
+                      << eff << "," << ls.p50_ns << "," << ls.p99_ns << "," << ls.p999_ns << "\n";
+            };
+            for (const EngineEntry* e : selectEngineList({"LRU/flat", "LFU/pool", "CLOCK/*", "TinyLFU/*", "ARC/*", "2Q/*", "SLRU/*"}))
+                runPattern(e->algo.c_str(), e->impl.c_str(), [&] { return e->make(w_capacity); });
+        }
+    }
+    wlcsv.close();
+
+    // ---- Бюджет в байтах: GreedyDual-Size на slab-арене ----
+    // Значения 64 Б … 64 КБ, ёмкость задаётся в байтах. Три модели стоимости промаха:
+    // cost1 — 1 за объект, bytes — пропорционально размеру, latency — 200 мкс + 10 нс/байт.
+    // fragmentation_ratio здесь не оценка, а измерение: доля арены, не занятая данными.
+    std::ofstream szcsv("sized_results.csv");
+    szcsv << "algo,impl,byte_budget,elapsed_ns,avg_ns,object_hit_rate,byte_hit_rate,objects,evictions,arena_evictions,"
+             "requested_bytes,chunk_bytes,reserved_bytes,internal_frag_pct,external_frag_pct,fragmentation_ratio\n";
+    {
+        SizedWorkload sw = makeSizedWorkload(200000, 20000, 64, 64 << 10);
+        auto runSized = [&](const char* impl, size_t budget, auto cost) {
+            GDSCache c(budget);
+            SizedResult r = runScenarioSized(c, sw, cost);
+            const SlabArena& a = c.arena();
+            double frag = a.capacityBytes()
+                ? (double)(a.capacityBytes() - a.requestedBytes()) / a.capacityBytes() * 100.0 : 0.0;
+            szcsv << "GDS," << impl << "," << budget << "," << r.elapsed_ns << ","
+                  << (double)r.elapsed_ns / sw.wl.ops.size() << "," << r.hitRate() << "," << r.byteHitRate() << ","
+                  << c.size() << "," << c.counters().evictions << "," << c.arenaEvictions() << ","
+                  << a.requestedBytes() << "," << a.chunkBytes() << "," << a.reservedBytes() << ","
+                  << a.internalFragmentation() << "," << a.externalFragmentation() << "," << frag << "\n";
+        };
+        for (size_t mb : {8, 32, 128}) {
+            size_t budget = mb << 20;
+            runSized("cost1",   budget, [](uint32_t) { return 1.0; });
+            runSized("bytes",   budget, [](uint32_t b) { return (double)b; });
+            runSized("latency", budget, [](uint32_t b) { return 200.0 + b * 0.01; });
+        }
+    }
+    szcsv.close();
 
     // ---- Повторяемость/стабильность ----
     std::ofstream stabcsv("stability.csv");
@@ -346,10 +2445,10 @@ int main() {
         sm.compute();
         return sm;
     };
-    auto sm_lru_it = runTrials("LRU","iter", [&](){ return std::make_unique<LRUCacheIter>(capacity); });
-    auto sm_lru_rc = runTrials("LRU","rec",  [&](){ return std::make_unique<LRUCacheRec>(capacity); });
-    auto sm_lfu_it = runTrials("LFU","iter", [&](){ return std::make_unique<LFUCacheIter>(capacity); });
-    auto sm_lfu_rc = runTrials("LFU","rec",  [&](){ return std::make_unique<LFUCacheRec>(capacity); });
+    const std::vector<std::string> scored = {"LRU/iter", "LRU/rec", "LFU/iter", "LFU/rec", "LRU/flat", "LFU/pool"};
+    std::map<std::string, StabilityMetrics> stab;
+    for (const EngineEntry* e : selectEngineList(scored))
+        stab[e->name()] = runTrials(e->algo.c_str(), e->impl.c_str(), [&] { return e->make(capacity); });
     stabcsv.close();
 
     // ---- Интегральный скор ----
@@ -362,10 +2461,7 @@ int main() {
         eff_csv << r.algo << "," << r.impl << "," << score << "," << stab_score << ","
                 << r.hit_rate << "," << r.avg_time_ns << "," << r.memory_efficiency << "\n";
     };
-    emitScore(r1, sm_lru_it);
-    emitScore(r2, sm_lru_rc);
-    emitScore(r3, sm_lfu_it);
-    emitScore(r4, sm_lfu_rc);
+    for (const auto& name : scored) emitScore(rows.at(name), stab.at(name));
     eff_csv.close();
 
     // ---- ROI ----
@@ -373,14 +2469,14 @@ int main() {
     roicsv << "algo,impl,roi,perf_score,resource,impl_cost,maint_cost\n";
     auto emitROI = [&](const CacheMetricsRow& r){
         double resource   = r.actual_memory/1024.0 + r.elapsed_ns/1e8;
-        double impl_cost  = (r.impl=="iter") ? 2.0 : 1.5;
-        double maint_cost = (r.impl=="iter") ? 1.5 : 1.0;
+        double impl_cost  = (r.impl=="rec") ? 1.5 : 2.0;
+        double maint_cost = (r.impl=="rec") ? 1.0 : 1.5;
         double perf_score = r.ops_per_sec * (r.hit_rate/100.0);
         double roi = CostEffectiveness::ROI(perf_score, resource, impl_cost, maint_cost);
         roicsv << r.algo << "," << r.impl << "," << roi << "," << perf_score << ","
                << resource << "," << impl_cost << "," << maint_cost << "\n";
     };
-    emitROI(r1); emitROI(r2); emitROI(r3); emitROI(r4);
+    for (const auto& name : scored) emitROI(rows.at(name));
     roicsv.close();
 
     // ---- Algorithm Efficiency (метрика 6) ----
@@ -394,16 +2490,34 @@ int main() {
         double eff = ops ? (double)hits / (double)ops * 100.0 : 0.0;
         aeff << r.algo << "-" << r.impl << "," << eff << "\n";
     };
-    algoEff(r1); algoEff(r2); algoEff(r3); algoEff(r4);
+    for (const auto& name : scored) algoEff(rows.at(name));
     aeff.close();
 
     std::cout << "\nCSV-файлы сохранены:\n"
               << "  - results_extended.csv\n"
               << "  - scalability_extended.csv\n"
+              << "  - mrc.csv\n"
+              << "  - rec_scaling.csv\n"
+              << "  - set_assoc.csv\n"
+              << "  - adaptive_phases.csv, adaptive_switches.csv\n"
+              << "  - telemetry_overhead.csv (+ поток окон telemetry.csv, telemetry.bin)\n"
+              << "  - stats_counters.csv\n"
+              << "  - warm_restart.csv, warm_restart_series.csv\n"
+              << "  - threads_scalability.csv\n"
+              << "  - read_through.csv, read_through_mt.csv\n"
+              << "  - batch_throughput.csv\n"
+              << "  - memory.csv\n"
+              << "  - scan_resistance.csv\n"
+              << "  - sized_results.csv\n"
+              << "  - ttl.csv\n"
+              << "  - trace_replay.csv\n"
+              << "  - workload_gen.csv\n"
+              << "  - workloads.csv\n"
               << "  - stability.csv\n"
               << "  - efficiency_score.csv\n"
               << "  - roi.csv\n"
               << "  - algorithm_efficiency.csv\n"
-              << "  - warmup.csv\n";
+              << "  - warmup.csv\n"
+              << "  - latency_hist.csv\n";
     return 0;
 }